@@ -290,12 +290,12 @@ namespace TFE_Model_Jedi
 		// Memory will get freed with the memory region automatically.
 		s_models[pool].clear();
 		
-		// free the memory of each models' drawId object
+		// TFE: drawId points to an entry in the GPU model cache, which may be shared with other models and is freed by the renderer.
 		const size_t count = s_modelList[pool].size();
 		JediModel** models = s_modelList[pool].data();
 		for (size_t i = 0; i < count; i++)
 		{
-			free(models[i]->drawId);
+			models[i]->drawId = nullptr;
 		}
 
 		s_modelList[pool].clear();
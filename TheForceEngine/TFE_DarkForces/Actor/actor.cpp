@@ -49,6 +49,34 @@ namespace TFE_DarkForces
 	SoundSourceId s_stormAlertSndSrc[STORM_ALERT_COUNT];
 	SoundSourceId s_agentSndSrc[AGENTSND_COUNT];
 
+	///////////////////////////////////////////
+	// Line of Sight Cache
+	// TFE: Many actors test visibility against the same target several
+	// times per tick, so results are kept for the rest of the tick.
+	///////////////////////////////////////////
+	enum ActorLosCacheConstants
+	{
+		ACTOR_LOS_CACHE_SIZE = 256,	// Must be a power of 2.
+	};
+
+	struct ActorLosCacheEntry
+	{
+		SecObject* actorObj;
+		SecObject* obj;
+		// The inputs are also compared, so objects that moved or changed size during the tick are tested again.
+		RSector* sector0;
+		RSector* sector1;
+		vec3_fixed pos0;
+		vec3_fixed pos1;
+		fixed16_16 height0;
+		fixed16_16 height1;
+		Tick tick;
+
+		JBool canSee;
+		JBool wallHit;
+	};
+	static ActorLosCacheEntry s_losCache[ACTOR_LOS_CACHE_SIZE];
+
 	///////////////////////////////////////////
 	// Forward Declarations
 	///////////////////////////////////////////
@@ -65,6 +93,7 @@ namespace TFE_DarkForces
 	///////////////////////////////////////////
 	void actor_clearState()
 	{
+		memset(s_losCache, 0, sizeof(ActorLosCacheEntry) * ACTOR_LOS_CACHE_SIZE);
 		memset(&s_istate, 0, sizeof(ActorInternalState));
 		memset(&s_actorState, 0, sizeof(ActorState));
 		s_istate.objCollisionEnabled = JTRUE;
@@ -520,18 +549,15 @@ namespace TFE_DarkForces
 				sector = &s_levelState.sectors[randomSect];
 			}
 
-			SecObject** objList = sector->objectList;
-			for (s32 i = 0, idx = 0; i < sector->objectCount && idx < sector->objectCapacity; idx++)
+			// Objects are only removed right before returning, so the dense list can be used.
+			SecObject** objList = sector->objectDense;
+			for (s32 i = 0; i < sector->objectCount; i++)
 			{
-				SecObject* obj = objList[idx];
-				if (obj)
+				SecObject* obj = objList[i];
+				if ((obj->entityFlags & ETFLAG_CORPSE) && !(obj->entityFlags & ETFLAG_KEEP_CORPSE) && !actor_canSeeObject(obj, s_playerObject))
 				{
-					if ((obj->entityFlags & ETFLAG_CORPSE) && !(obj->entityFlags & ETFLAG_KEEP_CORPSE) && !actor_canSeeObject(obj, s_playerObject))
-					{
-						freeObject(obj);
-						return;
-					}
-					i++;
+					freeObject(obj);
+					return;
 				}
 			}
 		}
@@ -1561,7 +1587,7 @@ namespace TFE_DarkForces
 		obj->entityFlags |= ETFLAG_SMART_OBJ;
 	}
 
-	JBool actor_canSeeObject(SecObject* actorObj, SecObject* obj)
+	JBool actor_canSeeObjectUncached(SecObject* actorObj, SecObject* obj)
 	{
 		vec3_fixed p0 = { actorObj->posWS.x, actorObj->posWS.y - actorObj->worldHeight, actorObj->posWS.z };
 		vec3_fixed p1 = { obj->posWS.x, obj->posWS.y, obj->posWS.z };
@@ -1577,6 +1603,36 @@ namespace TFE_DarkForces
 		vec3_fixed p2 = { obj->posWS.x, obj->posWS.y - obj->worldHeight, obj->posWS.z };
 		return collision_canHitObject(actorObj->sector, obj->sector, p0, p2, 0);
 	}
+
+	JBool actor_canSeeObject(SecObject* actorObj, SecObject* obj)
+	{
+		const size_t key = (size_t(actorObj) / sizeof(SecObject)) * 31 + size_t(obj) / sizeof(SecObject);
+		ActorLosCacheEntry* entry = &s_losCache[key & (ACTOR_LOS_CACHE_SIZE - 1)];
+		if (entry->tick == s_curTick && entry->actorObj == actorObj && entry->obj == obj &&
+			entry->sector0 == actorObj->sector && entry->sector1 == obj->sector &&
+			entry->pos0.x == actorObj->posWS.x && entry->pos0.y == actorObj->posWS.y && entry->pos0.z == actorObj->posWS.z &&
+			entry->pos1.x == obj->posWS.x && entry->pos1.y == obj->posWS.y && entry->pos1.z == obj->posWS.z &&
+			entry->height0 == actorObj->worldHeight && entry->height1 == obj->worldHeight)
+		{
+			// Restore the wall hit state, so the result is indistinguishable from running the test.
+			s_collision_wallHit = entry->wallHit;
+			return entry->canSee;
+		}
+
+		const JBool canSee = actor_canSeeObjectUncached(actorObj, obj);
+		entry->actorObj = actorObj;
+		entry->obj = obj;
+		entry->sector0 = actorObj->sector;
+		entry->sector1 = obj->sector;
+		entry->pos0 = actorObj->posWS;
+		entry->pos1 = obj->posWS;
+		entry->height0 = actorObj->worldHeight;
+		entry->height1 = obj->worldHeight;
+		entry->tick = s_curTick;
+		entry->canSee = canSee;
+		entry->wallHit = s_collision_wallHit;
+		return canSee;
+	}
 	   
 	JBool actor_canSeeObjFromDist(SecObject* actorObj, SecObject* obj)
 	{
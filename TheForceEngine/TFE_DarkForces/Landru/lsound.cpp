@@ -39,7 +39,7 @@ namespace TFE_DarkForces
 
 	LSound* lSoundAlloc(u8* data)
 	{
-		LSound* sound = (LSound*)game_alloc(sizeof(LSound));
+		LSound* sound = (LSound*)game_allocTagged(sizeof(LSound), REGION_TAG_AUDIO);
 		if (sound)
 		{
 			initSound(sound);
@@ -309,7 +309,7 @@ namespace TFE_DarkForces
 			return nullptr;
 		}
 		u32 size = (u32)file.getSize();
-		u8* data = (u8*)game_alloc(size);
+		u8* data = (u8*)game_allocTagged(size, REGION_TAG_AUDIO);
 		if (!data)
 		{
 			return nullptr;
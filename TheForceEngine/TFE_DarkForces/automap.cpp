@@ -552,20 +552,10 @@ namespace TFE_DarkForces
 		}
 		if (s_mapShowSectorMode)
 		{
-			SecObject** objIter = sector->objectList;
-			for (s32 i = 0; i < sector->objectCount; objIter++)
+			SecObject** objIter = sector->objectDense;
+			for (s32 i = 0; i < sector->objectCount; i++, objIter++)
 			{
-				SecObject* obj = *objIter;
-				while (!obj)
-				{
-					objIter++;
-					obj = *objIter;
-				}
-				if (obj)
-				{
-					automap_drawObject(obj);
-					i++;
-				}
+				automap_drawObject(*objIter);
 			}
 		}
 	}
@@ -30,6 +30,7 @@
 #include <TFE_DarkForces/Actor/actor.h>
 #include <TFE_Game/reticle.h>
 #include <TFE_Input/inputMapping.h>
+#include <TFE_Settings/settings.h>
 #include <TFE_Memory/memoryRegion.h>
 #include <TFE_System/system.h>
 #include <TFE_System/tfeMessage.h>
@@ -365,6 +366,7 @@ namespace TFE_DarkForces
 		vue_resetState();
 		lsystem_destroy();
 		hud_reset();
+		time_setFixedStep(0);
 		
 		// TFE
 		TFE_Sprite_Jedi::freeAll();
@@ -529,6 +531,7 @@ namespace TFE_DarkForces
 	****************************************************/
 	void DarkForces::loopGame()
 	{
+		time_setFixedStep(Tick(min((s32)SIMULATION_STEP_MAX, max(0, TFE_Settings::getGraphicsSettings()->simulationStep))));
 		updateTime();
 				
 		switch (s_runGameState.state)
@@ -632,6 +635,11 @@ namespace TFE_DarkForces
 				if (task_getCount())
 				{
 					if (!s_gamePaused && TFE_A11Y::gameplayCaptionsEnabled()) { TFE_A11Y::drawCaptions(); }
+					// TFE: Between fixed simulation steps, the world is rendered here instead of by the mission task.
+					if (time_getFixedStep() && !task_canRun())
+					{
+						mission_renderBetweenSteps();
+					}
 				}
 				else
 				{
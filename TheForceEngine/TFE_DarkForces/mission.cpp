@@ -501,6 +501,22 @@ namespace TFE_DarkForces
 		s_exitLevel = JTRUE;
 	}
 
+	// Draw the 3D view and the weapon.
+	void mission_drawView()
+	{
+		updateScreensize();
+		drawWorld(s_framebuffer, s_playerEye->sector, s_levelColorMap, s_lightSourceRamp);
+		weapon_draw(s_framebuffer, (DrawRect*)vfb_getScreenRect(VFB_RECT_UI));
+	}
+
+	// Draw the HUD and messages on top of the view and apply the palette effects.
+	void mission_drawHud()
+	{
+		hud_drawAndUpdate(s_framebuffer);
+		hud_drawMessage(s_framebuffer);
+		handlePaletteFx();
+	}
+
 	void mission_render(s32 rendererIndex)
 	{
 		if (task_getCount() > 1 && s_missionMode == MISSION_MODE_MAIN)
@@ -512,13 +528,9 @@ namespace TFE_DarkForces
 			s_framebuffer = vfb_getCpuBuffer();
 			TFE_Jedi::beginRender();
 
-			updateScreensize();
-			drawWorld(s_framebuffer, s_playerEye->sector, s_levelColorMap, s_lightSourceRamp);
-			weapon_draw(s_framebuffer, (DrawRect*)vfb_getScreenRect(VFB_RECT_UI));
+			mission_drawView();
 			handleVisionFx();
-			handlePaletteFx();
-			hud_drawAndUpdate(s_framebuffer);
-			hud_drawMessage(s_framebuffer);
+			mission_drawHud();
 			automap_resetScale();
 
 			TFE_Jedi::endRender();
@@ -526,6 +538,27 @@ namespace TFE_DarkForces
 		}
 	}
 		
+	// TFE: With a fixed simulation step, frames where the tasks do not run redraw the world with the camera interpolated
+	// between the last two steps, so the render rate can exceed the simulation rate.
+	// Objects are drawn at their last simulated positions, and nothing is drawn this way while a menu, the PDA or the automap is up.
+	void mission_renderBetweenSteps()
+	{
+		if (task_getCount() <= 1 || s_missionMode != MISSION_MODE_MAIN || s_gamePaused || !s_playerEye) { return; }
+		if (escapeMenu_isOpen() || pda_isOpen() || s_drawAutomap) { return; }
+		if (!time_getFixedStep() || !TFE_Settings::getGraphicsSettings()->interpolateCamera) { return; }
+
+		s_framebuffer = vfb_getCpuBuffer();
+		TFE_Jedi::beginRender();
+
+		player_setupCamera();
+		mission_drawView();
+		// handleVisionFx() is skipped since its countdowns are part of the simulation.
+		mission_drawHud();
+
+		TFE_Jedi::endRender();
+		vfb_swap();
+	}
+
 	void mission_mainTaskFunc(MessageType msg)
 	{
 		task_begin;
@@ -559,9 +592,7 @@ namespace TFE_DarkForces
 				}
 				else if (s_missionMode == MISSION_MODE_MAIN)
 				{
-					updateScreensize();
-					drawWorld(s_framebuffer, s_playerEye->sector, s_levelColorMap, s_lightSourceRamp);
-					weapon_draw(s_framebuffer, (DrawRect*)vfb_getScreenRect(VFB_RECT_UI));
+					mission_drawView();
 					handleVisionFx();
 				}
 			}
@@ -573,9 +604,7 @@ namespace TFE_DarkForces
 				{
 					automap_draw(s_framebuffer);
 				}
-				hud_drawAndUpdate(s_framebuffer);
-				hud_drawMessage(s_framebuffer);
-				handlePaletteFx();
+				mission_drawHud();
 			}
 			else
 			{
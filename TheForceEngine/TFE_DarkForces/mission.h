@@ -36,6 +36,7 @@ namespace TFE_DarkForces
 	void disableNightvision();
 
 	void mission_render(s32 rendererIndex = 0);
+	void mission_renderBetweenSteps();
 
 	void mission_setupTasks();
 	void mission_serialize(Stream* stream);
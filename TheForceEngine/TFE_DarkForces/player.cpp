@@ -228,6 +228,18 @@ namespace TFE_DarkForces
 	Tick s_nextPainSndTick = 0;
 	Task* s_playerTask = nullptr;
 
+	// TFE: Camera from the last two fixed simulation steps, used to interpolate rendering between steps.
+	struct CameraStep
+	{
+		vec3_fixed pos;
+		angle14_32 pitch;
+		angle14_32 yaw;
+		RSector* sector;
+	};
+	static CameraStep s_cameraStep[2];	// previous and current step.
+	static Tick s_cameraStepTick = 0;
+	static JBool s_cameraStepValid = JFALSE;
+
 	fixed16_16 s_playerYPos;
 	vec3_fixed s_camOffset = { 0 };
 	angle14_32 s_camOffsetPitch = 0;
@@ -649,6 +661,7 @@ namespace TFE_DarkForces
 			s_playerEye->flags |= s_playerEyeFlags;
 		}
 		s_playerEye = obj;
+		s_cameraStepValid = JFALSE;
 		player_setupCamera();
 
 		s_playerEye->flags |= OBJ_FLAG_EYE;
@@ -1021,14 +1034,60 @@ namespace TFE_DarkForces
 			s_yaw   = s_playerEye->yaw   + s_camOffsetYaw;
 			s_roll  = s_playerEye->roll  + s_camOffsetRoll;
 
-			if (s_playerEye->sector)
+			if (s_playerEye->sector && time_getFixedStep() && TFE_Settings::getGraphicsSettings()->interpolateCamera)
+			{
+				player_setupInterpolatedCamera();
+			}
+			else if (s_playerEye->sector)
 			{
 				renderer_computeCameraTransform(s_playerEye->sector, s_pitch, s_yaw, s_eyePos.x, s_eyePos.y, s_eyePos.z);
+				s_cameraStepValid = JFALSE;
 			}
 			renderer_setWorldAmbient(s_playerLight);
 		}
 	}
 
+	// TFE: Render the camera between the previous and current fixed step, based on how much of the next step has elapsed.
+	// This is called for every rendered frame, but the simulation state (s_eyePos, s_yaw, ...) is left unchanged.
+	void player_setupInterpolatedCamera()
+	{
+		const CameraStep step = { s_eyePos, s_pitch, s_yaw, s_playerEye->sector };
+		const Tick fixedStep = time_getFixedStep();
+		// Snap to the current camera on the first step or after a gap (such as loading), rather than sweeping across it.
+		if (!s_cameraStepValid || s_curTick < s_cameraStepTick || s_curTick - s_cameraStepTick > 4 * fixedStep)
+		{
+			s_cameraStep[0] = step;
+			s_cameraStepValid = JTRUE;
+		}
+		else if (s_curTick != s_cameraStepTick)
+		{
+			s_cameraStep[0] = s_cameraStep[1];
+		}
+		s_cameraStep[1] = step;
+		s_cameraStepTick = s_curTick;
+
+		const CameraStep* prev = &s_cameraStep[0];
+		const CameraStep* next = &s_cameraStep[1];
+		const fixed16_16 blend = floatToFixed16(time_getStepFraction());
+		const fixed16_16 x = prev->pos.x + mul16(next->pos.x - prev->pos.x, blend);
+		const fixed16_16 y = prev->pos.y + mul16(next->pos.y - prev->pos.y, blend);
+		const fixed16_16 z = prev->pos.z + mul16(next->pos.z - prev->pos.z, blend);
+		const angle14_32 pitch = prev->pitch + mul16(next->pitch - prev->pitch, blend);
+		const angle14_32 yaw = prev->yaw + mul16(getAngleDifference(prev->yaw, next->yaw), blend);
+
+		RSector* sector = next->sector;
+		if (prev->sector != next->sector)
+		{
+			// The camera crossed into a new sector during the step, find the sector that contains the interpolated position.
+			sector = sector_which3D(x, y, z);
+			if (!sector)
+			{
+				sector = blend < HALF_16 ? prev->sector : next->sector;
+			}
+		}
+		renderer_computeCameraTransform(sector, pitch, yaw, x, y, z);
+	}
+
 	void computeDamagePushVelocity(ProjectileLogic* proj, vec3_fixed* vel)
 	{
 		fixed16_16 push = mul16(proj->projForce, proj->speed);
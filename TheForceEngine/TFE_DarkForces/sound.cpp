@@ -65,7 +65,7 @@ namespace TFE_DarkForces
 	void sound_open(MemoryRegion* memRegion)
 	{
 		s_state = {};
-		s_state.gameSoundList = allocator_create(sizeof(GameSound), s_gameRegion);
+		s_state.gameSoundList = allocator_createTagged(REGION_TAG_AUDIO, sizeof(GameSound), s_gameRegion);
 		ImInitialize(memRegion);
 		
 		TFE_Settings_Sound* sound = TFE_Settings::getSoundSettings();
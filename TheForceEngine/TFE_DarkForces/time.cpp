@@ -1,6 +1,7 @@
 #include "time.h"
 #include <TFE_System/system.h>
 #include <TFE_Jedi/Serialization/serialization.h>
+#include <TFE_Jedi/Task/task.h>
 #include <cstring>
 
 using namespace TFE_Jedi;
@@ -14,6 +15,18 @@ namespace TFE_DarkForces
 	fixed16_16 s_frameTicks[13] = { 0 };
 	JBool s_pauseTimeUpdate = JFALSE;
 
+	enum TimeConstants
+	{
+		// Maximum number of fixed steps taken in a single frame, any time beyond that is dropped (hitches, loading).
+		FIXED_STEP_MAX_CATCHUP = 4,
+	};
+	static Tick s_fixedStep = 0;
+	static s32 s_pendingSteps = 0;
+	static f32 s_stepFraction = 0.0f;
+
+	void updateFixedStep();
+	void beginFixedStep();
+
 	void time_serialize(Stream* stream)
 	{
 		SERIALIZE(SaveVersionInit, s_curTick, 0);
@@ -21,6 +34,10 @@ namespace TFE_DarkForces
 		SERIALIZE(SaveVersionInit, s_timeAccum, 0.0);
 		SERIALIZE(SaveVersionInit, s_deltaTime, 0);
 		SERIALIZE_BUF(SaveVersionInit, s_frameTicks, sizeof(fixed16_16) * TFE_ARRAYSIZE(s_frameTicks));
+		if (serialization_getMode() == SMODE_READ)
+		{
+			s_pendingSteps = 0;
+		}
 	}
 
 	Tick time_frameRateToDelay(u32 frameRate)
@@ -41,6 +58,39 @@ namespace TFE_DarkForces
 	void time_pause(JBool pause)
 	{
 		s_pauseTimeUpdate = pause;
+		if (pause)
+		{
+			// Steps that have not run yet are dropped, so time does not advance while paused.
+			s_pendingSteps = 0;
+		}
+	}
+
+	void time_setFixedStep(Tick step)
+	{
+		if (step == s_fixedStep) { return; }
+		s_fixedStep = step;
+		s_pendingSteps = 0;
+		s_stepFraction = 0.0f;
+		task_setFixedStep(step ? JTRUE : JFALSE, beginFixedStep);
+	}
+
+	Tick time_getFixedStep()
+	{
+		return s_fixedStep;
+	}
+
+	f32 time_getStepFraction()
+	{
+		return s_stepFraction;
+	}
+
+	void advanceFrameTicks(Tick ticks)
+	{
+		fixed16_16 dt = div16(intToFixed16(ticks), FIXED(TICKS_PER_SECOND));
+		for (s32 i = 0; i < 13; i++)
+		{
+			s_frameTicks[i] += mul16(dt, intToFixed16(i));
+		}
 	}
 
 	void updateTime()
@@ -50,13 +100,56 @@ namespace TFE_DarkForces
 			s_timeAccum += TFE_System::getDeltaTime() * TIMER_FREQ;
 		}
 
-		Tick prevTick = s_curTick;
-		s_curTick = Tick(s_timeAccum);
+		if (s_fixedStep)
+		{
+			updateFixedStep();
+		}
+		else
+		{
+			Tick prevTick = s_curTick;
+			s_curTick = Tick(s_timeAccum);
+			advanceFrameTicks(s_curTick - prevTick);
+		}
+	}
 
-		fixed16_16 dt = div16(intToFixed16(s_curTick - prevTick), FIXED(TICKS_PER_SECOND));
-		for (s32 i = 0; i < 13; i++)
+	// Queue time in whole steps, so the simulation rate does not depend on the frame rate.
+	// The tasks run once per step and the time is advanced by beginFixedStep() as each step starts.
+	void updateFixedStep()
+	{
+		// Keep running the tasks while paused so the menus and PDA are updated, as with the variable step.
+		if (s_pauseTimeUpdate)
 		{
-			s_frameTicks[i] += mul16(dt, intToFixed16(i));
+			s_pendingSteps = 0;
+			task_setQueuedSteps(1);
+			return;
 		}
+
+		Tick queuedTick = s_curTick + s_pendingSteps * s_fixedStep;
+		if (s_timeAccum < f64(queuedTick))
+		{
+			s_timeAccum = f64(queuedTick);
+		}
+		s32 steps = s32((Tick(s_timeAccum) - queuedTick) / s_fixedStep);
+		if (s_pendingSteps + steps > FIXED_STEP_MAX_CATCHUP)
+		{
+			steps = max(0, FIXED_STEP_MAX_CATCHUP - s_pendingSteps);
+			s_timeAccum = f64(queuedTick + steps * s_fixedStep);
+		}
+		s_pendingSteps += steps;
+		queuedTick += steps * s_fixedStep;
+		task_setQueuedSteps(s_pendingSteps);
+
+		// The fraction is relative to the time after the queued steps, which is where the simulation will be when the frame is drawn.
+		s_stepFraction = clamp(f32((s_timeAccum - f64(queuedTick)) / f64(s_fixedStep)), 0.0f, 1.0f);
+	}
+
+	void beginFixedStep()
+	{
+		// Steps queued while paused only update the menus, they do not advance time.
+		if (s_pendingSteps <= 0) { return; }
+
+		s_pendingSteps--;
+		s_curTick += s_fixedStep;
+		advanceFrameTicks(s_fixedStep);
 	}
 }  // TFE_DarkForces
\ No newline at end of file
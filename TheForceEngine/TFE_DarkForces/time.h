@@ -53,5 +53,12 @@ namespace TFE_DarkForces
 	void updateTime();
 	void time_pause(JBool pause);
 
+	// TFE: Fixed simulation step in ticks, 0 = the original variable step where every frame advances time.
+	// With a fixed step, time advances in whole steps and the tasks only run when a step is taken, regardless of the frame rate.
+	void time_setFixedStep(Tick step);
+	Tick time_getFixedStep();
+	// Fraction of the next fixed step that has elapsed [0, 1], used to interpolate rendering between steps.
+	f32  time_getStepFraction();
+
 	void time_serialize(Stream* stream);
 }  // namespace TFE_DarkForces
\ No newline at end of file
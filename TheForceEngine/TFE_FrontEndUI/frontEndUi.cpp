@@ -167,6 +167,17 @@ namespace TFE_FrontEndUI
 		"GPU / OpenGL",
 	};
 
+	// Indexed by the fixed simulation step in ticks.
+	static const char* c_simulationRate[] =
+	{
+		"Variable (Original)",
+		"145 Hz",
+		"72 Hz",
+		"48 Hz",
+		"36 Hz",
+	};
+	static_assert(IM_ARRAYSIZE(c_simulationRate) == SIMULATION_STEP_MAX + 1, "Each simulation step needs a name.");
+
 	static const char* c_colorMode[] =
 	{
 		"8-bit (Classic)",		// COLORMODE_8BIT
@@ -2352,6 +2363,16 @@ namespace TFE_FrontEndUI
 			graphics->frameRateLimit = frameRateLimit;
 			TFE_System::frameLimiter_set(frameRateLimit);
 		}
+
+		// Fixed simulation rate, independent of the frame rate.
+		ImGui::LabelText("##ConfigLabel", "Simulation Rate:"); ImGui::SameLine(150 * s_uiScale);
+		ImGui::SetNextItemWidth(196 * s_uiScale);
+		graphics->simulationStep = clamp(graphics->simulationStep, 0, (s32)SIMULATION_STEP_MAX);
+		ImGui::Combo("##SimulationRate", &graphics->simulationStep, c_simulationRate, IM_ARRAYSIZE(c_simulationRate));
+		if (graphics->simulationStep)
+		{
+			ImGui::Checkbox("Interpolate Camera Between Steps", &graphics->interpolateCamera);
+		}
 		ImGui::Separator();
 
 		ImGui::LabelText("##ConfigLabel", "Renderer:"); ImGui::SameLine(75 * s_uiScale);
@@ -2395,6 +2416,15 @@ namespace TFE_FrontEndUI
 				graphics->skyMode = SkyMode(skyMode);
 			}
 
+			ImGui::Checkbox("Cache Packed Textures", &graphics->textureAtlasCache);
+			ImGui::Checkbox("Cache Compiled Shaders", &graphics->shaderCache);
+
+			// Texture streaming, 0 = upload all texture pages when the level loads.
+			ImGui::LabelText("##ConfigLabel", "Texture Upload MB/Frame"); ImGui::SameLine(comboOffset);
+			ImGui::SetNextItemWidth(196 * s_uiScale);
+			ImGui::SliderInt("##TextureUploadBudget", &graphics->textureUploadBudget, 0, TEXTURE_UPLOAD_BUDGET_MAX, "%d");
+			graphics->textureUploadBudget = clamp(graphics->textureUploadBudget, 0, (s32)TEXTURE_UPLOAD_BUDGET_MAX);
+
 			ImGui::Separator();
 
 			// Color Mode
@@ -2723,6 +2753,8 @@ namespace TFE_FrontEndUI
 		{
 			system->returnToModLoader = returnToModLoader;
 		}
+		ImGui::Checkbox("Use TLSF Memory Allocator (next game start)", &system->tlsfRegionAllocator);
+		ImGui::Checkbox("Pre-fault Game Memory (next game start)", &system->prefaultRegions);
 
 		f32 labelW = 140 * s_uiScale;
 		f32 valueW = 260 * s_uiScale - 10;
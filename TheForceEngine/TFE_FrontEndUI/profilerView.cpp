@@ -9,6 +9,7 @@
 #include <TFE_Ui/ui.h>
 #include <TFE_Ui/markdown.h>
 #include <TFE_System/parser.h>
+#include <TFE_Jedi/Task/task.h>
 
 #include <TFE_Ui/imGUI/imgui.h>
 #include <algorithm>
@@ -26,6 +27,44 @@ namespace TFE_ProfilerView
 	{
 	}
 
+	static std::vector<TaskProfileInfo> s_taskProfile;
+
+	// Tasks sorted by average time per frame, all tasks with the same name are combined.
+	void drawTaskProfile()
+	{
+		ImGui::Spacing();
+		ImGui::LabelText("##Label", "Tasks (microseconds)");
+		ImGui::Separator();
+
+		const u32 taskCount = TFE_Jedi::task_getProfileCount();
+		s_taskProfile.resize(taskCount);
+		for (u32 t = 0; t < taskCount; t++)
+		{
+			TFE_Jedi::task_getProfileInfo(t, &s_taskProfile[t]);
+		}
+		std::sort(s_taskProfile.begin(), s_taskProfile.end(), [](const TaskProfileInfo& a, const TaskProfileInfo& b)
+		{
+			return a.timeAve > b.timeAve;
+		});
+
+		ImGui::Indent();
+		ImGui::Text("Average"); ImGui::SameLine(90);
+		ImGui::Text("Frame"); ImGui::SameLine(180);
+		ImGui::Text("Max Call"); ImGui::SameLine(270);
+		ImGui::Text("Calls"); ImGui::SameLine(340);
+		ImGui::Text("Task");
+		for (u32 t = 0; t < taskCount; t++)
+		{
+			const TaskProfileInfo& info = s_taskProfile[t];
+			ImGui::Text("%0.1f", info.timeAve); ImGui::SameLine(90);
+			ImGui::Text("%0.1f", info.timeInFrame); ImGui::SameLine(180);
+			ImGui::Text("%0.1f", info.maxCallTime); ImGui::SameLine(270);
+			ImGui::Text("%u", info.callCount); ImGui::SameLine(340);
+			ImGui::Text("%s", info.name);
+		}
+		ImGui::Unindent();
+	}
+
 	void update()
 	{
 		if (!s_open) { return; }
@@ -81,6 +120,11 @@ namespace TFE_ProfilerView
 		ImGui::Unindent();
 		ImGui::Unindent();
 
+		if (TFE_Jedi::task_isProfilingEnabled())
+		{
+			drawTaskProfile();
+		}
+
 		ImGui::End();
 	}
 
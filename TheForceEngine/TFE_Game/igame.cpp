@@ -1,5 +1,8 @@
 #include "igame.h"
 #include <TFE_FrontEndUI/console.h>
+#include <TFE_Settings/settings.h>
+#include <TFE_System/profiler.h>
+#include <TFE_Jedi/Memory/memoryBenchmark.h>
 #include <TFE_DarkForces/darkForcesMain.h>
 #include <TFE_Outlaws/outlawsMain.h>
 
@@ -8,12 +11,29 @@ enum GameConstants
 	GAME_MEMORY_BASE  = 8 * 1024 * 1024, // 8 MB
 	LEVEL_MEMORY_BASE = 8 * 1024 * 1024, // 8 MB
 	RES_MEMORY_BASE   = 8 * 1024 * 1024, // 8 MB
+	// With pre-faulting enabled, the level region is reserved up front so larger levels do not grow it mid-level.
+	LEVEL_MEMORY_RESERVE = 2 * LEVEL_MEMORY_BASE,
 };
 
 using namespace TFE_Memory;
 MemoryRegion* s_gameRegion = nullptr;
 MemoryRegion* s_levelRegion = nullptr;
 
+// Per-frame region telemetry, exposed as profiler counters.
+struct RegionCounters
+{
+	s32 usedKB;
+	s32 highWaterKB;
+	s32 largestFreeKB;
+	s32 fragmentation;	// percent
+	s32 allocsPerFrame;
+	s32 freesPerFrame;
+	u64 prevAllocCount;
+	u64 prevFreeCount;
+};
+static RegionCounters s_gameCounters = { 0 };
+static RegionCounters s_levelCounters = { 0 };
+
 void displayMemoryUsage(const ConsoleArgList& args)
 {
 	char res[256];
@@ -31,12 +51,60 @@ void displayMemoryUsage(const ConsoleArgList& args)
 	TFE_Console::addToHistory("-------------------------------------------------------------------");
 }
 
+void updateRegionCounters(MemoryRegion* region, RegionCounters* counters)
+{
+	RegionTelemetry telemetry;
+	region_getTelemetry(region, &telemetry);
+
+	counters->usedKB = s32(telemetry.used >> 10);
+	counters->highWaterKB = s32(telemetry.highWater >> 10);
+	counters->largestFreeKB = s32(telemetry.largestFree >> 10);
+	counters->fragmentation = s32(telemetry.fragmentation * 100.0f + 0.5f);
+	counters->allocsPerFrame = s32(telemetry.allocCount - counters->prevAllocCount);
+	counters->freesPerFrame = s32(telemetry.freeCount - counters->prevFreeCount);
+	counters->prevAllocCount = telemetry.allocCount;
+	counters->prevFreeCount = telemetry.freeCount;
+}
+
+void game_updateMemoryTelemetry()
+{
+	if (!s_gameRegion || !s_levelRegion) { return; }
+	updateRegionCounters(s_gameRegion, &s_gameCounters);
+	updateRegionCounters(s_levelRegion, &s_levelCounters);
+}
+
 void game_init()
 {
+	TFE_Settings_System* systemSettings = TFE_Settings::getSystemSettings();
+	region_setDefaultStrategy(systemSettings->tlsfRegionAllocator ? REGION_ALLOC_TLSF : REGION_ALLOC_FIRST_FIT);
+	if (systemSettings->prefaultRegions)
+	{
+		region_setDefaultBacking(REGION_BACKING_HUGE_PAGES | REGION_BACKING_PREFAULT);
+	}
 	s_gameRegion  = region_create("game",  GAME_MEMORY_BASE);	// Region for "permanent" game allocations.
 	s_levelRegion = region_create("level", LEVEL_MEMORY_BASE);	// Region for "per-level" game allocations.
+	if (systemSettings->prefaultRegions)
+	{
+		region_reserve(s_levelRegion, LEVEL_MEMORY_RESERVE);
+	}
+	// Other regions keep the default backing.
+	region_setDefaultBacking(REGION_BACKING_DEFAULT);
 
 	CCMD("displayMemoryUsage", displayMemoryUsage, 0, "Display memory usage.");
+	TFE_Jedi::memoryBenchmark_init();
+
+	s_gameCounters = { 0 };
+	s_levelCounters = { 0 };
+	TFE_COUNTER(s_gameCounters.usedKB,          "Game Region Used KB");
+	TFE_COUNTER(s_gameCounters.highWaterKB,     "Game Region Peak KB");
+	TFE_COUNTER(s_gameCounters.fragmentation,   "Game Region Fragmentation %");
+	TFE_COUNTER(s_gameCounters.allocsPerFrame,  "Game Region Allocs/Frame");
+	TFE_COUNTER(s_levelCounters.usedKB,         "Level Region Used KB");
+	TFE_COUNTER(s_levelCounters.highWaterKB,    "Level Region Peak KB");
+	TFE_COUNTER(s_levelCounters.largestFreeKB,  "Level Region Largest Free KB");
+	TFE_COUNTER(s_levelCounters.fragmentation,  "Level Region Fragmentation %");
+	TFE_COUNTER(s_levelCounters.allocsPerFrame, "Level Region Allocs/Frame");
+	TFE_COUNTER(s_levelCounters.freesPerFrame,  "Level Region Frees/Frame");
 }
 
 void game_destroy()
@@ -18,6 +18,12 @@ extern MemoryRegion* s_levelRegion;
 #define level_realloc(ptr, size) TFE_Memory::region_realloc(s_levelRegion, ptr, size)
 #define level_free(ptr) TFE_Memory::region_free(s_levelRegion, ptr)
 
+// Tagged versions for subsystems that report their memory usage separately, see TFE_REGION_TAGS.
+#define game_allocTagged(size, tag) TFE_Memory::region_allocTagged(s_gameRegion, size, tag)
+#define game_reallocTagged(ptr, size, tag) TFE_Memory::region_reallocTagged(s_gameRegion, ptr, size, tag)
+#define level_allocTagged(size, tag) TFE_Memory::region_allocTagged(s_levelRegion, size, tag)
+#define level_reallocTagged(ptr, size, tag) TFE_Memory::region_reallocTagged(s_levelRegion, ptr, size, tag)
+
 struct IGame
 {
 	virtual bool runGame(s32 argCount, const char* argv[], Stream* stream) = 0;
@@ -40,3 +46,5 @@ void   freeGame(IGame* game);
 
 void game_init();
 void game_destroy();
+// Sample the game and level region telemetry, called once per frame.
+void game_updateMemoryTelemetry();
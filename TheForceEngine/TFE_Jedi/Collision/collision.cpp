@@ -4,6 +4,9 @@
 #include <TFE_Jedi/Level/rwall.h>
 #include <TFE_Jedi/Level/robject.h>
 #include <TFE_Jedi/Level/rtexture.h>
+#include <TFE_Jedi/Level/sectorGrid.h>
+#include <TFE_Jedi/Level/sectorPvs.h>
+#include <TFE_Jedi/Level/sectorWallRanges.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
 // Merge player collision into collision
@@ -151,12 +154,16 @@ namespace TFE_Jedi
 
 	RWall* collision_pathWallCollision(RSector* sector)
 	{
-		RWall* wall = sector->walls;
-		s32 count = sector->wallCount;
 		RWall* hitWall = nullptr;
 		s_col_hitDist = c_maxCollisionDist;
-		for (s32 i = 0; i < sector->wallCount; i++, wall++)
+
+		// TFE: pathIntersectsWall() rejects any wall whose X range does not overlap the path, so only
+		// the remaining walls are tested (in the original order, so ties resolve the same way).
+		s32 count;
+		const s32* candidates = wallRanges_getWallsInX(sector, min(s_col_path.x0, s_col_path.x1), max(s_col_path.x0, s_col_path.x1), &count);
+		for (s32 i = 0; i < count; i++)
 		{
+			RWall* wall = &sector->walls[candidates[i]];
 			if (s_collisionFrameWall == wall->collisionFrame)
 			{
 				continue;
@@ -368,7 +375,7 @@ namespace TFE_Jedi
 		s_colObjZ0 = interval->z0;
 		s_colObjZ1 = interval->z1;
 		s_colObjInterval = interval;
-		s_colObjList = sector->objectList;
+		s_colObjList = sector->objectDense;
 		s_colObjCount = sector->objectCount;
 		s_colObjMove = interval->move;
 		s_colObjDirX = interval->dirX;
@@ -404,6 +411,12 @@ namespace TFE_Jedi
 
 	JBool collision_lineOfSight(RSector* sector0, RSector* sector1, vec3_fixed pos0, vec3_fixed pos1, u32 wallFlags3)
 	{
+		// TFE: Skip walking the walls if no straight path through adjoins connects the sectors.
+		if (!sectorPvs_canSee(sector0, sector1))
+		{
+			return JFALSE;
+		}
+
 		fixed16_16 len = distApprox(pos0.x, pos0.z, pos1.x, pos1.z);
 		fixed16_16 dy  = pos1.y - pos0.y;
 		fixed16_16 slope = len ? div16(dy, len) : dy;
@@ -514,6 +527,20 @@ namespace TFE_Jedi
 		
 	// Call the effectFunc() for each object within 'range' of point (x,y,z). This will only be called for objects in range and that have a valid collision path.
 	// Note the collision path is 3D (XYZ), in that it takes into account collision based on height.
+	// TFE: Get the sectors that can hold objects within the XZ range from the sector grid, in ascending order so that
+	// effects are applied in the same order as looping over every sector. Falls back to every sector if there is no grid.
+	void collision_getSectorsInRange(fixed16_16 x0, fixed16_16 z0, fixed16_16 x1, fixed16_16 z1, std::vector<s32>& sectors)
+	{
+		if (!sectorGrid_getSectorsInRect(x0, z0, x1, z1, sectors))
+		{
+			sectors.resize(s_levelState.sectorCount);
+			for (u32 i = 0; i < s_levelState.sectorCount; i++)
+			{
+				sectors[i] = s32(i);
+			}
+		}
+	}
+
 	void collision_effectObjectsInRange3D(RSector* startSector, fixed16_16 range, vec3_fixed origin, CollisionEffectFunc effectFunc, SecObject* excludeObj, u32 entityFlags)
 	{
 		const fixed16_16 x0 = origin.x - range;
@@ -525,19 +552,23 @@ namespace TFE_Jedi
 		const fixed16_16 z1 = origin.z + range;
 
 		const fixed16_16 secHeightThreshold = origin.y - COL_SEC_HEIGHT_OFFSET;
-		RSector* sector = s_levelState.sectors;
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		// The original checks the start sector inside of the sector loop, TFE pulls it out since it does not change.
+		if (!s_levelState.sectorCount || x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
 		{
-			// Checks the start sector, should be pulled out of the loop.
-			if (x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
-			{
-				continue;
-			}
+			return;
+		}
 
+		// TFE: Only visit sectors that overlap the range, rather than every sector in the level.
+		// Note the list is local since effect functions may set off other effects.
+		std::vector<s32> sectors;
+		collision_getSectorsInRange(x0, z0, x1, z1, sectors);
+		const s32 sectorCount = (s32)sectors.size();
+		for (s32 i = 0; i < sectorCount; i++)
+		{
+			RSector* sector = &s_levelState.sectors[sectors[i]];
 			fixed16_16 floor, ceil;
 			sector_calculateFloor(sector, origin.y, &floor, &ceil);
 			if (y0 > floor || y1 < ceil) { continue; }
-			// End of start sector check.
 
 			for (s32 objIndex = 0, objListIndex = 0; objIndex < sector->objectCount && objListIndex < sector->objectCapacity; objListIndex++)
 			{
@@ -585,22 +616,25 @@ namespace TFE_Jedi
 		const fixed16_16 z1 = origin.z + range;
 
 		const fixed16_16 secHeightThreshold = origin.y - COL_SEC_HEIGHT_OFFSET;
-		RSector* sector = s_levelState.sectors;
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		// The original checks the start sector inside of the sector loop, TFE pulls it out since it does not change.
+		if (!s_levelState.sectorCount || x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
 		{
-			// Checks the start sector, should be pulled out of the loop.
-			if (x0 > startSector->boundsMax.x || x1 < startSector->boundsMin.x || z0 > startSector->boundsMax.z || z1 < startSector->boundsMin.z)
-			{
-				continue;
-			}
-			fixed16_16 floor, ceil;
-			sector_calculateFloor(startSector, origin.y, &floor, &ceil);
-			if (y0 > floor || y1 < ceil)
-			{
-				continue;
-			}
-			// End of start sector check.
+			return;
+		}
+		fixed16_16 floor, ceil;
+		sector_calculateFloor(startSector, origin.y, &floor, &ceil);
+		if (y0 > floor || y1 < ceil)
+		{
+			return;
+		}
 
+		// TFE: Only visit sectors that overlap the range, rather than every sector in the level.
+		std::vector<s32> sectors;
+		collision_getSectorsInRange(x0, z0, x1, z1, sectors);
+		const s32 sectorCount = (s32)sectors.size();
+		for (s32 i = 0; i < sectorCount; i++)
+		{
+			RSector* sector = &s_levelState.sectors[sectors[i]];
 			for (s32 objIndex = 0, objListIndex = 0; objIndex < sector->objectCount && objListIndex < sector->objectCapacity; objListIndex++)
 			{
 				SecObject* obj = sector->objectList[objListIndex];
@@ -954,8 +988,6 @@ namespace TFE_Jedi
 		for (; s_colObjCount > 0; s_colObjList++)
 		{
 			SecObject* obj = *s_colObjList;
-			if (!obj) { continue; }
-
 			s_colObjCount--;
 			if (!obj->worldWidth || obj == s_colObjPrev) { continue; }
 
@@ -996,6 +1028,14 @@ namespace TFE_Jedi
 	JBool collision_canHitObject(RSector* startSector, RSector* endSector, vec3_fixed p0, vec3_fixed p1, u32 exclWallFlags3)
 	{
 		s_collision_wallHit = JFALSE;
+		// TFE: Skip walking the walls if no straight path through adjoins connects the sectors.
+		// Any such path is blocked by a wall, so report the hit for callers that test more than one target point.
+		if (!sectorPvs_canSee(startSector, endSector))
+		{
+			s_collision_wallHit = JTRUE;
+			return JFALSE;
+		}
+
 		fixed16_16 approxDist = distApprox(p0.x, p0.z, p1.x, p1.z);
 		fixed16_16 dy = p1.y - p0.y;
 		fixed16_16 yStep = approxDist ? div16(dy, approxDist) : dy;
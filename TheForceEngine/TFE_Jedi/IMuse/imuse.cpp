@@ -21,8 +21,8 @@ namespace TFE_Jedi
 	#define IM_MAX_SOUNDS 32
 	#define IM_MIDI_FILE_COUNT 6
 	#define IM_MIDI_PLAYER_COUNT 2
-	#define imuse_alloc(size) TFE_Memory::region_alloc(s_memRegion, size)
-	#define imuse_realloc(ptr, size) TFE_Memory::region_realloc(s_memRegion, ptr, size)
+	#define imuse_alloc(size) TFE_Memory::region_allocTagged(s_memRegion, size, REGION_TAG_AUDIO)
+	#define imuse_realloc(ptr, size) TFE_Memory::region_reallocTagged(s_memRegion, ptr, size, REGION_TAG_AUDIO)
 	#define imuse_free(ptr) TFE_Memory::region_free(s_memRegion, ptr)
 	
 	////////////////////////////////////////////////////
@@ -108,7 +108,7 @@ namespace TFE_Jedi
 				assert(linkSector == sector);
 				if (!linkSector->infLink)
 				{
-					linkSector->infLink = allocator_create(sizeof(InfLink));
+					linkSector->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 				}
 				elevLink = (InfLink*)allocator_newItem(linkSector->infLink);
 			}
@@ -148,7 +148,7 @@ namespace TFE_Jedi
 		else
 		{
 			SERIALIZE(InfState_InitVersion, stopCount, 0);
-			elev->stops = stopCount ? allocator_create(sizeof(Stop)) : nullptr;
+			elev->stops = stopCount ? allocator_createTagged(REGION_TAG_INF, sizeof(Stop)) : nullptr;
 			for (s32 s = 0; s < stopCount; s++)
 			{
 				Stop* stop = (Stop*)allocator_newItem(elev->stops);
@@ -186,7 +186,7 @@ namespace TFE_Jedi
 		else
 		{
 			SERIALIZE(InfState_InitVersion, slaveCount, 0);
-			elev->slaves = allocator_create(sizeof(Slave));
+			elev->slaves = allocator_createTagged(REGION_TAG_INF, sizeof(Slave));
 			for (s32 s = 0; s < slaveCount; s++)
 			{
 				Slave* slave = (Slave*)allocator_newItem(elev->slaves);
@@ -276,7 +276,7 @@ namespace TFE_Jedi
 			{
 				if (!linkSector->infLink)
 				{
-					linkSector->infLink = allocator_create(sizeof(InfLink));
+					linkSector->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 				}
 				Allocator* parent = linkSector->infLink;
 				InfLink* link = (InfLink*)allocator_newItem(parent);
@@ -375,7 +375,7 @@ namespace TFE_Jedi
 			{
 				if (!parentSector->infLink)
 				{
-					parentSector->infLink = allocator_create(sizeof(InfLink));
+					parentSector->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 				}
 				parent = parentSector->infLink;
 				link = (InfLink*)allocator_newItem(parentSector->infLink);
@@ -385,7 +385,7 @@ namespace TFE_Jedi
 				RWall* wall = &parentSector->walls[parentWallIndex];
 				if (!wall->infLink)
 				{
-					wall->infLink = allocator_create(sizeof(InfLink));
+					wall->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 				}
 				parent = wall->infLink;
 				triggerWall = wall;
@@ -416,7 +416,7 @@ namespace TFE_Jedi
 		{
 			s32 targetCount;
 			SERIALIZE(InfState_InitVersion, targetCount, 0);
-			trigger->targets = allocator_create(sizeof(TriggerTarget));
+			trigger->targets = allocator_createTagged(REGION_TAG_INF, sizeof(TriggerTarget));
 			for (s32 i = 0; i < targetCount; i++)
 			{
 				TriggerTarget* target = (TriggerTarget*)allocator_newItem(trigger->targets);
@@ -654,7 +654,7 @@ namespace TFE_Jedi
 		}
 		else // SMODE_READ
 		{
-			stop->messages = allocator_create(sizeof(InfMessage));
+			stop->messages = allocator_createTagged(REGION_TAG_INF, sizeof(InfMessage));
 			for (s32 m = 0; m < msgCount; m++)
 			{
 				InfMessage* msg = (InfMessage*)allocator_newItem(stop->messages);
@@ -682,7 +682,7 @@ namespace TFE_Jedi
 		}
 		else  // SMODE_READ
 		{
-			stop->adjoinCmds = allocator_create(sizeof(AdjoinCmd));
+			stop->adjoinCmds = allocator_createTagged(REGION_TAG_INF, sizeof(AdjoinCmd));
 			for (s32 a = 0; a < adjCount; a++)
 			{
 				AdjoinCmd* adjCmd = (AdjoinCmd*)allocator_newItem(stop->adjoinCmds);
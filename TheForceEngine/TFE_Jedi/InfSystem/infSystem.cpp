@@ -14,6 +14,7 @@
 #include <TFE_Jedi/Memory/allocator.h>
 #include <TFE_Jedi/Level/level.h>
 #include <TFE_Jedi/Level/levelData.h>
+#include <TFE_Jedi/Level/sectorPvs.h>
 #include <TFE_Jedi/Collision/collision.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_System/parser.h>
@@ -118,7 +119,7 @@ namespace TFE_Jedi
 
 	void inf_createElevatorTask()
 	{
-		s_infSerState.infElevators = allocator_create(sizeof(InfElevator));
+		s_infSerState.infElevators = allocator_createTagged(REGION_TAG_INF, sizeof(InfElevator));
 		s_infState.infElevTask = createSubTask("elevator", inf_elevatorTaskFunc, inf_elevatorTaskLocal);
 	}
 
@@ -126,7 +127,7 @@ namespace TFE_Jedi
 	{
 		s_infState.teleportTask = createSubTask("teleporter", inf_telelporterTaskFunc, inf_teleporterTaskLocal);
 		task_setNextTick(s_infState.teleportTask, TASK_SLEEP);
-		s_infSerState.infTeleports = allocator_create(sizeof(Teleport));
+		s_infSerState.infTeleports = allocator_createTagged(REGION_TAG_INF, sizeof(Teleport));
 	}
 
 	void inf_createTriggerTask()
@@ -134,7 +135,7 @@ namespace TFE_Jedi
 		s_infState.infTriggerTask = createSubTask("trigger", inf_triggerTaskFunc, inf_triggerTaskLocal);
 		s_infSerState.activeTriggerCount = 0;
 		// TFE: create a trigger allocator to make tracking easier.
-		s_infSerState.infTriggers = allocator_create(sizeof(InfTrigger));
+		s_infSerState.infTriggers = allocator_createTagged(REGION_TAG_INF, sizeof(InfTrigger));
 	}
 
 	InfLink* allocateLink(Allocator* infLinks, InfElevator* elev)
@@ -155,7 +156,7 @@ namespace TFE_Jedi
 	{
 		if (!sector->infLink)
 		{
-			sector->infLink = allocator_create(sizeof(InfLink));
+			sector->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 		}
 		return allocateLink(sector->infLink, elev);
 	}
@@ -183,7 +184,7 @@ namespace TFE_Jedi
 	{
 		if (!elev->stops)
 		{
-			elev->stops = allocator_create(sizeof(Stop));
+			elev->stops = allocator_createTagged(REGION_TAG_INF, sizeof(Stop));
 		}
 		return allocateStop(elev->stops);
 	}
@@ -569,7 +570,7 @@ namespace TFE_Jedi
 		Allocator* stops = elev->stops;
 		if (!elev->stops)
 		{
-			elev->stops = allocator_create(sizeof(Stop));
+			elev->stops = allocator_createTagged(REGION_TAG_INF, sizeof(Stop));
 			stops = elev->stops;
 		}
 		s32 index = allocator_getCount(stops);
@@ -656,7 +657,7 @@ namespace TFE_Jedi
 	{
 		if (!elev->slaves)
 		{
-			elev->slaves = allocator_create(sizeof(Slave));
+			elev->slaves = allocator_createTagged(REGION_TAG_INF, sizeof(Slave));
 		}
 		Slave* slave = (Slave*)allocator_newItem(elev->slaves);
 		slave->sector = sector;
@@ -690,7 +691,7 @@ namespace TFE_Jedi
 
 		if (!sector->infLink)
 		{
-			sector->infLink = allocator_create(sizeof(InfLink));
+			sector->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 		}
 
 		InfLink* link = (InfLink*)allocator_newItem(sector->infLink);
@@ -2045,7 +2046,7 @@ namespace TFE_Jedi
 				{
 					if (!stop->adjoinCmds)
 					{
-						stop->adjoinCmds = allocator_create(sizeof(AdjoinCmd));
+						stop->adjoinCmds = allocator_createTagged(REGION_TAG_INF, sizeof(AdjoinCmd));
 					}
 					AdjoinCmd* adjoinCmd = (AdjoinCmd*)allocator_newItem(stop->adjoinCmds);
 					MessageAddress* msgAddr0 = message_getAddress(s_infArg1);
@@ -2102,7 +2103,7 @@ namespace TFE_Jedi
 				{
 					if (!stop->messages)
 					{
-						stop->messages = allocator_create(sizeof(InfMessage));
+						stop->messages = allocator_createTagged(REGION_TAG_INF, sizeof(InfMessage));
 					}
 
 					InfMessage* msg = (InfMessage*)allocator_newItem(stop->messages);
@@ -2984,6 +2985,9 @@ namespace TFE_Jedi
 
 				sector_setupWallDrawFlags(sector0);
 				sector_setupWallDrawFlags(sector1);
+				// TFE: Visibility rows computed before the adjoin changed are no longer valid.
+				sectorPvs_adjoinChanged(sector0);
+				sectorPvs_adjoinChanged(sector1);
 
 				cmd = (AdjoinCmd*)allocator_getNext(adjoinCmds);
 			}
@@ -3245,7 +3249,7 @@ namespace TFE_Jedi
 
 		InfLink* link = nullptr;
 		trigger->soundId = NULL_SOUND;
-		trigger->targets = allocator_create(sizeof(TriggerTarget));
+		trigger->targets = allocator_createTagged(REGION_TAG_INF, sizeof(TriggerTarget));
 
 		void* parent = nullptr;
 		switch (type)
@@ -3255,7 +3259,7 @@ namespace TFE_Jedi
 				RWall* wall = obj.wall;
 				if (!wall->infLink)
 				{
-					wall->infLink = allocator_create(sizeof(InfLink));
+					wall->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 				}
 				link = (InfLink*)allocator_newItem(wall->infLink);
 				link->type = LTYPE_TRIGGER;
@@ -3272,7 +3276,7 @@ namespace TFE_Jedi
 				RSector* sector = obj.sector;
 				if (!sector->infLink)
 				{
-					sector->infLink = allocator_create(sizeof(InfLink));
+					sector->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 				}
 				link = (InfLink*)allocator_newItem(sector->infLink);
 				link->type = LTYPE_TRIGGER;
@@ -3292,7 +3296,7 @@ namespace TFE_Jedi
 				trigger->soundId = s_switchDefaultSndId;
 				if (!wall->infLink)
 				{
-					wall->infLink = allocator_create(sizeof(InfLink));
+					wall->infLink = allocator_createTagged(REGION_TAG_INF, sizeof(InfLink));
 				}
 				link = (InfLink*)allocator_newItem(wall->infLink);
 				link->type = LTYPE_TRIGGER;
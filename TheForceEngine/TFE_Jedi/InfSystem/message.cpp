@@ -32,7 +32,7 @@ namespace TFE_Jedi
 	{
 		if (!s_messageAddr)
 		{
-			s_messageAddr = allocator_create(sizeof(MessageAddress));
+			s_messageAddr = allocator_createTagged(REGION_TAG_INF, sizeof(MessageAddress));
 		}
 		MessageAddress* msgAddr = (MessageAddress*)allocator_newItem(s_messageAddr);
 
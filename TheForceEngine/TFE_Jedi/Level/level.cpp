@@ -4,6 +4,7 @@
 #include "level.h"
 #include "levelBin.h"
 #include "levelData.h"
+#include "sectorGrid.h"
 #include "rwall.h"
 #include "rtexture.h"
 #include <TFE_Game/igame.h>
@@ -128,6 +129,9 @@ namespace TFE_Jedi
 		// Setup the control sector.
 		s_levelState.controlSector->id = s_levelState.sectorCount;
 		s_levelState.controlSector->index = s_levelState.controlSector->id;
+
+		// TFE: Spatial index for point queries.
+		sectorGrid_build();
 	}
 
 	JBool level_loadGeometry(const char* levelName)
@@ -232,7 +236,7 @@ namespace TFE_Jedi
 			TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read texture count.");
 			return false;
 		}
-		s_levelState.textures = (TextureData**)level_alloc(2 * s_levelState.textureCount * sizeof(TextureData**));
+		s_levelState.textures = (TextureData**)level_allocTagged(2 * s_levelState.textureCount * sizeof(TextureData**), REGION_TAG_LEVEL);
 		memset(s_levelState.textures, 0, 2 * s_levelState.textureCount * sizeof(TextureData**));
 
 		// Load Textures.
@@ -288,7 +292,7 @@ namespace TFE_Jedi
 			return false;
 		}
 
-		s_levelState.sectors = (RSector*)level_alloc(sizeof(RSector) * s_levelState.sectorCount);
+		s_levelState.sectors = (RSector*)level_allocTagged(sizeof(RSector) * s_levelState.sectorCount, REGION_TAG_LEVEL);
 		memset(s_levelState.sectors, 0, sizeof(RSector) * s_levelState.sectorCount);
 		for (u32 i = 0; i < s_levelState.sectorCount; i++)
 		{
@@ -443,8 +447,8 @@ namespace TFE_Jedi
 				return false;
 			}
 			const size_t vtxSize = vertexCount * sizeof(vec2_fixed);
-			sector->verticesWS = (vec2_fixed*)level_alloc(vtxSize);
-			sector->verticesVS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->verticesWS = (vec2_fixed*)level_allocTagged(vtxSize, REGION_TAG_LEVEL);
+			sector->verticesVS = (vec2_fixed*)level_allocTagged(vtxSize, REGION_TAG_LEVEL);
 			sector->vertexCount = vertexCount;
 
 			for (s32 v = 0; v < vertexCount; v++)
@@ -465,7 +469,7 @@ namespace TFE_Jedi
 				TFE_System::logWrite(LOG_ERROR, "level_loadGeometry", "Cannot read sector walls.");
 				return false;
 			}
-			sector->walls = (RWall*)level_alloc(wallCount * sizeof(RWall));
+			sector->walls = (RWall*)level_allocTagged(wallCount * sizeof(RWall), REGION_TAG_LEVEL);
 			sector->wallCount = wallCount;
 
 			for (s32 w = 0; w < wallCount; w++)
@@ -687,7 +691,7 @@ namespace TFE_Jedi
 	{
 		if (!s_levelState.ambientSounds)
 		{
-			s_levelState.ambientSounds = allocator_create(sizeof(AmbientSound));
+			s_levelState.ambientSounds = allocator_createTagged(REGION_TAG_LEVEL, sizeof(AmbientSound));
 			s_levelIntState.ambientSoundTask = createSubTask("AmbientSound", ambientSoundTaskFunc);
 		}
 		AmbientSound* ambientSound = (AmbientSound*)allocator_newItem(s_levelState.ambientSounds);
@@ -749,7 +753,7 @@ namespace TFE_Jedi
 		{
 			if (sscanf(line, "PODS %d", &s_levelIntState.podCount) == 1)
 			{
-				s_levelIntState.pods = (JediModel**)level_alloc(sizeof(JediModel*)*s_levelIntState.podCount);
+				s_levelIntState.pods = (JediModel**)level_allocTagged(sizeof(JediModel*)*s_levelIntState.podCount, REGION_TAG_LEVEL);
 				for (s32 p = 0; p < s_levelIntState.podCount; p++)
 				{
 					line = parser.readLine(bufferPos);
@@ -775,7 +779,7 @@ namespace TFE_Jedi
 			}
 			else if (sscanf(line, "SPRS %d", &s_levelIntState.spriteCount) == 1)
 			{
-				s_levelIntState.sprites = (JediWax**)level_alloc(sizeof(JediWax*)*s_levelIntState.spriteCount);
+				s_levelIntState.sprites = (JediWax**)level_allocTagged(sizeof(JediWax*)*s_levelIntState.spriteCount, REGION_TAG_LEVEL);
 				for (s32 s = 0; s < s_levelIntState.spriteCount; s++)
 				{
 					line = parser.readLine(bufferPos);
@@ -801,7 +805,7 @@ namespace TFE_Jedi
 			}
 			else if (sscanf(line, "FMES %d", &s_levelIntState.fmeCount) == 1)
 			{
-				s_levelIntState.frames = (JediFrame**)level_alloc(sizeof(JediFrame*)*s_levelIntState.fmeCount);
+				s_levelIntState.frames = (JediFrame**)level_allocTagged(sizeof(JediFrame*)*s_levelIntState.fmeCount, REGION_TAG_LEVEL);
 				for (s32 f = 0; f < s_levelIntState.fmeCount; f++)
 				{
 					line = parser.readLine(bufferPos);
@@ -827,7 +831,7 @@ namespace TFE_Jedi
 			}
 			else if (sscanf(line, "SOUNDS %d", &s_levelIntState.soundCount) == 1)
 			{
-				s_levelIntState.soundIds = (SoundSourceId*)level_alloc(sizeof(SoundSourceId)*s_levelIntState.soundCount);
+				s_levelIntState.soundIds = (SoundSourceId*)level_allocTagged(sizeof(SoundSourceId)*s_levelIntState.soundCount, REGION_TAG_LEVEL);
 				for (s32 s = 0; s < s_levelIntState.soundCount; s++)
 				{
 					line = parser.readLine(bufferPos);
@@ -955,7 +959,7 @@ namespace TFE_Jedi
 							{
 								if (!s_levelState.safeLoc)
 								{
-									s_levelState.safeLoc = allocator_create(sizeof(Safe));
+									s_levelState.safeLoc = allocator_createTagged(REGION_TAG_LEVEL, sizeof(Safe));
 								}
 								Safe* safe = (Safe*)allocator_newItem(s_levelState.safeLoc);
 								safe->sector = sector;
@@ -983,7 +987,7 @@ namespace TFE_Jedi
 							{
 								if (!s_levelState.safeLoc)
 								{
-									s_levelState.safeLoc = allocator_create(sizeof(Safe));
+									s_levelState.safeLoc = allocator_createTagged(REGION_TAG_LEVEL, sizeof(Safe));
 								}
 								Safe* safe = (Safe*)allocator_newItem(s_levelState.safeLoc);
 								safe->sector = obj->sector;
@@ -197,7 +197,7 @@ namespace TFE_Jedi
 			return 1;
 		}
 		s_levelState.textureCount = loadChunkNumber(header, data, offset);
-		s_levelState.textures = (TextureData**)level_alloc(2 * s_levelState.textureCount * sizeof(TextureData**));
+		s_levelState.textures = (TextureData**)level_allocTagged(2 * s_levelState.textureCount * sizeof(TextureData**), REGION_TAG_LEVEL);
 		memset(s_levelState.textures, 0, 2 * s_levelState.textureCount * sizeof(TextureData**));
 
 		// Load Textures.
@@ -251,7 +251,7 @@ namespace TFE_Jedi
 			return 1;
 		}
 		sector->wallCount = loadChunkNumber(header, data, offset);
-		sector->walls = (RWall*)level_alloc(sector->wallCount * sizeof(RWall));
+		sector->walls = (RWall*)level_allocTagged(sector->wallCount * sizeof(RWall), REGION_TAG_LEVEL);
 				
 		RWall* wall = sector->walls;
 		for (s32 w = 0; w < sector->wallCount; w++, wall++)
@@ -341,7 +341,7 @@ namespace TFE_Jedi
 		}
 
 		s_levelState.sectorCount = loadChunkNumber(header, data, offset);
-		s_levelState.sectors = (RSector*)level_alloc(sizeof(RSector) * s_levelState.sectorCount);
+		s_levelState.sectors = (RSector*)level_allocTagged(sizeof(RSector) * s_levelState.sectorCount, REGION_TAG_LEVEL);
 		memset(s_levelState.sectors, 0, sizeof(RSector) * s_levelState.sectorCount);
 		for (u32 i = 0; i < s_levelState.sectorCount && offset < dataEnd; i++)
 		{
@@ -448,8 +448,8 @@ namespace TFE_Jedi
 			}
 			sector->vertexCount = loadChunkNumber(header, data, offset);
 			const size_t vtxSize = sector->vertexCount * sizeof(vec2_fixed);
-			sector->verticesWS = (vec2_fixed*)level_alloc(vtxSize);
-			sector->verticesVS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->verticesWS = (vec2_fixed*)level_allocTagged(vtxSize, REGION_TAG_LEVEL);
+			sector->verticesVS = (vec2_fixed*)level_allocTagged(vtxSize, REGION_TAG_LEVEL);
 			for (s32 i = 0; i < sector->vertexCount; i++)
 			{
 				chunkSkipToSignature(header, LvbVertexInfoSig, offset, data);
@@ -3,6 +3,9 @@
 
 #include "levelData.h"
 #include "rsector.h"
+#include "sectorGrid.h"
+#include "sectorPvs.h"
+#include "sectorWallRanges.h"
 #include "rwall.h"
 #include "robjData.h"
 #include <TFE_Game/igame.h>
@@ -49,8 +52,11 @@ namespace TFE_Jedi
 	{
 		s_levelState = { 0 };
 		s_levelIntState = { 0 };
+		sectorGrid_clear();
+		sectorPvs_clear();
+		wallRanges_clear();
 
-		s_levelState.controlSector = (RSector*)level_alloc(sizeof(RSector));
+		s_levelState.controlSector = (RSector*)level_allocTagged(sizeof(RSector), REGION_TAG_LEVEL);
 		sector_clear(s_levelState.controlSector);
 
 		objData_clear();
@@ -139,7 +145,7 @@ namespace TFE_Jedi
 				
 		if (serialization_getMode() == SMODE_READ)
 		{
-			s_levelState.sectors = (RSector*)level_alloc(sizeof(RSector) * s_levelState.sectorCount);
+			s_levelState.sectors = (RSector*)level_allocTagged(sizeof(RSector) * s_levelState.sectorCount, REGION_TAG_LEVEL);
 			s_levelState.controlSector->id = s_levelState.sectorCount;
 			s_levelState.controlSector->index = s_levelState.controlSector->id;
 
@@ -189,7 +195,7 @@ namespace TFE_Jedi
 			s_levelState.safeLoc = nullptr;
 			if (safeCount)
 			{
-				s_levelState.safeLoc = allocator_create(sizeof(Safe));
+				s_levelState.safeLoc = allocator_createTagged(REGION_TAG_LEVEL, sizeof(Safe));
 				for (s32 s = 0; s < safeCount; s++)
 				{
 					Safe* safe = (Safe*)allocator_newItem(s_levelState.safeLoc);
@@ -202,7 +208,7 @@ namespace TFE_Jedi
 			s_levelState.ambientSounds = nullptr;
 			if (ambientSoundCount)
 			{
-				s_levelState.ambientSounds = allocator_create(sizeof(AmbientSound));
+				s_levelState.ambientSounds = allocator_createTagged(REGION_TAG_LEVEL, sizeof(AmbientSound));
 				for (s32 s = 0; s < ambientSoundCount; s++)
 				{
 					AmbientSound* sound = (AmbientSound*)allocator_newItem(s_levelState.ambientSounds);
@@ -215,6 +221,7 @@ namespace TFE_Jedi
 			}
 
 			level_serializeFixupMirrors();
+			sectorGrid_build();
 		}
 
 		// Serialize objects.
@@ -231,7 +238,7 @@ namespace TFE_Jedi
 		SERIALIZE(LevelState_InitVersion, s_levelState.textureCount, 0);
 		if (read)
 		{
-			s_levelState.textures = (TextureData**)level_alloc(2 * s_levelState.textureCount * sizeof(TextureData**));
+			s_levelState.textures = (TextureData**)level_allocTagged(2 * s_levelState.textureCount * sizeof(TextureData**), REGION_TAG_LEVEL);
 		}
 		TextureData** textures = s_levelState.textures;
 		TextureData** texBase = textures + s_levelState.textureCount;
@@ -312,8 +319,8 @@ namespace TFE_Jedi
 		const size_t vtxSize = sector->vertexCount * sizeof(vec2_fixed);
 		if (serialization_getMode() == SMODE_READ)
 		{
-			sector->verticesWS = (vec2_fixed*)level_alloc(vtxSize);
-			sector->verticesVS = (vec2_fixed*)level_alloc(vtxSize);
+			sector->verticesWS = (vec2_fixed*)level_allocTagged(vtxSize, REGION_TAG_LEVEL);
+			sector->verticesVS = (vec2_fixed*)level_allocTagged(vtxSize, REGION_TAG_LEVEL);
 		}
 		SERIALIZE_BUF(LevelState_InitVersion, sector->verticesWS, u32(vtxSize));
 		// view space vertices don't need to be serialized.
@@ -321,7 +328,7 @@ namespace TFE_Jedi
 		SERIALIZE(LevelState_InitVersion, sector->wallCount, 0);
 		if (serialization_getMode() == SMODE_READ)
 		{
-			sector->walls = (RWall*)level_alloc(sector->wallCount * sizeof(RWall));
+			sector->walls = (RWall*)level_allocTagged(sector->wallCount * sizeof(RWall), REGION_TAG_LEVEL);
 		}
 		RWall* wall = sector->walls;
 		for (s32 w = 0; w < sector->wallCount; w++, wall++)
@@ -358,6 +365,7 @@ namespace TFE_Jedi
 			sector->objectCount = 0;
 			sector->objectCapacity = 0;
 			sector->objectList = nullptr;
+			sector->objectDense = nullptr;
 		}
 
 		SERIALIZE(LevelState_InitVersion, sector->collisionFrame, 0);
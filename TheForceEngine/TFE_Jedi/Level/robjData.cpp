@@ -115,8 +115,9 @@ namespace TFE_Jedi
 
 	SecObject* objData_getObjectBySerializationId(u32 id)
 	{
-		SecObject* obj = (SecObject*)TFE_Memory::chunkedArrayGet(s_objData.objectList, id);
 		// The object may have been deleted later.
+		if (!TFE_Memory::chunkedArrayIsLive(s_objData.objectList, id)) { return nullptr; }
+		SecObject* obj = (SecObject*)TFE_Memory::chunkedArrayGet(s_objData.objectList, id);
 		return (obj && obj->serializeIndex == id) ? obj : nullptr;
 	}
 
@@ -125,6 +126,44 @@ namespace TFE_Jedi
 		return (SecObject*)TFE_Memory::chunkedArrayGet(s_objData.objectList, id);
 	}
 		
+	void objData_assignSerializeIndex(void* elem, void* userData)
+	{
+		SecObject* obj = (SecObject*)elem;
+		u32* writeCount = (u32*)userData;
+		obj->serializeIndex = *writeCount;  // So downstream serialization passes have an object ID to use.
+		(*writeCount)++;
+	}
+
+	void objData_writeObject(void* elem, void* userData)
+	{
+		SecObject* obj = (SecObject*)elem;
+		Stream* stream = (Stream*)userData;
+		// Write the object to the stream.
+		objData_serializeObject(obj, stream);
+
+		u32 logicCount = allocator_getCount((Allocator*)obj->logic);
+		SERIALIZE(ObjState_InitVersion, logicCount, 0);
+		if (!logicCount) { return; }
+
+		allocator_saveIter((Allocator*)obj->logic);
+			Logic** logicList = (Logic**)allocator_getHead((Allocator*)obj->logic);
+			while (logicList)
+			{
+				Logic* logic = *logicList;
+				if (logic)
+				{
+					TFE_DarkForces::logic_serialize(logic, obj, stream);
+				}
+				else
+				{
+					s32 invalidLogic = -1;
+					SERIALIZE(ObjState_InitVersion, invalidLogic, -1);
+				}
+				logicList = (Logic**)allocator_getNext((Allocator*)obj->logic);
+			}
+		allocator_restoreIter((Allocator*)obj->logic);
+	}
+
 	void objData_serialize(Stream* stream)
 	{
 		SERIALIZE_VERSION(ObjState_CurVersion);
@@ -140,51 +179,12 @@ namespace TFE_Jedi
 				return;
 			}
 
-			// Assign IDs
-			const u32 size = TFE_Memory::chunkedArraySize(list);
-			for (u32 i = 0; i < size; i++)
-			{
-				SecObject* obj = (SecObject*)TFE_Memory::chunkedArrayGet(list, i);
-
-				// Skip deleted objects.
-				if (!obj->self) { continue; }
-				obj->serializeIndex = writeCount;  // So downstream serialization passes have an object ID to use.
-				writeCount++;
-			}
+			// Assign IDs, the occupancy bitmap lets this skip deleted objects.
+			TFE_Memory::chunkedArrayForEach(list, objData_assignSerializeIndex, &writeCount);
 			SERIALIZE(ObjState_InitVersion, writeCount, 0);
 
 			// Write objects.
-			for (u32 i = 0; i < size; i++)
-			{
-				SecObject* obj = (SecObject*)TFE_Memory::chunkedArrayGet(list, i);
-
-				// Skip deleted objects.
-				if (!obj->self) { continue; }
-				// Write the object to the stream.
-				objData_serializeObject(obj, stream);
-
-				u32 logicCount = allocator_getCount((Allocator*)obj->logic);
-				SERIALIZE(ObjState_InitVersion, logicCount, 0);
-				if (!logicCount) { continue; }
-
-				allocator_saveIter((Allocator*)obj->logic);
-					Logic** logicList = (Logic**)allocator_getHead((Allocator*)obj->logic);
-					while (logicList)
-					{
-						Logic* logic = *logicList;
-						if (logic)
-						{
-							TFE_DarkForces::logic_serialize(logic, obj, stream);
-						}
-						else
-						{
-							s32 invalidLogic = -1;
-							SERIALIZE(ObjState_InitVersion, invalidLogic, -1);
-						}
-						logicList = (Logic**)allocator_getNext((Allocator*)obj->logic);
-					}
-				allocator_restoreIter((Allocator*)obj->logic);
-			}
+			TFE_Memory::chunkedArrayForEach(list, objData_writeObject, stream);
 		}
 		else if (serialization_getMode() == SMODE_READ)
 		{
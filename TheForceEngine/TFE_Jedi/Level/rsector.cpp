@@ -6,6 +6,9 @@
 #include "robject.h"
 #include "level.h"
 #include "levelData.h"
+#include "sectorGrid.h"
+#include "sectorPvs.h"
+#include "sectorWallRanges.h"
 #include <TFE_Game/igame.h>
 #include <TFE_System/system.h>
 #include <TFE_DarkForces/player.h>
@@ -48,6 +51,8 @@ namespace TFE_Jedi
 		sector->prevDrawFrame = 0;
 		sector->infLink = 0;
 		sector->objectCapacity = 0;
+		sector->objectList = nullptr;
+		sector->objectDense = nullptr;
 		sector->verticesWS = nullptr;
 		sector->verticesVS = nullptr;
 		sector->self = sector;
@@ -104,10 +109,9 @@ namespace TFE_Jedi
 		if (sector->objectCount)
 		{
 			fixed16_16 heightOffset = secondHeightOffset + floorOffset;
-			for (s32 i = 0; i < sector->objectCapacity; i++)
+			for (s32 i = 0; i < sector->objectCount; i++)
 			{
-				SecObject* obj = sector->objectList[i];
-				if (!obj) { continue; }
+				SecObject* obj = sector->objectDense[i];
 				
 				if (obj->posWS.y == sector->floorHeight)
 				{
@@ -208,26 +212,27 @@ namespace TFE_Jedi
 		sector->boundsMax.x = maxX;
 		sector->boundsMin.z = minZ;
 		sector->boundsMax.z = maxZ;
+
+		// TFE: Keep the sector grid in sync when INF moves or rotates walls.
+		sectorGrid_updateSector(sector);
 	}
 
 	fixed16_16 sector_getMaxObjectHeight(RSector* sector)
 	{
 		s32 maxObjHeight = 0;
-		SecObject** objectList = sector->objectList;
-		for (s32 count = sector->objectCount; count > 0; objectList++)
+		SecObject** objectList = sector->objectDense;
+		for (s32 i = 0; i < sector->objectCount; i++)
 		{
-			SecObject* obj = *objectList;
-			if (obj)
-			{
-				maxObjHeight = max(maxObjHeight, obj->worldHeight + ONE_16);
-				count--;
-			}
+			maxObjHeight = max(maxObjHeight, objectList[i]->worldHeight + ONE_16);
 		}
 		return maxObjHeight;
 	}
 			
 	JBool sector_moveWalls(RSector* sector, fixed16_16 delta, fixed16_16 dirX, fixed16_16 dirZ, u32 flags)
 	{
+		// TFE: Visibility through this sector can no longer be precomputed.
+		sectorPvs_markDynamic(sector);
+
 		fixed16_16 offsetX = mul16(delta, dirX);
 		fixed16_16 offsetZ = mul16(delta, dirZ);
 
@@ -389,12 +394,14 @@ namespace TFE_Jedi
 			SecObject** list;
 			if (!objectCapacity)
 			{
-				list = (SecObject**)level_alloc(sizeof(SecObject*) * 5);
+				list = (SecObject**)level_allocTagged(sizeof(SecObject*) * 5, REGION_TAG_LEVEL);
 				sector->objectList = list;
+				sector->objectDense = (SecObject**)level_allocTagged(sizeof(SecObject*) * 5, REGION_TAG_LEVEL);
 			}
 			else
 			{
-				sector->objectList = (SecObject**)level_realloc(sector->objectList, sizeof(SecObject*) * (objectCapacity + 5));
+				sector->objectList = (SecObject**)level_reallocTagged(sector->objectList, sizeof(SecObject*) * (objectCapacity + 5), REGION_TAG_LEVEL);
+				sector->objectDense = (SecObject**)level_reallocTagged(sector->objectDense, sizeof(SecObject*) * (objectCapacity + 5), REGION_TAG_LEVEL);
 				list = sector->objectList + objectCapacity;
 			}
 			memset(list, 0, sizeof(SecObject*) * 5);
@@ -414,6 +421,12 @@ namespace TFE_Jedi
 				*list = obj;
 				obj->index = i;
 				obj->sector = sector;
+
+				// TFE: Every slot before the first free slot is in use, so the object goes at the same index in the dense list.
+				SecObject** dense = sector->objectDense;
+				memmove(dense + i + 1, dense + i, sizeof(SecObject*) * (sector->objectCount - i));
+				dense[i] = obj;
+
 				sector->objectCount++;
 				break;
 			}
@@ -480,6 +493,18 @@ namespace TFE_Jedi
 		// Remove the object from the object list.
 		SecObject** objList = sector->objectList;
 		objList[obj->index] = nullptr;
+
+		// TFE: The dense list is in slot order, so search for the object by its slot index.
+		SecObject** dense = sector->objectDense;
+		s32 lo = 0, hi = sector->objectCount - 1;
+		while (lo < hi)
+		{
+			const s32 mid = (lo + hi) >> 1;
+			if (dense[mid]->index < obj->index) { lo = mid + 1; }
+			else { hi = mid; }
+		}
+		assert(dense[lo] == obj);
+		memmove(dense + lo, dense + lo + 1, sizeof(SecObject*) * (sector->objectCount - lo - 1));
 		sector->objectCount--;
 
 		if (!((obj->entityFlags & ETFLAG_PLAYER) && s_playerDying))
@@ -503,43 +528,63 @@ namespace TFE_Jedi
 		}
 	}
 	
+	// Pick the containing sector with the smallest area.
+	// Ties go to the lowest sector, which matches scanning every sector in order.
+	void sector_pickSmallestContaining(RSector* sector, fixed16_16 ix, fixed16_16 iz, RSector** foundSector, s32* prevSectorUnitArea)
+	{
+		const fixed16_16 sectorMaxX = sector->boundsMax.x;
+		const fixed16_16 sectorMinX = sector->boundsMin.x;
+		const fixed16_16 sectorMaxZ = sector->boundsMax.z;
+		const fixed16_16 sectorMinZ = sector->boundsMin.z;
+
+		if (ix >= sectorMinX && ix <= sectorMaxX && iz >= sectorMinZ && iz <= sectorMaxZ)
+		{
+			const s32 dxInt = floor16(sectorMaxX - sectorMinX) + 1;
+			const s32 dzInt = floor16(sectorMaxZ - sectorMinZ) + 1;
+			const s32 sectorUnitArea = dzInt * dxInt;
+
+			if ((sectorUnitArea < *prevSectorUnitArea || (sectorUnitArea == *prevSectorUnitArea && sector < *foundSector)) &&
+				sector_pointInsideDF(sector, ix, iz))
+			{
+				*prevSectorUnitArea = sectorUnitArea;
+				*foundSector = sector;
+			}
+		}
+	}
+
 	RSector* sector_which3D(fixed16_16 dx, fixed16_16 dy, fixed16_16 dz)
 	{
 		fixed16_16 ix = dx;
 		fixed16_16 iz = dz;
 		fixed16_16 y = dy;
 		
-		RSector* sector = s_levelState.sectors;
 		RSector* foundSector = nullptr;
-		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		// TFE: Only check the sectors that overlap the grid cell containing the point.
+		const s32* cell;
+		s32 cellCount;
+		if (sectorGrid_getCell(ix, iz, &cell, &cellCount))
 		{
-			if (y >= sector->ceilingHeight && y <= sector->floorHeight)
+			for (s32 i = 0; i < cellCount; i++)
 			{
-				const fixed16_16 sectorMaxX = sector->boundsMax.x;
-				const fixed16_16 sectorMinX = sector->boundsMin.x;
-				const fixed16_16 sectorMaxZ = sector->boundsMax.z;
-				const fixed16_16 sectorMinZ = sector->boundsMin.z;
-
-				const s32 dxInt = floor16(sectorMaxX - sectorMinX) + 1;
-				const s32 dzInt = floor16(sectorMaxZ - sectorMinZ) + 1;
-				sectorUnitArea = dzInt * dxInt;
-				
-				s32 insideBounds = 0;
-				if (ix >= sectorMinX && ix <= sectorMaxX && iz >= sectorMinZ && iz <= sectorMaxZ)
+				RSector* sector = &s_levelState.sectors[cell[i]];
+				if (y >= sector->ceilingHeight && y <= sector->floorHeight)
 				{
-					// pick the containing sector with the smallest area.
-					if (sectorUnitArea < prevSectorUnitArea && sector_pointInsideDF(sector, ix, iz))
-					{
-						prevSectorUnitArea = sectorUnitArea;
-						foundSector = sector;
-					}
+					sector_pickSmallestContaining(sector, ix, iz, &foundSector, &prevSectorUnitArea);
 				}
 			}
+			return foundSector;
 		}
 
+		RSector* sector = s_levelState.sectors;
+		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		{
+			if (y >= sector->ceilingHeight && y <= sector->floorHeight)
+			{
+				sector_pickSmallestContaining(sector, ix, iz, &foundSector, &prevSectorUnitArea);
+			}
+		}
 		return foundSector;
 	}
 
@@ -548,37 +593,33 @@ namespace TFE_Jedi
 		fixed16_16 ix = dx;
 		fixed16_16 iz = dz;
 
-		RSector* sector = s_levelState.sectors;
 		RSector* foundSector = nullptr;
-		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		// TFE: Only check the sectors that overlap the grid cell containing the point.
+		const s32* cell;
+		s32 cellCount;
+		if (sectorGrid_getCell(ix, iz, &cell, &cellCount))
 		{
-			if (sector->layer == layer)
+			for (s32 i = 0; i < cellCount; i++)
 			{
-				const fixed16_16 sectorMaxX = sector->boundsMax.x;
-				const fixed16_16 sectorMinX = sector->boundsMin.x;
-				const fixed16_16 sectorMaxZ = sector->boundsMax.z;
-				const fixed16_16 sectorMinZ = sector->boundsMin.z;
-
-				const s32 dxInt = floor16(sectorMaxX - sectorMinX) + 1;
-				const s32 dzInt = floor16(sectorMaxZ - sectorMinZ) + 1;
-				sectorUnitArea = dzInt * dxInt;
-
-				s32 insideBounds = 0;
-				if (ix >= sectorMinX && ix <= sectorMaxX && iz >= sectorMinZ && iz <= sectorMaxZ)
+				RSector* sector = &s_levelState.sectors[cell[i]];
+				if (sector->layer == layer)
 				{
-					// pick the containing sector with the smallest area.
-					if (sectorUnitArea < prevSectorUnitArea && sector_pointInsideDF(sector, ix, iz))
-					{
-						prevSectorUnitArea = sectorUnitArea;
-						foundSector = sector;
-					}
+					sector_pickSmallestContaining(sector, ix, iz, &foundSector, &prevSectorUnitArea);
 				}
 			}
+			return foundSector;
 		}
 
+		RSector* sector = s_levelState.sectors;
+		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		{
+			if (sector->layer == layer)
+			{
+				sector_pickSmallestContaining(sector, ix, iz, &foundSector, &prevSectorUnitArea);
+			}
+		}
 		return foundSector;
 	}
 
@@ -665,6 +706,20 @@ namespace TFE_Jedi
 		return (xDz > zDx) ? PS_INSIDE : PS_OUTSIDE;
 	}
 
+	// Returns the dz of the closest wall before wall w with a non-zero dz, wrapping around to the last wall.
+	// This matches the running dzLast value of the original crossing loop.
+	fixed16_16 sector_getPrevWallDz(RSector* sector, s32 w)
+	{
+		for (s32 i = w - 1; i >= 0; i--)
+		{
+			const RWall* wall = &sector->walls[i];
+			const fixed16_16 dz = wall->w1->z - wall->w0->z;
+			if (dz != 0) { return dz; }
+		}
+		const RWall* last = &sector->walls[sector->wallCount - 1];
+		return last->w1->z - last->w0->z;
+	}
+
 	// The original DF algorithm.
 	JBool sector_pointInsideDF(RSector* sector, fixed16_16 x, fixed16_16 z)
 	{
@@ -672,19 +727,18 @@ namespace TFE_Jedi
 		const fixed16_16 zFrac = fract16(z);
 		const s32 xInt = floor16(x);
 		const s32 zInt = floor16(z);
-		const s32 wallCount = sector->wallCount;
-
-		RWall* wall = sector->walls;
-		RWall* last = &sector->walls[wallCount - 1];
-		vec2_fixed* w1 = last->w1;
-		vec2_fixed* w0 = last->w0;
-		fixed16_16 dzLast = w1->z - w0->z;
 		s32 crossings = 0;
 
-		for (s32 w = 0; w < wallCount; w++, wall++)
+		// TFE: A wall whose Z range does not contain z can neither be crossed nor contain the point,
+		// so only the remaining walls are tested (in the original order).
+		s32 candidateCount;
+		const s32* candidates = wallRanges_getWallsAtZ(sector, z, &candidateCount);
+		for (s32 c = 0; c < candidateCount; c++)
 		{
-			w0 = wall->w0;
-			w1 = wall->w1;
+			const s32 w = candidates[c];
+			RWall* wall = &sector->walls[w];
+			vec2_fixed* w0 = wall->w0;
+			vec2_fixed* w1 = wall->w1;
 
 			fixed16_16 x0 = w0->x;
 			fixed16_16 x1 = w1->x;
@@ -714,19 +768,18 @@ namespace TFE_Jedi
 							return JTRUE;
 						}
 					}
-					dzLast = dz;
 				}
 				else if (x != x0)
 				{
 					if (x < x0)
 					{
+						const fixed16_16 dzLast = sector_getPrevWallDz(sector, w);
 						fixed16_16 dzSignMatches = dz ^ dzLast;	// dzSignMatches >= 0 if dz and dz0 have the same sign.
 						if (dzSignMatches >= 0 || dzLast == 0)  // the signs match OR dz or dz0 are positive OR dz0 EQUALS 0.
 						{
 							crossings++;
 						}
 					}
-					dzLast = dz;
 				}
 			}
 			else if (lineSegmentSide(x, z, x0, z0, x1, z1) == PS_ON_LINE)
@@ -919,6 +972,7 @@ namespace TFE_Jedi
 		wall->angle = vec2ToAngle(dx, dz);
 
 		RSector* sector = wall->sector;
+		wallRanges_invalidate(sector);
 		if (sector->flags1 & SEC_FLAGS1_PLAYER)
 		{
 			s_playerSecMoved = JTRUE;
@@ -950,6 +1004,9 @@ namespace TFE_Jedi
 
 	void sector_rotateWalls(RSector* sector, fixed16_16 centerX, fixed16_16 centerZ, angle14_32 angle, u32 rotateFlags)
 	{
+		// TFE: Visibility through this sector can no longer be precomputed.
+		sectorPvs_markDynamic(sector);
+
 		s32 cosAngle, sinAngle;
 		sinCosFixed(angle, &sinAngle, &cosAngle);
 
@@ -1091,6 +1148,7 @@ namespace TFE_Jedi
 
 		// Set the appropriate game value if the player is inside the sector.
 		RSector* sector = wall->sector;
+		wallRanges_invalidate(sector);
 		if (sector->flags1 & SEC_FLAGS1_PLAYER)
 		{
 			s_playerSecMoved = JTRUE;
@@ -112,6 +112,9 @@ struct RSector
 	s32 objectCount;
 	SecObject** objectList;
 	s32 objectCapacity;
+	// TFE: The same objects without the empty slots: [0, objectCount) in objectList slot order.
+	// Only iterate over this when objects cannot be added to or removed from the sector inside of the loop.
+	SecObject** objectDense;
 
 	// Collision tracking.
 	s32 collisionFrame;
@@ -80,7 +80,7 @@ namespace TFE_Jedi
 	void bitmap_setupAnimationTask()
 	{
 		s_texState.textureAnimTask = createSubTask("texture animation", textureAnimationTaskFunc);
-		s_texState.textureAnimAlloc = allocator_create(sizeof(AnimatedTexture));
+		s_texState.textureAnimAlloc = allocator_createTagged(REGION_TAG_LEVEL, sizeof(AnimatedTexture));
 		s_texState.animTexIndex = 0;
 	}
 
@@ -229,7 +229,7 @@ namespace TFE_Jedi
 		file.readBuffer(s_buffer.data(), (u32)size);
 		file.close();
 
-		TextureData* texture = (TextureData*)region_alloc(s_texState.memoryRegion, sizeof(TextureData));
+		TextureData* texture = (TextureData*)region_allocTagged(s_texState.memoryRegion, sizeof(TextureData), REGION_TAG_LEVEL);
 		const u8* data = s_buffer.data();
 		const u8* fheader = data;
 		data += 3;
@@ -270,7 +270,7 @@ namespace TFE_Jedi
 			if (decompress & 1)
 			{
 				texture->dataSize = texture->width * texture->height;
-				texture->image = (u8*)region_alloc(s_texState.memoryRegion, texture->dataSize);
+				texture->image = (u8*)region_allocTagged(s_texState.memoryRegion, texture->dataSize, REGION_TAG_LEVEL);
 
 				const u8* inBuffer = data;
 				data += inSize;
@@ -302,11 +302,11 @@ namespace TFE_Jedi
 			else
 			{
 				texture->dataSize = inSize;
-				texture->image = (u8*)region_alloc(s_texState.memoryRegion, texture->dataSize);
+				texture->image = (u8*)region_allocTagged(s_texState.memoryRegion, texture->dataSize, REGION_TAG_LEVEL);
 				memcpy(texture->image, data, texture->dataSize);
 				data += texture->dataSize;
 
-				texture->columns = (u32*)region_alloc(s_texState.memoryRegion, texture->width * sizeof(u32));
+				texture->columns = (u32*)region_allocTagged(s_texState.memoryRegion, texture->width * sizeof(u32), REGION_TAG_LEVEL);
 				memcpy(texture->columns, data, texture->width * sizeof(u32));
 				data += texture->width * sizeof(u32);
 			}
@@ -322,7 +322,7 @@ namespace TFE_Jedi
 			data += 12;
 
 			// Allocate and read the BM image.
-			texture->image = (u8*)region_alloc(s_texState.memoryRegion, texture->dataSize);
+			texture->image = (u8*)region_allocTagged(s_texState.memoryRegion, texture->dataSize, REGION_TAG_LEVEL);
 			memcpy(texture->image, data, texture->dataSize);
 			data += texture->dataSize;
 		}
@@ -483,9 +483,9 @@ namespace TFE_Jedi
 		anim->texPtr = texture;			// pointer to the texture pointer, allowing us to update that pointer later.
 		anim->baseFrame = tex;
 		anim->baseData = tex->image;
-		anim->frameList = (TextureData**)level_alloc(sizeof(TextureData**) * anim->count);
+		anim->frameList = (TextureData**)level_allocTagged(sizeof(TextureData**) * anim->count, REGION_TAG_LEVEL);
 		// Allocate frame memory here since load-in-place does not work because structure size changes.
-		TextureData* outFrames = (TextureData*)level_alloc(sizeof(TextureData) * anim->count);
+		TextureData* outFrames = (TextureData*)level_allocTagged(sizeof(TextureData) * anim->count, REGION_TAG_LEVEL);
 		assert(anim->frameList);
 
 		const u8* base = tex->image + 2;
@@ -501,7 +501,7 @@ namespace TFE_Jedi
 			}
 
 			// Allocate an image buffer since everything no longer fits nicely.
-			outFrames[i].image = (u8*)level_alloc(outFrames[i].width * outFrames[i].height);
+			outFrames[i].image = (u8*)level_allocTagged(outFrames[i].width * outFrames[i].height, REGION_TAG_LEVEL);
 			memcpy(outFrames[i].image, (u8*)frame + 0x1c, outFrames[i].width * outFrames[i].height);
 
 			// We have to make sure the structure offsets line up with DOS...
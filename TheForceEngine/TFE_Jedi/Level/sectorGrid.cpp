@@ -0,0 +1,226 @@
+#include <climits>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "sectorGrid.h"
+#include "levelData.h"
+#include <TFE_System/system.h>
+
+namespace TFE_Jedi
+{
+	enum SectorGridConstants
+	{
+		SGRID_MAX_DIM       = 256,	// Maximum number of cells along each axis.
+		SGRID_MIN_CELL_SIZE = 8,	// Minimum cell size in world units.
+	};
+
+	struct SectorGridRect
+	{
+		s32 x0, z0;
+		s32 x1, z1;
+	};
+
+	// Points and sectors outside of the grid are clamped to the edge cells, so the grid never needs to grow.
+	static RSector* s_gridSectors = nullptr;
+	static u32 s_gridSectorCount = 0;
+	static s32 s_gridOriginX = 0;
+	static s32 s_gridOriginZ = 0;
+	static s32 s_gridCellSize = 1;
+	static s32 s_gridDimX = 0;
+	static s32 s_gridDimZ = 0;
+	static std::vector<std::vector<s32>> s_gridCells;
+	static std::vector<SectorGridRect> s_gridSectorRect;	// Cells covered by each sector, indexed by sector.
+	static std::vector<u32> s_gridSectorStamp;				// Last rect query that visited each sector, indexed by sector.
+	static u32 s_gridQueryStamp = 0;
+
+	s32 sectorGrid_cellX(fixed16_16 x)
+	{
+		const s32 offset = floor16(x) - s_gridOriginX;
+		return offset <= 0 ? 0 : min(offset / s_gridCellSize, s_gridDimX - 1);
+	}
+
+	s32 sectorGrid_cellZ(fixed16_16 z)
+	{
+		const s32 offset = floor16(z) - s_gridOriginZ;
+		return offset <= 0 ? 0 : min(offset / s_gridCellSize, s_gridDimZ - 1);
+	}
+
+	SectorGridRect sectorGrid_getRect(RSector* sector)
+	{
+		SectorGridRect rect;
+		rect.x0 = sectorGrid_cellX(sector->boundsMin.x);
+		rect.z0 = sectorGrid_cellZ(sector->boundsMin.z);
+		rect.x1 = sectorGrid_cellX(sector->boundsMax.x);
+		rect.z1 = sectorGrid_cellZ(sector->boundsMax.z);
+		return rect;
+	}
+
+	void sectorGrid_insert(const SectorGridRect& rect, s32 index)
+	{
+		for (s32 z = rect.z0; z <= rect.z1; z++)
+		{
+			std::vector<s32>* cell = &s_gridCells[z * s_gridDimX + rect.x0];
+			for (s32 x = rect.x0; x <= rect.x1; x++, cell++)
+			{
+				// Keep the cells sorted, so sectors are visited in the same order as the full scan.
+				cell->insert(std::lower_bound(cell->begin(), cell->end(), index), index);
+			}
+		}
+	}
+
+	void sectorGrid_remove(const SectorGridRect& rect, s32 index)
+	{
+		for (s32 z = rect.z0; z <= rect.z1; z++)
+		{
+			std::vector<s32>* cell = &s_gridCells[z * s_gridDimX + rect.x0];
+			for (s32 x = rect.x0; x <= rect.x1; x++, cell++)
+			{
+				std::vector<s32>::iterator iSector = std::lower_bound(cell->begin(), cell->end(), index);
+				if (iSector != cell->end() && *iSector == index)
+				{
+					cell->erase(iSector);
+				}
+			}
+		}
+	}
+
+	bool sectorGrid_isValid()
+	{
+		return s_gridSectors && s_gridSectors == s_levelState.sectors && s_gridSectorCount == s_levelState.sectorCount;
+	}
+
+	void sectorGrid_clear()
+	{
+		s_gridSectors = nullptr;
+		s_gridSectorCount = 0;
+		s_gridDimX = 0;
+		s_gridDimZ = 0;
+		s_gridCells.clear();
+		s_gridSectorRect.clear();
+		s_gridSectorStamp.clear();
+		s_gridQueryStamp = 0;
+	}
+
+	void sectorGrid_build()
+	{
+		sectorGrid_clear();
+		const u32 sectorCount = s_levelState.sectorCount;
+		if (!sectorCount) { return; }
+
+		// Compute the level bounds.
+		RSector* sector = s_levelState.sectors;
+		fixed16_16 minX = sector->boundsMin.x, maxX = sector->boundsMax.x;
+		fixed16_16 minZ = sector->boundsMin.z, maxZ = sector->boundsMax.z;
+		sector++;
+		for (u32 i = 1; i < sectorCount; i++, sector++)
+		{
+			minX = min(minX, sector->boundsMin.x);
+			minZ = min(minZ, sector->boundsMin.z);
+			maxX = max(maxX, sector->boundsMax.x);
+			maxZ = max(maxZ, sector->boundsMax.z);
+		}
+
+		// Size the cells so there is roughly one cell per sector.
+		s_gridOriginX = floor16(minX);
+		s_gridOriginZ = floor16(minZ);
+		const s32 width  = floor16(maxX) - s_gridOriginX + 1;
+		const s32 height = floor16(maxZ) - s_gridOriginZ + 1;
+		const f64 cellSize = sqrt(f64(width) * f64(height) / f64(sectorCount));
+		s_gridCellSize = max((s32)SGRID_MIN_CELL_SIZE, s32(cellSize));
+		s_gridCellSize = max(s_gridCellSize, (max(width, height) + SGRID_MAX_DIM - 1) / SGRID_MAX_DIM);
+		s_gridDimX = (width  + s_gridCellSize - 1) / s_gridCellSize;
+		s_gridDimZ = (height + s_gridCellSize - 1) / s_gridCellSize;
+
+		s_gridCells.resize(s_gridDimX * s_gridDimZ);
+		s_gridSectorRect.resize(sectorCount);
+		s_gridSectorStamp.resize(sectorCount, 0);
+		s_gridSectors = s_levelState.sectors;
+		s_gridSectorCount = sectorCount;
+
+		sector = s_levelState.sectors;
+		for (u32 i = 0; i < sectorCount; i++, sector++)
+		{
+			s_gridSectorRect[i] = sectorGrid_getRect(sector);
+			sectorGrid_insert(s_gridSectorRect[i], s32(i));
+		}
+		TFE_System::logWrite(LOG_MSG, "Level", "Sector grid: %d x %d cells of %d units for %u sectors.", s_gridDimX, s_gridDimZ, s_gridCellSize, sectorCount);
+	}
+
+	void sectorGrid_updateSector(RSector* sector)
+	{
+		if (!sectorGrid_isValid() || sector < s_gridSectors || sector >= s_gridSectors + s_gridSectorCount) { return; }
+
+		const s32 index = s32(sector - s_gridSectors);
+		const SectorGridRect rect = sectorGrid_getRect(sector);
+		SectorGridRect* prevRect = &s_gridSectorRect[index];
+		// Most movement stays within the same cells.
+		if (rect.x0 == prevRect->x0 && rect.z0 == prevRect->z0 && rect.x1 == prevRect->x1 && rect.z1 == prevRect->z1)
+		{
+			return;
+		}
+
+		sectorGrid_remove(*prevRect, index);
+		sectorGrid_insert(rect, index);
+		*prevRect = rect;
+	}
+
+	bool sectorGrid_getCell(fixed16_16 x, fixed16_16 z, const s32** indices, s32* count)
+	{
+		if (!sectorGrid_isValid())
+		{
+			return false;
+		}
+
+		const std::vector<s32>& cell = s_gridCells[sectorGrid_cellZ(z) * s_gridDimX + sectorGrid_cellX(x)];
+		*indices = cell.data();
+		*count = (s32)cell.size();
+		return true;
+	}
+
+	bool sectorGrid_getSectorsInRect(fixed16_16 x0, fixed16_16 z0, fixed16_16 x1, fixed16_16 z1, std::vector<s32>& indices)
+	{
+		indices.clear();
+		if (!sectorGrid_isValid())
+		{
+			return false;
+		}
+
+		// Sectors usually cover several cells, so stamp each sector to only add it once.
+		s_gridQueryStamp++;
+		if (!s_gridQueryStamp)
+		{
+			std::fill(s_gridSectorStamp.begin(), s_gridSectorStamp.end(), 0u);
+			s_gridQueryStamp = 1;
+		}
+
+		const s32 cx0 = sectorGrid_cellX(x0), cx1 = sectorGrid_cellX(x1);
+		const s32 cz0 = sectorGrid_cellZ(z0), cz1 = sectorGrid_cellZ(z1);
+		for (s32 z = cz0; z <= cz1; z++)
+		{
+			const std::vector<s32>* cell = &s_gridCells[z * s_gridDimX + cx0];
+			for (s32 x = cx0; x <= cx1; x++, cell++)
+			{
+				const s32 count = (s32)cell->size();
+				const s32* cellIndices = cell->data();
+				for (s32 i = 0; i < count; i++)
+				{
+					const s32 index = cellIndices[i];
+					if (s_gridSectorStamp[index] == s_gridQueryStamp) { continue; }
+					s_gridSectorStamp[index] = s_gridQueryStamp;
+
+					// Skip sectors that only share a cell with the rect.
+					const RSector* sector = &s_gridSectors[index];
+					if (x0 > sector->boundsMax.x || x1 < sector->boundsMin.x || z0 > sector->boundsMax.z || z1 < sector->boundsMin.z)
+					{
+						continue;
+					}
+					indices.push_back(index);
+				}
+			}
+		}
+		std::sort(indices.begin(), indices.end());
+		return true;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Sector Grid
+// TFE: Uniform 2D grid over the sector XZ bounds, used to limit point
+// queries such as sector_which3D() to the sectors that overlap the
+// cell containing the point rather than every sector in the level.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <vector>
+#include <TFE_Jedi/Math/fixedPoint.h>
+#include "rsector.h"
+
+namespace TFE_Jedi
+{
+	// Build the grid from the current level sectors, called once the sector bounds are computed.
+	void sectorGrid_build();
+	void sectorGrid_clear();
+	// Move a sector to the cells covered by its current bounds, called when INF changes the sector bounds.
+	void sectorGrid_updateSector(RSector* sector);
+
+	// Get the indices of the sectors whose bounds overlap the cell containing (x, z), in ascending order.
+	// Returns false if the grid has not been built for the current level, in which case all sectors need to be checked.
+	bool sectorGrid_getCell(fixed16_16 x, fixed16_16 z, const s32** indices, s32* count);
+	// Get the indices of the sectors whose bounds overlap the XZ rect [x0, x1] x [z0, z1], in ascending order.
+	// Returns false if the grid has not been built for the current level, in which case all sectors need to be checked.
+	bool sectorGrid_getSectorsInRect(fixed16_16 x0, fixed16_16 z0, fixed16_16 x1, fixed16_16 z1, std::vector<s32>& indices);
+}
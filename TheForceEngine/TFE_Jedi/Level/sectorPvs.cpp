@@ -0,0 +1,376 @@
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "sectorPvs.h"
+#include "rwall.h"
+#include "levelData.h"
+#include <TFE_System/system.h>
+
+namespace TFE_Jedi
+{
+	enum SectorPvsConstants
+	{
+		PVS_MAX_DEPTH = 64,		// Maximum number of adjoins in a single path.
+		PVS_MAX_STEPS = 16384,	// Maximum number of adjoins visited while computing a row.
+	};
+	// Slack in world units, so that rounding in the fixed point wall tests cannot see past the clipped adjoins.
+	static const f64 c_pvsEpsilon = 0.25;
+
+	struct PvsSegment
+	{
+		f64 x0, z0;
+		f64 x1, z1;
+	};
+
+	// Normalized line: distance = a*x + b*z + c
+	struct PvsLine
+	{
+		f64 a, b, c;
+	};
+
+	// Each row is a bit per sector, computed the first time a path starts in that sector.
+	static RSector* s_pvsSectors = nullptr;
+	static u32 s_pvsSectorCount = 0;
+	static u32 s_pvsRowWords = 0;
+	static std::vector<u32> s_pvsBits;
+	static std::vector<u8> s_pvsRowComputed;
+	static std::vector<u8> s_pvsDynamic;
+
+	// Row computation state.
+	static u32* s_pvsRow = nullptr;
+	static s32 s_pvsSteps = 0;
+	static JBool s_pvsGiveUp = JFALSE;
+	static RWall* s_pvsPath[PVS_MAX_DEPTH];
+	static std::vector<RSector*> s_pvsQueue;
+	static std::vector<u8> s_pvsFlooded;
+
+	void sectorPvs_clear()
+	{
+		s_pvsSectors = nullptr;
+		s_pvsSectorCount = 0;
+		s_pvsRowWords = 0;
+		s_pvsBits.clear();
+		s_pvsRowComputed.clear();
+		s_pvsDynamic.clear();
+		s_pvsFlooded.clear();
+	}
+
+	void pvs_setup()
+	{
+		if (s_pvsSectors == s_levelState.sectors && s_pvsSectorCount == s_levelState.sectorCount) { return; }
+
+		s_pvsSectors = s_levelState.sectors;
+		s_pvsSectorCount = s_levelState.sectorCount;
+		s_pvsRowWords = (s_pvsSectorCount + 31) >> 5;
+		s_pvsBits.assign(size_t(s_pvsSectorCount) * size_t(s_pvsRowWords), 0u);
+		s_pvsRowComputed.assign(s_pvsSectorCount, 0);
+		s_pvsDynamic.assign(s_pvsSectorCount, 0);
+	}
+
+	s32 pvs_getIndex(RSector* sector)
+	{
+		if (sector < s_pvsSectors || sector >= s_pvsSectors + s_pvsSectorCount) { return -1; }
+		return s32(sector - s_pvsSectors);
+	}
+
+	PvsSegment pvs_getWallSegment(RWall* wall)
+	{
+		const f64 scale = 1.0 / 65536.0;
+		PvsSegment seg = { f64(wall->w0->x) * scale, f64(wall->w0->z) * scale, f64(wall->w1->x) * scale, f64(wall->w1->z) * scale };
+		return seg;
+	}
+
+	bool pvs_makeLine(f64 x0, f64 z0, f64 x1, f64 z1, PvsLine* line)
+	{
+		const f64 dx = x1 - x0;
+		const f64 dz = z1 - z0;
+		const f64 len = sqrt(dx*dx + dz*dz);
+		if (len <= c_pvsEpsilon) { return false; }
+
+		line->a = -dz / len;
+		line->b =  dx / len;
+		line->c = -(line->a*x0 + line->b*z0);
+		return true;
+	}
+
+	f64 pvs_distance(const PvsLine& line, f64 x, f64 z)
+	{
+		return line.a*x + line.b*z + line.c;
+	}
+
+	// Clip the parametric range [t0, t1] of the segment to the side of the line given by 'side' (+1 or -1).
+	bool pvs_clipToHalfPlane(const PvsSegment& seg, const PvsLine& line, f64 side, f64* t0, f64* t1)
+	{
+		const f64 d0 = side * pvs_distance(line, seg.x0, seg.z0) + c_pvsEpsilon;
+		const f64 d1 = side * pvs_distance(line, seg.x1, seg.z1) + c_pvsEpsilon;
+		if (d0 < 0.0 && d1 < 0.0) { return false; }
+
+		if (d0 < 0.0)
+		{
+			*t0 = std::max(*t0, d0 / (d0 - d1));
+		}
+		else if (d1 < 0.0)
+		{
+			*t1 = std::min(*t1, d0 / (d0 - d1));
+		}
+		return *t0 <= *t1;
+	}
+
+	// Clip 'target' to the part that lies on some line passing through both 'a' and 'b', in any order.
+	// Returns false if no such line exists. Cases that are too close to degenerate are left unclipped.
+	bool pvs_clipToStabbingLines(const PvsSegment& a, const PvsSegment& b, PvsSegment* target)
+	{
+		PvsLine lineA, lineB;
+		if (!pvs_makeLine(a.x0, a.z0, a.x1, a.z1, &lineA) || !pvs_makeLine(b.x0, b.z0, b.x1, b.z1, &lineB))
+		{
+			return true;
+		}
+
+		// If the segments touch or either one crosses the line of the other, the lines through both cover too much to clip.
+		const f64 a0 = pvs_distance(lineB, a.x0, a.z0), a1 = pvs_distance(lineB, a.x1, a.z1);
+		const f64 b0 = pvs_distance(lineA, b.x0, b.z0), b1 = pvs_distance(lineA, b.x1, b.z1);
+		if (fabs(a0) <= c_pvsEpsilon || fabs(a1) <= c_pvsEpsilon || fabs(b0) <= c_pvsEpsilon || fabs(b1) <= c_pvsEpsilon ||
+			(a0 < 0.0) != (a1 < 0.0) || (b0 < 0.0) != (b1 < 0.0))
+		{
+			return true;
+		}
+
+		// Lines through one endpoint of each segment: two separate the segments, the other two bound their convex hull.
+		const f64 ax[] = { a.x0, a.x1 }, az[] = { a.z0, a.z1 };
+		const f64 bx[] = { b.x0, b.x1 }, bz[] = { b.z0, b.z1 };
+		PvsLine separating[2], outer[2];
+		f64 sepSideA[2], sepSideB[2], outerSide[2];
+		s32 sepCount = 0, outerCount = 0;
+		for (s32 i = 0; i < 2; i++)
+		{
+			for (s32 j = 0; j < 2; j++)
+			{
+				PvsLine line;
+				if (!pvs_makeLine(ax[i], az[i], bx[j], bz[j], &line)) { return true; }
+
+				const f64 sideA = pvs_distance(line, ax[1 - i], az[1 - i]);
+				const f64 sideB = pvs_distance(line, bx[1 - j], bz[1 - j]);
+				if (fabs(sideA) <= c_pvsEpsilon || fabs(sideB) <= c_pvsEpsilon) { return true; }
+
+				if ((sideA < 0.0) != (sideB < 0.0))
+				{
+					if (sepCount >= 2) { return true; }
+					separating[sepCount] = line;
+					sepSideA[sepCount] = sideA < 0.0 ? -1.0 : 1.0;
+					sepSideB[sepCount] = sideB < 0.0 ? -1.0 : 1.0;
+					sepCount++;
+				}
+				else
+				{
+					if (outerCount >= 2) { return true; }
+					outer[outerCount] = line;
+					outerSide[outerCount] = sideA < 0.0 ? -1.0 : 1.0;
+					outerCount++;
+				}
+			}
+		}
+		if (sepCount != 2 || outerCount != 2) { return true; }
+
+		const f64 sideOfA = a0 < 0.0 ? -1.0 : 1.0;	// The side of line B that segment A is on.
+		const f64 sideOfB = b0 < 0.0 ? -1.0 : 1.0;	// The side of line A that segment B is on.
+		f64 tMin = 2.0, tMax = -1.0;
+
+		// Between the segments.
+		f64 t0 = 0.0, t1 = 1.0;
+		if (pvs_clipToHalfPlane(*target, lineB, sideOfA, &t0, &t1) && pvs_clipToHalfPlane(*target, lineA, sideOfB, &t0, &t1) &&
+			pvs_clipToHalfPlane(*target, outer[0], outerSide[0], &t0, &t1) && pvs_clipToHalfPlane(*target, outer[1], outerSide[1], &t0, &t1))
+		{
+			tMin = std::min(tMin, t0);
+			tMax = std::max(tMax, t1);
+		}
+		// Past segment B.
+		t0 = 0.0, t1 = 1.0;
+		if (pvs_clipToHalfPlane(*target, lineB, -sideOfA, &t0, &t1) &&
+			pvs_clipToHalfPlane(*target, separating[0], sepSideB[0], &t0, &t1) && pvs_clipToHalfPlane(*target, separating[1], sepSideB[1], &t0, &t1))
+		{
+			tMin = std::min(tMin, t0);
+			tMax = std::max(tMax, t1);
+		}
+		// Past segment A.
+		t0 = 0.0, t1 = 1.0;
+		if (pvs_clipToHalfPlane(*target, lineA, -sideOfB, &t0, &t1) &&
+			pvs_clipToHalfPlane(*target, separating[0], sepSideA[0], &t0, &t1) && pvs_clipToHalfPlane(*target, separating[1], sepSideA[1], &t0, &t1))
+		{
+			tMin = std::min(tMin, t0);
+			tMax = std::max(tMax, t1);
+		}
+		if (tMin > tMax) { return false; }
+
+		const f64 dx = target->x1 - target->x0;
+		const f64 dz = target->z1 - target->z0;
+		const PvsSegment clipped = { target->x0 + tMin*dx, target->z0 + tMin*dz, target->x0 + tMax*dx, target->z0 + tMax*dz };
+		*target = clipped;
+		return true;
+	}
+
+	void pvs_setVisible(RSector* sector)
+	{
+		const s32 index = pvs_getIndex(sector);
+		if (index >= 0)
+		{
+			s_pvsRow[index >> 5] |= 1u << (index & 31);
+		}
+	}
+
+	JBool pvs_isDynamic(RSector* sector)
+	{
+		const s32 index = pvs_getIndex(sector);
+		return (index < 0 || s_pvsDynamic[index]) ? JTRUE : JFALSE;
+	}
+
+	// The wall collision code never crosses the same wall (or its mirror) twice along a path.
+	JBool pvs_isInPath(RWall* wall, s32 depth)
+	{
+		for (s32 i = 0; i < depth; i++)
+		{
+			if (s_pvsPath[i] == wall || s_pvsPath[i]->mirrorWall == wall)
+			{
+				return JTRUE;
+			}
+		}
+		return JFALSE;
+	}
+
+	// Continue every straight path that passes through 'source' (the first adjoin) and 'pass' (the clipped adjoin into 'sector').
+	void pvs_flowThroughSector(const PvsSegment& source, const PvsSegment& pass, RSector* sector, s32 depth)
+	{
+		RWall* wall = sector->walls;
+		for (s32 w = 0; w < sector->wallCount && !s_pvsGiveUp; w++, wall++)
+		{
+			RSector* next = wall->nextSector;
+			if (!next || pvs_isInPath(wall, depth)) { continue; }
+
+			PvsSegment target = pvs_getWallSegment(wall);
+			if (!pvs_clipToStabbingLines(source, pass, &target)) { continue; }
+
+			pvs_setVisible(next);
+			s_pvsSteps++;
+			// Paths through moving walls cannot be clipped against the current geometry.
+			if (pvs_isDynamic(next) || depth >= PVS_MAX_DEPTH || s_pvsSteps >= PVS_MAX_STEPS)
+			{
+				s_pvsGiveUp = JTRUE;
+				return;
+			}
+
+			s_pvsPath[depth] = wall;
+			if (depth == 0)
+			{
+				// Any point in the start sector can pass through its adjoins.
+				pvs_flowThroughSector(target, target, next, depth + 1);
+			}
+			else
+			{
+				pvs_flowThroughSector(source, target, next, depth + 1);
+			}
+		}
+	}
+
+	// Fallback when the paths cannot be followed: everything connected through adjoins is visible.
+	void pvs_floodRow(RSector* start)
+	{
+		// The row already has sectors set by the partial paths, so track the flood separately.
+		s_pvsFlooded.assign(s_pvsSectorCount, 0);
+		s_pvsFlooded[pvs_getIndex(start)] = 1;
+		s_pvsQueue.clear();
+		s_pvsQueue.push_back(start);
+		for (size_t q = 0; q < s_pvsQueue.size(); q++)
+		{
+			RSector* sector = s_pvsQueue[q];
+			pvs_setVisible(sector);
+
+			RWall* wall = sector->walls;
+			for (s32 w = 0; w < sector->wallCount; w++, wall++)
+			{
+				const s32 index = pvs_getIndex(wall->nextSector);
+				if (index < 0 || s_pvsFlooded[index]) { continue; }
+
+				s_pvsFlooded[index] = 1;
+				s_pvsQueue.push_back(wall->nextSector);
+			}
+		}
+	}
+
+	void pvs_computeRow(s32 index)
+	{
+		RSector* sector = &s_pvsSectors[index];
+		s_pvsRow = &s_pvsBits[size_t(index) * size_t(s_pvsRowWords)];
+		memset(s_pvsRow, 0, sizeof(u32) * s_pvsRowWords);
+		s_pvsSteps = 0;
+		s_pvsGiveUp = s_pvsDynamic[index] ? JTRUE : JFALSE;
+
+		pvs_setVisible(sector);
+		if (!s_pvsGiveUp)
+		{
+			const PvsSegment none = { 0 };
+			pvs_flowThroughSector(none, none, sector, 0);
+		}
+		if (s_pvsGiveUp)
+		{
+			pvs_floodRow(sector);
+		}
+		s_pvsRowComputed[index] = 1;
+	}
+
+	void pvs_flagDynamic(RSector* sector, s32 index)
+	{
+		// Moving walls also move the vertices of the mirror walls in the adjoining sectors.
+		s_pvsDynamic[index] = 1;
+		RWall* wall = sector->walls;
+		for (s32 w = 0; w < sector->wallCount; w++, wall++)
+		{
+			const s32 nextIndex = pvs_getIndex(wall->nextSector);
+			if (nextIndex >= 0) { s_pvsDynamic[nextIndex] = 1; }
+		}
+	}
+
+	void sectorPvs_markDynamic(RSector* sector)
+	{
+		if (!s_levelState.sectorCount) { return; }
+		pvs_setup();
+
+		const s32 index = pvs_getIndex(sector);
+		if (index < 0 || s_pvsDynamic[index]) { return; }
+
+		pvs_flagDynamic(sector, index);
+		// Rows computed from the original geometry are no longer valid.
+		std::fill(s_pvsRowComputed.begin(), s_pvsRowComputed.end(), 0);
+	}
+
+	void sectorPvs_adjoinChanged(RSector* sector)
+	{
+		if (!s_levelState.sectorCount) { return; }
+		pvs_setup();
+
+		const s32 index = pvs_getIndex(sector);
+		if (index < 0) { return; }
+
+		pvs_flagDynamic(sector, index);
+		// Rows computed with the previous adjoins may be missing paths through the new ones,
+		// so they are always recomputed, even if the sector was already dynamic.
+		std::fill(s_pvsRowComputed.begin(), s_pvsRowComputed.end(), 0);
+	}
+
+	JBool sectorPvs_canSee(RSector* sector0, RSector* sector1)
+	{
+		if (!sector0 || !sector1 || sector0 == sector1 || !s_levelState.sectorCount) { return JTRUE; }
+		pvs_setup();
+
+		const s32 index0 = pvs_getIndex(sector0);
+		const s32 index1 = pvs_getIndex(sector1);
+		if (index0 < 0 || index1 < 0) { return JTRUE; }
+
+		if (!s_pvsRowComputed[index0])
+		{
+			pvs_computeRow(index0);
+		}
+		const u32* row = &s_pvsBits[size_t(index0) * size_t(s_pvsRowWords)];
+		return (row[index1 >> 5] & (1u << (index1 & 31))) ? JTRUE : JFALSE;
+	}
+}
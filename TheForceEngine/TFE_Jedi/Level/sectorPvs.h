@@ -0,0 +1,26 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Sector Potentially Visible Sets
+// TFE: Conservative 2D sector-to-sector visibility through adjoins,
+// used to reject line of sight tests between sectors that can never
+// see each other before walking the walls between them.
+//
+// Rows are computed the first time a sector is queried. Sectors whose
+// walls move are flagged as dynamic, and any path through them is
+// treated as visible.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "rsector.h"
+
+namespace TFE_Jedi
+{
+	void sectorPvs_clear();
+	// Called when INF moves or rotates the walls of a sector.
+	void sectorPvs_markDynamic(RSector* sector);
+	// Called when INF changes the adjoins of a sector.
+	void sectorPvs_adjoinChanged(RSector* sector);
+
+	// Returns JFALSE if no straight path through adjoins can connect the two sectors.
+	// Returns JTRUE if the sectors may be visible from each other, which still needs a full test.
+	JBool sectorPvs_canSee(RSector* sector0, RSector* sector1);
+}
@@ -0,0 +1,149 @@
+#include <vector>
+
+#include "sectorWallRanges.h"
+#include "rwall.h"
+#include "levelData.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WALL_RANGES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TFE_Jedi
+{
+	struct SectorWallRanges
+	{
+		JBool valid;
+		std::vector<fixed16_16> xMin;
+		std::vector<fixed16_16> xMax;
+		std::vector<fixed16_16> zMin;
+		std::vector<fixed16_16> zMax;
+	};
+
+	static RSector* s_rangeSectors = nullptr;
+	static u32 s_rangeSectorCount = 0;
+	static std::vector<SectorWallRanges> s_wallRanges;
+	static std::vector<s32> s_rangeWallsAtZ;
+	static std::vector<s32> s_rangeWallsInX;
+
+	void wallRanges_clear()
+	{
+		s_rangeSectors = nullptr;
+		s_rangeSectorCount = 0;
+		s_wallRanges.clear();
+	}
+
+	s32 wallRanges_getIndex(RSector* sector)
+	{
+		if (s_rangeSectors != s_levelState.sectors || s_rangeSectorCount != s_levelState.sectorCount)
+		{
+			s_rangeSectors = s_levelState.sectors;
+			s_rangeSectorCount = s_levelState.sectorCount;
+			s_wallRanges.clear();
+			s_wallRanges.resize(s_rangeSectorCount);
+		}
+		if (!s_rangeSectors || sector < s_rangeSectors || sector >= s_rangeSectors + s_rangeSectorCount) { return -1; }
+		return s32(sector - s_rangeSectors);
+	}
+
+	void wallRanges_invalidate(RSector* sector)
+	{
+		const s32 index = wallRanges_getIndex(sector);
+		if (index >= 0)
+		{
+			s_wallRanges[index].valid = JFALSE;
+		}
+	}
+
+	SectorWallRanges* wallRanges_get(RSector* sector)
+	{
+		const s32 index = wallRanges_getIndex(sector);
+		if (index < 0) { return nullptr; }
+
+		SectorWallRanges* ranges = &s_wallRanges[index];
+		if (!ranges->valid)
+		{
+			const s32 wallCount = sector->wallCount;
+			ranges->xMin.resize(wallCount);
+			ranges->xMax.resize(wallCount);
+			ranges->zMin.resize(wallCount);
+			ranges->zMax.resize(wallCount);
+
+			RWall* wall = sector->walls;
+			for (s32 w = 0; w < wallCount; w++, wall++)
+			{
+				const vec2_fixed* w0 = wall->w0;
+				const vec2_fixed* w1 = wall->w1;
+				ranges->xMin[w] = min(w0->x, w1->x);
+				ranges->xMax[w] = max(w0->x, w1->x);
+				ranges->zMin[w] = min(w0->z, w1->z);
+				ranges->zMax[w] = max(w0->z, w1->z);
+			}
+			ranges->valid = JTRUE;
+		}
+		return ranges;
+	}
+
+	// Write the indices of the ranges that overlap [v0, v1], in ascending order.
+	s32 wallRanges_overlap(const fixed16_16* rangeMin, const fixed16_16* rangeMax, s32 count, fixed16_16 v0, fixed16_16 v1, s32* indices)
+	{
+		s32 outCount = 0;
+		s32 i = 0;
+	#ifdef WALL_RANGES_SSE2
+		const __m128i lo = _mm_set1_epi32(v0);
+		const __m128i hi = _mm_set1_epi32(v1);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i wMin = _mm_loadu_si128((const __m128i*)(rangeMin + i));
+			const __m128i wMax = _mm_loadu_si128((const __m128i*)(rangeMax + i));
+			const __m128i outside = _mm_or_si128(_mm_cmplt_epi32(hi, wMin), _mm_cmplt_epi32(wMax, lo));
+			const s32 inside = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xf;
+			if (!inside) { continue; }
+
+			if (inside & 1) { indices[outCount++] = i; }
+			if (inside & 2) { indices[outCount++] = i + 1; }
+			if (inside & 4) { indices[outCount++] = i + 2; }
+			if (inside & 8) { indices[outCount++] = i + 3; }
+		}
+	#endif
+		for (; i < count; i++)
+		{
+			if (v1 < rangeMin[i] || rangeMax[i] < v0) { continue; }
+			indices[outCount++] = i;
+		}
+		return outCount;
+	}
+
+	const s32* wallRanges_getWalls(RSector* sector, std::vector<s32>& walls, JBool useX, fixed16_16 v0, fixed16_16 v1, s32* count)
+	{
+		const s32 wallCount = sector->wallCount;
+		walls.resize(max(wallCount, 1));
+
+		const SectorWallRanges* ranges = wallRanges_get(sector);
+		if (!ranges)
+		{
+			// The sector is not part of the level, so every wall needs to be tested.
+			for (s32 w = 0; w < wallCount; w++)
+			{
+				walls[w] = w;
+			}
+			*count = wallCount;
+			return walls.data();
+		}
+
+		const fixed16_16* rangeMin = useX ? ranges->xMin.data() : ranges->zMin.data();
+		const fixed16_16* rangeMax = useX ? ranges->xMax.data() : ranges->zMax.data();
+		*count = wallRanges_overlap(rangeMin, rangeMax, wallCount, v0, v1, walls.data());
+		return walls.data();
+	}
+
+	const s32* wallRanges_getWallsAtZ(RSector* sector, fixed16_16 z, s32* count)
+	{
+		return wallRanges_getWalls(sector, s_rangeWallsAtZ, JFALSE, z, z, count);
+	}
+
+	const s32* wallRanges_getWallsInX(RSector* sector, fixed16_16 x0, fixed16_16 x1, s32* count)
+	{
+		return wallRanges_getWalls(sector, s_rangeWallsInX, JTRUE, x0, x1, count);
+	}
+}
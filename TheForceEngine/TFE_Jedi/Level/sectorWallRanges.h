@@ -0,0 +1,24 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Sector Wall Ranges
+// TFE: Packed X and Z ranges of each sector's walls, so point and path
+// tests can skip the walls that cannot affect them 4 at a time before
+// running the original per-wall code on the rest.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_Jedi/Math/fixedPoint.h>
+#include "rsector.h"
+
+namespace TFE_Jedi
+{
+	void wallRanges_clear();
+	// Called when a wall vertex of the sector moves, the ranges are rebuilt the next time they are needed.
+	void wallRanges_invalidate(RSector* sector);
+
+	// Get the indices of the walls whose Z range contains z, in ascending order.
+	// The list is valid until the next call.
+	const s32* wallRanges_getWallsAtZ(RSector* sector, fixed16_16 z, s32* count);
+	// Get the indices of the walls whose X range overlaps [x0, x1], in ascending order.
+	// The list is valid until the next call.
+	const s32* wallRanges_getWallsInX(RSector* sector, fixed16_16 x0, fixed16_16 x1, s32* count);
+}
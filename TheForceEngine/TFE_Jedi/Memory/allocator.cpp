@@ -2,12 +2,30 @@
 #include <TFE_System/system.h>
 #include <TFE_Memory/memoryRegion.h>
 #include <TFE_Game/igame.h>
+#include <TFE_Jedi/Math/core_math.h>
 #include <assert.h>
 
+struct AllocSlab;
+
 struct AllocHeader
 {
 	AllocHeader* prev;
 	AllocHeader* next;
+	// TFE: the slab the item was carved from, or null if it was allocated directly from the region.
+	AllocSlab* slab;
+	// TFE: position in the list, only valid while the allocator index table is built.
+	s32 index;
+};
+
+// TFE: items are carved out of contiguous slabs so that walking a list touches
+// neighboring memory instead of allocations scattered across the region.
+struct AllocSlab
+{
+	AllocSlab* prev;
+	AllocSlab* next;
+	AllocHeader* freeList;	// Free items, linked through AllocHeader::next.
+	s32 capacity;
+	s32 liveCount;
 };
 
 struct Allocator
@@ -24,6 +42,14 @@ struct Allocator
 	// TFE
 	AllocHeader* iterSave;
 	AllocHeader* iterPrevSave;
+	AllocSlab* slabs;
+	s32 nextSlabCapacity;
+	const char* tag;	// Region allocation tag, see TFE_REGION_TAGS.
+	// Index table used for random access, built on demand and kept up to date as items are added to the end.
+	// Deleting an item invalidates it (indexCount = -1) until the next random access.
+	AllocHeader** indexTable;
+	s32 indexCount;
+	s32 indexCapacity;
 };
 
 namespace TFE_Jedi
@@ -34,9 +60,30 @@ namespace TFE_Jedi
 	static const size_t c_invalidPtr = (~size_t(0)) - sizeof(AllocHeader) + 1;
 	#define ALLOC_INVALID_PTR ((AllocHeader*)c_invalidPtr)
 	#define MAX_ALLOC_SIZE (8*1024*1024)  // 8MB
+	// Slabs start small, since many lists only hold a few items (such as object logics), and double in size up to SLAB_MAX_BYTES.
+	#define SLAB_MIN_ITEMS 4
+	#define SLAB_MAX_BYTES (16*1024)	// 16KB
+	// Larger items are allocated directly from the region.
+	#define SLAB_MAX_ITEM_SIZE (SLAB_MAX_BYTES / SLAB_MIN_ITEMS)
+	// Items carved from a slab start on this alignment, and the item stride is rounded up to it,
+	// so every header and payload in the slab stays aligned regardless of the requested size.
+	#define ALLOC_ITEM_ALIGN 16
+	static_assert((sizeof(AllocHeader) & (ALLOC_ITEM_ALIGN - 1)) == 0, "AllocHeader must preserve the item alignment.");
+
+	AllocHeader* allocateItem(Allocator* alloc);
+	void freeItem(Allocator* alloc, AllocHeader* header);
+	void freeSlab(Allocator* alloc, AllocSlab* slab);
+	bool buildIndex(Allocator* alloc);
+	void appendToIndex(Allocator* alloc, AllocHeader* header);
+	s32  getHeaderIndex(Allocator* alloc, AllocHeader* header);
 
 	// Create and free an allocator.
 	Allocator* allocator_create(s32 allocSize, MemoryRegion* region)
+	{
+		return allocator_createTagged(nullptr, allocSize, region);
+	}
+
+	Allocator* allocator_createTagged(const char* tag, s32 allocSize, MemoryRegion* region)
 	{
 		if (allocSize > MAX_ALLOC_SIZE || allocSize <= 0)
 		{
@@ -45,7 +92,7 @@ namespace TFE_Jedi
 			return nullptr;
 		}
 		region = region ? region : s_levelRegion;	// If a null region is passed in, assume we want the level region.
-		Allocator* res = (Allocator*)TFE_Memory::region_alloc(region, sizeof(Allocator));
+		Allocator* res = (Allocator*)TFE_Memory::region_allocTagged(region, sizeof(Allocator), tag);
 		if (!res)
 		{
 			TFE_System::logWrite(LOG_ERROR, "Allocator", "Could not allocate Allocator.");
@@ -60,8 +107,16 @@ namespace TFE_Jedi
 		res->tail = ALLOC_INVALID_PTR;
 		res->iterPrev = ALLOC_INVALID_PTR;
 		res->iter = ALLOC_INVALID_PTR;
-		res->size = allocSize + sizeof(AllocHeader);
+		res->size = s32((allocSize + sizeof(AllocHeader) + ALLOC_ITEM_ALIGN - 1) & ~size_t(ALLOC_ITEM_ALIGN - 1));
 		res->refCount = 0;
+		res->iterSave = ALLOC_INVALID_PTR;
+		res->iterPrevSave = ALLOC_INVALID_PTR;
+		res->slabs = nullptr;
+		res->nextSlabCapacity = SLAB_MIN_ITEMS;
+		res->tag = tag;
+		res->indexTable = nullptr;
+		res->indexCount = -1;
+		res->indexCapacity = 0;
 
 		return res;
 	}
@@ -76,6 +131,12 @@ namespace TFE_Jedi
 			allocator_deleteItem(alloc, item);
 			item = allocator_getNext(alloc);
 		}
+		// Empty slabs may have been kept around for reuse.
+		while (alloc->slabs)
+		{
+			freeSlab(alloc, alloc->slabs);
+		}
+		TFE_Memory::region_free(alloc->region, alloc->indexTable);
 
 		alloc->self = (Allocator*)ALLOC_INVALID_PTR;
 		TFE_Memory::region_free(alloc->region, alloc);
@@ -91,7 +152,7 @@ namespace TFE_Jedi
 	{
 		if (!alloc) { return nullptr; }
 
-		AllocHeader* header = (AllocHeader*)TFE_Memory::region_alloc(alloc->region, alloc->size);
+		AllocHeader* header = allocateItem(alloc);
 		if (!header)
 		{
 			TFE_System::logWrite(LOG_ERROR, "Allocator", "allocator_newItem - cannot allocate header of size %d", alloc->size);
@@ -112,6 +173,7 @@ namespace TFE_Jedi
 		{
 			alloc->head = header;
 		}
+		appendToIndex(alloc, header);
 
 		return ((u8*)header + sizeof(AllocHeader));
 	}
@@ -140,124 +202,247 @@ namespace TFE_Jedi
 		{
 			alloc->iterPrev = header->next;
 		}
+		// Removing from the end keeps the index valid, otherwise it is rebuilt on the next random access.
+		if (alloc->indexCount > 0 && alloc->indexTable[alloc->indexCount - 1] == header)
+		{
+			alloc->indexCount--;
+		}
+		else
+		{
+			alloc->indexCount = -1;
+		}
 
-		TFE_Memory::region_free(alloc->region, header);
+		freeItem(alloc, header);
 	}
 
-	// Random access.
-	s32 allocator_getCount(Allocator* alloc)
+	// Slab management.
+	AllocSlab* allocateSlab(Allocator* alloc)
 	{
-		if (!alloc) { return 0; }
+		const s32 capacity = alloc->nextSlabCapacity;
+		// The region only guarantees 8 byte alignment, so leave room to align the first item.
+		AllocSlab* slab = (AllocSlab*)TFE_Memory::region_allocTagged(alloc->region, sizeof(AllocSlab) + ALLOC_ITEM_ALIGN + capacity * alloc->size, alloc->tag);
+		if (!slab) { return nullptr; }
+
+		// Build the free list in address order so new items are handed out front to back.
+		u8* item = (u8*)((size_t((u8*)slab + sizeof(AllocSlab)) + ALLOC_ITEM_ALIGN - 1) & ~size_t(ALLOC_ITEM_ALIGN - 1));
+		AllocHeader* freeList = ALLOC_INVALID_PTR;
+		for (s32 i = capacity - 1; i >= 0; i--)
+		{
+			AllocHeader* header = (AllocHeader*)(item + i * alloc->size);
+			header->next = freeList;
+			header->slab = slab;
+			freeList = header;
+		}
+		slab->freeList = freeList;
+		slab->capacity = capacity;
+		slab->liveCount = 0;
+
+		// Add to the front, since the other slabs are full.
+		slab->prev = nullptr;
+		slab->next = alloc->slabs;
+		if (alloc->slabs) { alloc->slabs->prev = slab; }
+		alloc->slabs = slab;
+
+		const s32 maxCapacity = max(SLAB_MIN_ITEMS, SLAB_MAX_BYTES / alloc->size);
+		alloc->nextSlabCapacity = min(capacity * 2, maxCapacity);
+		return slab;
+	}
 
-		s32 count = 0;
-		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
+	void freeSlab(Allocator* alloc, AllocSlab* slab)
+	{
+		if (slab->prev) { slab->prev->next = slab->next; }
+		else { alloc->slabs = slab->next; }
+		if (slab->next) { slab->next->prev = slab->prev; }
+
+		TFE_Memory::region_free(alloc->region, slab);
+	}
+
+	AllocHeader* allocateItem(Allocator* alloc)
+	{
+		if (alloc->size > SLAB_MAX_ITEM_SIZE)
 		{
-			count++;
-			header = header->next;
+			AllocHeader* header = (AllocHeader*)TFE_Memory::region_allocTagged(alloc->region, alloc->size, alloc->tag);
+			if (header) { header->slab = nullptr; }
+			return header;
 		}
-		return count;
+
+		AllocSlab* slab = alloc->slabs;
+		while (slab && slab->freeList == ALLOC_INVALID_PTR)
+		{
+			slab = slab->next;
+		}
+		if (!slab)
+		{
+			slab = allocateSlab(alloc);
+			if (!slab) { return nullptr; }
+		}
+
+		AllocHeader* header = slab->freeList;
+		slab->freeList = header->next;
+		slab->liveCount++;
+		return header;
 	}
-		
-	s32 allocator_getCurPos(Allocator* alloc)
+
+	void freeItem(Allocator* alloc, AllocHeader* header)
 	{
-		if (!alloc) { return -1; }
+		AllocSlab* slab = header->slab;
+		if (!slab)
+		{
+			TFE_Memory::region_free(alloc->region, header);
+			return;
+		}
 
-		s32 index = 0;
-		AllocHeader* iter = alloc->iter;
-		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
+		assert(slab->liveCount > 0);
+		header->next = slab->freeList;
+		slab->freeList = header;
+		slab->liveCount--;
+
+		// Return empty slabs to the region, but keep the last one so a list that repeatedly adds and removes an item doesn't thrash.
+		if (slab->liveCount == 0 && (slab->prev || slab->next))
 		{
-			if (header == iter)
-			{
-				return index;
-			}
-			index++;
-			header = header->next;
+			freeSlab(alloc, slab);
 		}
-		return -1;
 	}
 
-	void allocator_setPos(Allocator* alloc, s32 pos)
+	// Index table.
+	bool buildIndex(Allocator* alloc)
 	{
+		if (alloc->indexCount >= 0) { return true; }
+
+		s32 count = 0;
+		for (AllocHeader* header = alloc->head; header != ALLOC_INVALID_PTR; header = header->next)
+		{
+			count++;
+		}
+		if (count > alloc->indexCapacity)
+		{
+			const s32 capacity = max(count, 16);
+			AllocHeader** table = (AllocHeader**)TFE_Memory::region_reallocTagged(alloc->region, alloc->indexTable, sizeof(AllocHeader*) * capacity, alloc->tag);
+			if (!table) { return false; }
+			alloc->indexTable = table;
+			alloc->indexCapacity = capacity;
+		}
+
 		s32 index = 0;
-		AllocHeader* header = alloc->head;
-		alloc->iter = ALLOC_INVALID_PTR;
-		while (header != ALLOC_INVALID_PTR)
+		for (AllocHeader* header = alloc->head; header != ALLOC_INVALID_PTR; header = header->next, index++)
+		{
+			header->index = index;
+			alloc->indexTable[index] = header;
+		}
+		alloc->indexCount = count;
+		return true;
+	}
+
+	void appendToIndex(Allocator* alloc, AllocHeader* header)
+	{
+		// Lists that are never accessed by index never build a table.
+		if (alloc->indexCount < 0) { return; }
+
+		if (alloc->indexCount >= alloc->indexCapacity)
 		{
-			if (index == pos)
+			const s32 capacity = max(alloc->indexCapacity * 2, 16);
+			AllocHeader** table = (AllocHeader**)TFE_Memory::region_reallocTagged(alloc->region, alloc->indexTable, sizeof(AllocHeader*) * capacity, alloc->tag);
+			if (!table)
 			{
-				alloc->iter = header;
-				break;
+				alloc->indexCount = -1;
+				return;
 			}
-			index++;
-			header = header->next;
+			alloc->indexTable = table;
+			alloc->indexCapacity = capacity;
 		}
+		header->index = alloc->indexCount;
+		alloc->indexTable[alloc->indexCount++] = header;
 	}
-		
-	s32 allocator_getPrevPos(Allocator* alloc)
+
+	// Returns the index of 'header' or -1 if it is not in the list.
+	s32 getHeaderIndex(Allocator* alloc, AllocHeader* header)
 	{
-		if (!alloc) { return -1; }
+		if (header == ALLOC_INVALID_PTR) { return -1; }
+		if (buildIndex(alloc))
+		{
+			const s32 index = header->index;
+			return (index >= 0 && index < alloc->indexCount && alloc->indexTable[index] == header) ? index : -1;
+		}
 
 		s32 index = 0;
-		AllocHeader* iterPrev = alloc->iterPrev;
-		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
+		for (AllocHeader* iter = alloc->head; iter != ALLOC_INVALID_PTR; iter = iter->next, index++)
 		{
-			if (header == iterPrev)
-			{
-				return index;
-			}
-			index++;
-			header = header->next;
+			if (iter == header) { return index; }
 		}
 		return -1;
 	}
 
-	void allocator_setPrevPos(Allocator* alloc, s32 pos)
+	// Returns the header at 'index' or ALLOC_INVALID_PTR if it is out of range.
+	AllocHeader* getHeaderByIndex(Allocator* alloc, s32 index)
 	{
-		s32 index = 0;
+		if (buildIndex(alloc))
+		{
+			return (index >= 0 && index < alloc->indexCount) ? alloc->indexTable[index] : ALLOC_INVALID_PTR;
+		}
+
 		AllocHeader* header = alloc->head;
-		while (header != ALLOC_INVALID_PTR)
+		while (index > 0 && header != ALLOC_INVALID_PTR)
 		{
-			if (index == pos)
-			{
-				alloc->iterPrev = header;
-				break;
-			}
-			index++;
+			index--;
 			header = header->next;
 		}
+		return header;
 	}
 
-	s32 allocator_getIndex(Allocator* alloc, void* item)
+	// Random access.
+	s32 allocator_getCount(Allocator* alloc)
 	{
-		if (!item) { return -1; }
+		if (!alloc) { return 0; }
+		if (alloc->indexCount >= 0) { return alloc->indexCount; }
 
+		s32 count = 0;
 		AllocHeader* header = alloc->head;
-		s32 index = 0;
 		while (header != ALLOC_INVALID_PTR)
 		{
-			if ((u8*)item == (u8*)header + sizeof(AllocHeader))
-			{
-				return index;
-			}
-			index++;
+			count++;
 			header = header->next;
 		}
-		return -1;
+		return count;
+	}
+		
+	s32 allocator_getCurPos(Allocator* alloc)
+	{
+		if (!alloc) { return -1; }
+		return getHeaderIndex(alloc, alloc->iter);
 	}
 
-	void* allocator_getByIndex(Allocator* alloc, s32 index)
+	void allocator_setPos(Allocator* alloc, s32 pos)
 	{
-		if (!alloc) { return nullptr; }
+		alloc->iter = pos >= 0 ? getHeaderByIndex(alloc, pos) : ALLOC_INVALID_PTR;
+	}
+		
+	s32 allocator_getPrevPos(Allocator* alloc)
+	{
+		if (!alloc) { return -1; }
+		return getHeaderIndex(alloc, alloc->iterPrev);
+	}
 
-		AllocHeader* header = alloc->head;
-		while (index > 0 && header != ALLOC_INVALID_PTR)
+	void allocator_setPrevPos(Allocator* alloc, s32 pos)
+	{
+		AllocHeader* header = pos >= 0 ? getHeaderByIndex(alloc, pos) : ALLOC_INVALID_PTR;
+		if (header != ALLOC_INVALID_PTR)
 		{
-			index--;
-			header = header->next;
+			alloc->iterPrev = header;
 		}
+	}
+
+	s32 allocator_getIndex(Allocator* alloc, void* item)
+	{
+		if (!item) { return -1; }
+		return getHeaderIndex(alloc, (AllocHeader*)((u8*)item - sizeof(AllocHeader)));
+	}
+
+	void* allocator_getByIndex(Allocator* alloc, s32 index)
+	{
+		if (!alloc) { return nullptr; }
+
+		// Negative indices return the head, matching the original list walk.
+		AllocHeader* header = getHeaderByIndex(alloc, max(index, 0));
 
 		alloc->iterPrev = header;
 		alloc->iter = header;
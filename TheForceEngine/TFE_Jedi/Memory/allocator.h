@@ -11,6 +11,8 @@ namespace TFE_Jedi
 {
 	// Create and free an allocator.
 	Allocator* allocator_create(s32 allocSize, MemoryRegion* region = nullptr);
+	// The allocator and its items are tagged with the owning subsystem (REGION_TAG_*), see TFE_REGION_TAGS.
+	Allocator* allocator_createTagged(const char* tag, s32 allocSize, MemoryRegion* region = nullptr);
 	void allocator_free(Allocator* alloc);
 	bool allocator_validate(Allocator* alloc);
 
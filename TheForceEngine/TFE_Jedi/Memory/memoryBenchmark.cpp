@@ -0,0 +1,573 @@
+#include <cstring>
+
+#include "memoryBenchmark.h"
+#include "allocator.h"
+#include <TFE_Memory/chunkedArray.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_FileSystem/fileutil.h>
+#include <TFE_FrontEndUI/console.h>
+#include <TFE_System/system.h>
+#include <algorithm>
+#include <unordered_map>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace TFE_Memory;
+
+namespace TFE_Jedi
+{
+	enum BenchmarkConstants
+	{
+		BENCH_REGION_BLOCK_SIZE = 8 * 1024 * 1024,	// Matches the game and level region base size.
+		BENCH_TELEMETRY_STEP    = 4096,				// Sample region telemetry every N operations.
+		BENCH_TRACE_VERSION     = 1,
+		BENCH_TRACE_WRITE_STEP  = 65536,			// Operations per buffer write/read.
+
+		// Synthetic churn.
+		BENCH_SYNTH_OP_COUNT    = 1000000,
+		BENCH_SYNTH_SLOT_COUNT  = 8192,
+		BENCH_SYNTH_REALLOC_PCT = 10,
+		BENCH_SYNTH_ITEM_SIZE   = 64,				// Allocator item size.
+		BENCH_SYNTH_ELEM_SIZE   = 192,				// ChunkedArray element size, roughly the size of a SecObject.
+		BENCH_SYNTH_ELEM_CHUNK  = 256,
+	};
+
+	struct TraceFileHeader
+	{
+		char magic[4];	// "RTRC"
+		u32  version;
+		u64  opCount;
+	};
+
+	// Trace operations are compiled down to slots, so replay is a direct array lookup rather than a pointer map.
+	struct BenchOp
+	{
+		u32 type;
+		u32 size;
+		s32 slot;
+	};
+
+	struct BenchTrace
+	{
+		std::vector<BenchOp> ops;
+		s32 slotCount;
+	};
+
+	struct BenchmarkBackend
+	{
+		const char* name;
+		bool  (*begin)(BenchmarkBackend* backend);
+		void  (*end)(BenchmarkBackend* backend);
+		void* (*alloc)(BenchmarkBackend* backend, u32 size);
+		void* (*realloc)(BenchmarkBackend* backend, void* ptr, u32 size);
+		void  (*free)(BenchmarkBackend* backend, void* ptr);
+		// Release everything at once, or null to free each live allocation instead.
+		void  (*clear)(BenchmarkBackend* backend);
+
+		RegionAllocStrategy strategy;
+		MemoryRegion* region;	// Backing region, used for telemetry.
+		Allocator* allocator;
+		ChunkedArray* array;
+	};
+
+	//////////////////////////////////////////////////////////////////////
+	// Backends
+	//////////////////////////////////////////////////////////////////////
+	bool createBackendRegion(BenchmarkBackend* backend)
+	{
+		// region_create() uses the default strategy, so switch it temporarily.
+		const RegionAllocStrategy prevStrategy = region_getDefaultStrategy();
+		region_setDefaultStrategy(backend->strategy);
+		backend->region = region_create("Benchmark", BENCH_REGION_BLOCK_SIZE);
+		region_setDefaultStrategy(prevStrategy);
+		return backend->region != nullptr;
+	}
+
+	void destroyBackendRegion(BenchmarkBackend* backend)
+	{
+		if (backend->region) { region_destroy(backend->region); }
+		backend->region = nullptr;
+	}
+
+	bool  malloc_begin(BenchmarkBackend* backend) { return true; }
+	void  malloc_end(BenchmarkBackend* backend) { }
+	void* malloc_alloc(BenchmarkBackend* backend, u32 size) { return malloc(size); }
+	void* malloc_realloc(BenchmarkBackend* backend, void* ptr, u32 size) { return realloc(ptr, size); }
+	void  malloc_free(BenchmarkBackend* backend, void* ptr) { free(ptr); }
+
+	void* region_benchAlloc(BenchmarkBackend* backend, u32 size) { return region_alloc(backend->region, size); }
+	void* region_benchRealloc(BenchmarkBackend* backend, void* ptr, u32 size) { return region_realloc(backend->region, ptr, size); }
+	void  region_benchFree(BenchmarkBackend* backend, void* ptr) { region_free(backend->region, ptr); }
+	void  region_benchClear(BenchmarkBackend* backend) { region_clear(backend->region); }
+
+	bool allocator_benchBegin(BenchmarkBackend* backend)
+	{
+		if (!createBackendRegion(backend)) { return false; }
+		backend->allocator = allocator_create(BENCH_SYNTH_ITEM_SIZE, backend->region);
+		return backend->allocator != nullptr;
+	}
+
+	void allocator_benchEnd(BenchmarkBackend* backend)
+	{
+		allocator_free(backend->allocator);
+		backend->allocator = nullptr;
+		destroyBackendRegion(backend);
+	}
+
+	void* allocator_benchAlloc(BenchmarkBackend* backend, u32 size) { return allocator_newItem(backend->allocator); }
+	void  allocator_benchFree(BenchmarkBackend* backend, void* ptr) { if (ptr) { allocator_deleteItem(backend->allocator, ptr); } }
+
+	bool chunkedArray_benchBegin(BenchmarkBackend* backend)
+	{
+		if (!createBackendRegion(backend)) { return false; }
+		backend->array = createChunkedArray(BENCH_SYNTH_ELEM_SIZE, BENCH_SYNTH_ELEM_CHUNK, 1, backend->region);
+		return backend->array != nullptr;
+	}
+
+	void chunkedArray_benchEnd(BenchmarkBackend* backend)
+	{
+		freeChunkedArray(backend->array);
+		backend->array = nullptr;
+		destroyBackendRegion(backend);
+	}
+
+	void* chunkedArray_benchAlloc(BenchmarkBackend* backend, u32 size) { return allocFromChunkedArray(backend->array); }
+	void  chunkedArray_benchFree(BenchmarkBackend* backend, void* ptr) { freeToChunkedArray(backend->array, ptr); }
+	void  chunkedArray_benchClear(BenchmarkBackend* backend) { chunkedArrayClear(backend->array); }
+
+	BenchmarkBackend getMallocBackend()
+	{
+		BenchmarkBackend backend = { "malloc", malloc_begin, malloc_end, malloc_alloc, malloc_realloc, malloc_free, nullptr };
+		return backend;
+	}
+
+	BenchmarkBackend getRegionBackend(RegionAllocStrategy strategy)
+	{
+		BenchmarkBackend backend = { strategy == REGION_ALLOC_TLSF ? "region (tlsf)" : "region (first-fit)", createBackendRegion, destroyBackendRegion,
+			region_benchAlloc, region_benchRealloc, region_benchFree, region_benchClear };
+		backend.strategy = strategy;
+		return backend;
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// Replay
+	//////////////////////////////////////////////////////////////////////
+	void executeOp(BenchmarkBackend* backend, const BenchOp& op, void** slots, s32 slotCount)
+	{
+		switch (op.type)
+		{
+			case RTRACE_ALLOC:
+				slots[op.slot] = backend->alloc(backend, op.size);
+				break;
+			case RTRACE_REALLOC:
+				slots[op.slot] = backend->realloc(backend, slots[op.slot], op.size);
+				break;
+			case RTRACE_FREE:
+				backend->free(backend, slots[op.slot]);
+				slots[op.slot] = nullptr;
+				break;
+			case RTRACE_CLEAR:
+				if (backend->clear)
+				{
+					backend->clear(backend);
+				}
+				else
+				{
+					for (s32 i = 0; i < slotCount; i++)
+					{
+						if (slots[i]) { backend->free(backend, slots[i]); }
+					}
+				}
+				memset(slots, 0, sizeof(void*) * slotCount);
+				break;
+		}
+	}
+
+	void releaseSlots(BenchmarkBackend* backend, void** slots, s32 slotCount)
+	{
+		// Region based backends release everything when destroyed.
+		if (backend->region) { return; }
+		for (s32 i = 0; i < slotCount; i++)
+		{
+			if (slots[i]) { backend->free(backend, slots[i]); }
+		}
+	}
+
+	bool runBenchmark(BenchmarkBackend* backend, const char* traceName, const BenchTrace& trace, std::vector<MemoryBenchmarkResult>& results)
+	{
+		MemoryBenchmarkResult result = {};
+		snprintf(result.name, sizeof(result.name), "%s: %s", traceName, backend->name);
+		result.opCount = trace.ops.size();
+		result.peakFragmentation = -1.0f;
+		if (trace.ops.empty()) { return false; }
+
+		std::vector<void*> slots(std::max(trace.slotCount, 1), nullptr);
+		const size_t opCount = trace.ops.size();
+		const BenchOp* ops = trace.ops.data();
+
+		// Throughput pass, only the whole run is timed.
+		if (!backend->begin(backend))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryBenchmark", "Failed to initialize benchmark '%s'.", result.name);
+			return false;
+		}
+		u64 start = TFE_System::getCurrentTimeInTicks();
+		for (size_t i = 0; i < opCount; i++)
+		{
+			executeOp(backend, ops[i], slots.data(), trace.slotCount);
+		}
+		const f64 seconds = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		releaseSlots(backend, slots.data(), trace.slotCount);
+		backend->end(backend);
+		result.opsPerSecond = seconds > 0.0 ? f64(opCount) / seconds : 0.0;
+
+		// Latency pass, each operation is timed and the region telemetry is sampled outside of the timed sections.
+		std::fill(slots.begin(), slots.end(), nullptr);
+		std::vector<u64> latency(opCount);
+		backend->begin(backend);
+		for (size_t i = 0; i < opCount; i++)
+		{
+			start = TFE_System::getCurrentTimeInTicks();
+			executeOp(backend, ops[i], slots.data(), trace.slotCount);
+			latency[i] = TFE_System::getCurrentTimeInTicks() - start;
+
+			if (backend->region && (i % BENCH_TELEMETRY_STEP) == 0)
+			{
+				RegionTelemetry telemetry;
+				region_getTelemetry(backend->region, &telemetry);
+				result.peakFragmentation = std::max(result.peakFragmentation, telemetry.fragmentation);
+				result.peakUsed = std::max(result.peakUsed, telemetry.used);
+			}
+		}
+		releaseSlots(backend, slots.data(), trace.slotCount);
+		backend->end(backend);
+
+		const size_t p99 = std::min(opCount - 1, opCount * 99 / 100);
+		std::nth_element(latency.begin(), latency.begin() + p99, latency.end());
+		result.p99Latency = TFE_System::convertFromTicksToSeconds(latency[p99]) * 1000000.0;
+
+		if (backend->region)
+		{
+			TFE_System::logWrite(LOG_MSG, "MemoryBenchmark", "%s - %llu ops, %.0f ops/sec, p99 %.3f us, peak fragmentation %.1f%%, peak used %zu KB",
+				result.name, (unsigned long long)result.opCount, result.opsPerSecond, result.p99Latency, result.peakFragmentation * 100.0f, result.peakUsed >> 10);
+		}
+		else
+		{
+			TFE_System::logWrite(LOG_MSG, "MemoryBenchmark", "%s - %llu ops, %.0f ops/sec, p99 %.3f us", result.name, (unsigned long long)result.opCount, result.opsPerSecond, result.p99Latency);
+		}
+		results.push_back(result);
+		return true;
+	}
+
+	// Convert recorded pointers into slot indices.
+	// Reallocs and frees of pointers allocated before the trace started cannot be replayed exactly:
+	// reallocs become allocations and frees are dropped.
+	void compileTrace(const std::vector<RegionTraceOp>& ops, BenchTrace& trace)
+	{
+		std::unordered_map<u64, s32> liveSlots;
+		trace.ops.clear();
+		trace.ops.reserve(ops.size());
+		trace.slotCount = 0;
+
+		for (size_t i = 0; i < ops.size(); i++)
+		{
+			const RegionTraceOp& op = ops[i];
+			BenchOp benchOp = { op.type, op.size, -1 };
+			if (op.type == RTRACE_ALLOC || op.type == RTRACE_REALLOC)
+			{
+				if (!op.ptr) { continue; }	// The original allocation failed.
+
+				std::unordered_map<u64, s32>::iterator iPrev = op.prevPtr ? liveSlots.find(op.prevPtr) : liveSlots.end();
+				if (iPrev != liveSlots.end())
+				{
+					benchOp.slot = iPrev->second;
+					liveSlots.erase(iPrev);
+				}
+				else
+				{
+					benchOp.type = RTRACE_ALLOC;
+					benchOp.slot = trace.slotCount++;
+				}
+				liveSlots[op.ptr] = benchOp.slot;
+			}
+			else if (op.type == RTRACE_FREE)
+			{
+				std::unordered_map<u64, s32>::iterator iSlot = liveSlots.find(op.ptr);
+				if (iSlot == liveSlots.end()) { continue; }
+				benchOp.slot = iSlot->second;
+				liveSlots.erase(iSlot);
+			}
+			else if (op.type == RTRACE_CLEAR)
+			{
+				liveSlots.clear();
+			}
+			else
+			{
+				continue;
+			}
+			trace.ops.push_back(benchOp);
+		}
+	}
+
+	// Deterministic churn over a fixed set of slots: empty slots are filled, live slots are freed or resized.
+	// Sizes roughly follow the game: mostly small structures, some medium buffers and a few large allocations.
+	void generateSyntheticTrace(BenchTrace& trace, bool variableSize)
+	{
+		u32 seed = 0x1234567u;
+		std::vector<u8> live(BENCH_SYNTH_SLOT_COUNT, 0);
+		trace.ops.resize(BENCH_SYNTH_OP_COUNT);
+		trace.slotCount = BENCH_SYNTH_SLOT_COUNT;
+
+		for (s32 i = 0; i < BENCH_SYNTH_OP_COUNT; i++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const s32 slot = s32((seed >> 8) % BENCH_SYNTH_SLOT_COUNT);
+			seed = seed * 1664525u + 1013904223u;
+			const u32 roll = (seed >> 8) % 100;
+			seed = seed * 1664525u + 1013904223u;
+			const u32 value = seed >> 8;
+
+			u32 size = BENCH_SYNTH_ITEM_SIZE;
+			if (variableSize)
+			{
+				if (roll < 70)      { size = 16 + value % 240; }
+				else if (roll < 95) { size = 256 + value % 3840; }
+				else                { size = 4096 + value % 61440; }
+			}
+
+			BenchOp& op = trace.ops[i];
+			op.slot = slot;
+			op.size = size;
+			if (!live[slot])
+			{
+				op.type = RTRACE_ALLOC;
+				live[slot] = 1;
+			}
+			else if (variableSize && (value % 100) < BENCH_SYNTH_REALLOC_PCT)
+			{
+				op.type = RTRACE_REALLOC;
+			}
+			else
+			{
+				op.type = RTRACE_FREE;
+				op.size = 0;
+				live[slot] = 0;
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// API
+	//////////////////////////////////////////////////////////////////////
+	bool memoryBenchmark_saveTrace(const char* path, const std::vector<RegionTraceOp>& ops)
+	{
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryBenchmark", "Cannot open trace '%s' for writing.", path);
+			return false;
+		}
+
+		const TraceFileHeader header = { { 'R', 'T', 'R', 'C' }, BENCH_TRACE_VERSION, (u64)ops.size() };
+		file.writeBuffer(&header, sizeof(TraceFileHeader));
+		for (size_t i = 0; i < ops.size(); i += BENCH_TRACE_WRITE_STEP)
+		{
+			const size_t count = std::min(ops.size() - i, (size_t)BENCH_TRACE_WRITE_STEP);
+			file.writeBuffer(&ops[i], u32(sizeof(RegionTraceOp) * count));
+		}
+		file.close();
+		return true;
+	}
+
+	bool memoryBenchmark_loadTrace(const char* path, std::vector<RegionTraceOp>& ops)
+	{
+		ops.clear();
+		FileStream file;
+		if (!file.open(path, Stream::MODE_READ))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryBenchmark", "Cannot open trace '%s'.", path);
+			return false;
+		}
+
+		// getSize() seeks back to the start, so it has to be called before reading.
+		const size_t fileSize = file.getSize();
+		TraceFileHeader header;
+		if (file.readBuffer(&header, sizeof(TraceFileHeader)) != sizeof(TraceFileHeader) || memcmp(header.magic, "RTRC", 4) != 0 || header.version != BENCH_TRACE_VERSION
+			|| header.opCount > (fileSize - sizeof(TraceFileHeader)) / sizeof(RegionTraceOp))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryBenchmark", "Invalid trace file '%s'.", path);
+			file.close();
+			return false;
+		}
+
+		ops.resize(header.opCount);
+		for (size_t i = 0; i < ops.size(); i += BENCH_TRACE_WRITE_STEP)
+		{
+			const size_t count = std::min(ops.size() - i, (size_t)BENCH_TRACE_WRITE_STEP);
+			file.readBuffer(&ops[i], u32(sizeof(RegionTraceOp) * count));
+		}
+		file.close();
+		return true;
+	}
+
+	void memoryBenchmark_replayTrace(const char* name, const std::vector<RegionTraceOp>& ops, std::vector<MemoryBenchmarkResult>& results)
+	{
+		BenchTrace trace;
+		compileTrace(ops, trace);
+
+		BenchmarkBackend backends[] =
+		{
+			getMallocBackend(),
+			getRegionBackend(REGION_ALLOC_FIRST_FIT),
+			getRegionBackend(REGION_ALLOC_TLSF),
+		};
+		for (size_t i = 0; i < TFE_ARRAYSIZE(backends); i++)
+		{
+			runBenchmark(&backends[i], name, trace, results);
+		}
+	}
+
+	void memoryBenchmark_runSynthetic(std::vector<MemoryBenchmarkResult>& results)
+	{
+		BenchTrace trace;
+		generateSyntheticTrace(trace, true);
+		BenchmarkBackend backends[] =
+		{
+			getMallocBackend(),
+			getRegionBackend(REGION_ALLOC_FIRST_FIT),
+			getRegionBackend(REGION_ALLOC_TLSF),
+		};
+		for (size_t i = 0; i < TFE_ARRAYSIZE(backends); i++)
+		{
+			runBenchmark(&backends[i], "churn", trace, results);
+		}
+
+		// Fixed size churn for the item pools, each backed by a TLSF region.
+		generateSyntheticTrace(trace, false);
+		BenchmarkBackend allocatorBackend = { "Allocator", allocator_benchBegin, allocator_benchEnd, allocator_benchAlloc, nullptr, allocator_benchFree, nullptr };
+		BenchmarkBackend arrayBackend = { "ChunkedArray", chunkedArray_benchBegin, chunkedArray_benchEnd, chunkedArray_benchAlloc, nullptr, chunkedArray_benchFree, chunkedArray_benchClear };
+		allocatorBackend.strategy = REGION_ALLOC_TLSF;
+		arrayBackend.strategy = REGION_ALLOC_TLSF;
+		runBenchmark(&allocatorBackend, "item churn", trace, results);
+		runBenchmark(&arrayBackend, "item churn", trace, results);
+	}
+
+	//////////////////////////////////////////////////////
+	// Console commands
+	//////////////////////////////////////////////////////
+	// Record allocation traces to replay with 'regionBench'. For a level trace, start recording before loading the level
+	// (such as SECBASE or ARC), play for a while and then stop the trace.
+	void beginRegionTrace(const ConsoleArgList& args)
+	{
+		MemoryRegion* region = region_find(args.size() >= 2 ? args[1].c_str() : "level");
+		if (!region)
+		{
+			TFE_Console::addToHistory("Invalid region, valid values are: game, level.");
+			return;
+		}
+		region_beginTrace(region);
+
+		char res[256];
+		sprintf(res, "Recording allocations in region '%s', use 'regionTraceEnd name' to save the trace.", region_getName(region));
+		TFE_Console::addToHistory(res);
+	}
+
+	void endRegionTrace(const ConsoleArgList& args)
+	{
+		char res[TFE_MAX_PATH + 64];
+		MemoryRegion* levelRegion = region_find("level");
+		MemoryRegion* gameRegion = region_find("game");
+		MemoryRegion* region = region_isTracing(levelRegion) ? levelRegion : (region_isTracing(gameRegion) ? gameRegion : nullptr);
+		if (!region)
+		{
+			TFE_Console::addToHistory("No region trace is being recorded.");
+			return;
+		}
+		std::vector<RegionTraceOp> ops;
+		region_endTrace(region, ops);
+		if (args.size() < 2)
+		{
+			TFE_Console::addToHistory("The trace was discarded, pass in a name to save it. Example: regionTraceEnd secbase");
+			return;
+		}
+
+		char path[TFE_MAX_PATH];
+		TFE_Paths::appendPath(PATH_USER_DOCUMENTS, "MemoryTraces/", path);
+		FileUtil::makeDirectory(path);
+		sprintf(path + strlen(path), "%s.rtrace", args[1].c_str());
+		if (memoryBenchmark_saveTrace(path, ops))
+		{
+			sprintf(res, "Saved %zu operations to '%s'.", ops.size(), path);
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	void displayBenchmarkResults(const std::vector<MemoryBenchmarkResult>& results)
+	{
+		char res[256];
+		TFE_Console::addToHistory("  Benchmark                                  |      Ops |   Mops/sec | p99 (us) | Peak Frag | Peak Used KB");
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const MemoryBenchmarkResult& result = results[i];
+			if (result.peakFragmentation < 0.0f)
+			{
+				sprintf(res, "  %-42s | %8llu | %10.2f | %8.3f |       n/a |          n/a", result.name, (unsigned long long)result.opCount,
+					result.opsPerSecond / 1000000.0, result.p99Latency);
+			}
+			else
+			{
+				sprintf(res, "  %-42s | %8llu | %10.2f | %8.3f | %8.1f%% | %12zu", result.name, (unsigned long long)result.opCount,
+					result.opsPerSecond / 1000000.0, result.p99Latency, result.peakFragmentation * 100.0f, result.peakUsed >> 10);
+			}
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	// Run the memory benchmarks: synthetic churn plus every recorded trace, or a single trace if a name is passed in.
+	void runRegionBenchmark(const ConsoleArgList& args)
+	{
+		char traceDir[TFE_MAX_PATH];
+		char path[TFE_MAX_PATH];
+		TFE_Paths::appendPath(PATH_USER_DOCUMENTS, "MemoryTraces/", traceDir);
+
+		FileList traces;
+		if (args.size() >= 2)
+		{
+			traces.push_back(args[1] + ".rtrace");
+		}
+		else
+		{
+			FileUtil::readDirectory(traceDir, "rtrace", traces);
+		}
+
+		std::vector<MemoryBenchmarkResult> results;
+		if (args.size() < 2)
+		{
+			memoryBenchmark_runSynthetic(results);
+		}
+
+		std::vector<RegionTraceOp> ops;
+		for (size_t i = 0; i < traces.size(); i++)
+		{
+			sprintf(path, "%s%s", traceDir, traces[i].c_str());
+			if (!memoryBenchmark_loadTrace(path, ops))
+			{
+				TFE_Console::addToHistory(("Cannot load trace " + traces[i]).c_str());
+				continue;
+			}
+
+			char name[TFE_MAX_PATH];
+			FileUtil::getFileNameFromPath(traces[i].c_str(), name);
+			memoryBenchmark_replayTrace(name, ops, results);
+		}
+		displayBenchmarkResults(results);
+	}
+
+	void memoryBenchmark_init()
+	{
+		CCMD("regionTraceBegin", beginRegionTrace, 0, "Start recording allocations in the 'level' (default) or 'game' region for 'regionBench'.");
+		CCMD("regionTraceEnd", endRegionTrace, 0, "Stop recording allocations and save the trace under the given name. Example: regionTraceEnd secbase");
+		CCMD("regionBench", runRegionBenchmark, 0, "Benchmark malloc, the region allocators, Allocator and ChunkedArray with synthetic churn and recorded traces. Optionally pass a trace name to replay only that trace.");
+	}
+}
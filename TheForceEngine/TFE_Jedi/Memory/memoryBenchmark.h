@@ -0,0 +1,35 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Memory benchmarks
+// Replays recorded region allocation traces and synthetic churn
+// against malloc, each region allocation strategy, Allocator and
+// ChunkedArray so allocator changes can be judged by numbers.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_Memory/memoryRegion.h>
+#include <vector>
+
+struct MemoryBenchmarkResult
+{
+	char   name[64];
+	u64    opCount;
+	f64    opsPerSecond;
+	f64    p99Latency;			// Microseconds.
+	f32    peakFragmentation;	// Sampled during the run, negative if the backend has no region to measure (malloc).
+	size_t peakUsed;			// Bytes, 0 if the backend has no region to measure.
+};
+
+namespace TFE_Jedi
+{
+	// Register the trace and benchmark console commands.
+	void memoryBenchmark_init();
+
+	// Save or load an allocation trace recorded with region_beginTrace() / region_endTrace().
+	bool memoryBenchmark_saveTrace(const char* path, const std::vector<RegionTraceOp>& ops);
+	bool memoryBenchmark_loadTrace(const char* path, std::vector<RegionTraceOp>& ops);
+
+	// Replay a recorded trace against malloc and each region allocation strategy.
+	void memoryBenchmark_replayTrace(const char* name, const std::vector<RegionTraceOp>& ops, std::vector<MemoryBenchmarkResult>& results);
+	// Run deterministic synthetic churn against malloc, each region allocation strategy, Allocator and ChunkedArray.
+	void memoryBenchmark_runSynthetic(std::vector<MemoryBenchmarkResult>& results);
+}
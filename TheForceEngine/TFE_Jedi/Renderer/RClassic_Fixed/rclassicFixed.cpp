@@ -200,19 +200,19 @@ namespace RClassic_Fixed
 		s_rcfState.flatEdge = flatEdge;
 		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfState.windowMaxY, 0, s_rcfState.windowMinY);
 		
-		s_columnTop = (s32*)game_realloc(s_columnTop, s_width * sizeof(s32));
-		s_columnBot = (s32*)game_realloc(s_columnBot, s_width * sizeof(s32));
-		s_rcfState.depth1d_all = (fixed16_16*)game_realloc(s_rcfState.depth1d_all, s_width * sizeof(fixed16_16) * (MAX_ADJOIN_DEPTH + 1));
-		s_windowTop_all = (s32*)game_realloc(s_windowTop_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH + 1));
-		s_windowBot_all = (s32*)game_realloc(s_windowBot_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH + 1));
+		s_columnTop = (s32*)game_reallocTagged(s_columnTop, s_width * sizeof(s32), REGION_TAG_RENDERER);
+		s_columnBot = (s32*)game_reallocTagged(s_columnBot, s_width * sizeof(s32), REGION_TAG_RENDERER);
+		s_rcfState.depth1d_all = (fixed16_16*)game_reallocTagged(s_rcfState.depth1d_all, s_width * sizeof(fixed16_16) * (MAX_ADJOIN_DEPTH + 1), REGION_TAG_RENDERER);
+		s_windowTop_all = (s32*)game_reallocTagged(s_windowTop_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH + 1), REGION_TAG_RENDERER);
+		s_windowBot_all = (s32*)game_reallocTagged(s_windowBot_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH + 1), REGION_TAG_RENDERER);
 
 		memset(s_windowTop_all, s_minScreenY, 320);
 		memset(s_windowBot_all, s_maxScreenY, 320);
 
 		// Build tables
-		s_rcfState.column_Z_Over_X = (fixed16_16*)game_realloc(s_rcfState.column_Z_Over_X, s_width * sizeof(fixed16_16));
-		s_rcfState.column_X_Over_Z = (fixed16_16*)game_realloc(s_rcfState.column_X_Over_Z, s_width * sizeof(fixed16_16));
-		s_rcfState.skyTable = (fixed16_16*)game_realloc(s_rcfState.skyTable, (s_width + 1) * sizeof(fixed16_16));
+		s_rcfState.column_Z_Over_X = (fixed16_16*)game_reallocTagged(s_rcfState.column_Z_Over_X, s_width * sizeof(fixed16_16), REGION_TAG_RENDERER);
+		s_rcfState.column_X_Over_Z = (fixed16_16*)game_reallocTagged(s_rcfState.column_X_Over_Z, s_width * sizeof(fixed16_16), REGION_TAG_RENDERER);
+		s_rcfState.skyTable = (fixed16_16*)game_reallocTagged(s_rcfState.skyTable, (s_width + 1) * sizeof(fixed16_16), REGION_TAG_RENDERER);
 
 		// Here we assume a 90 degree field of view, this forms a frustum (not drawn to scale):
 		//     W = width of plane in pixels
@@ -244,7 +244,7 @@ namespace RClassic_Fixed
 			}
 		}
 
-		s_rcfState.rcpY = (fixed16_16*)game_realloc(s_rcfState.rcpY, 4 * s_height * sizeof(fixed16_16));
+		s_rcfState.rcpY = (fixed16_16*)game_reallocTagged(s_rcfState.rcpY, 4 * s_height * sizeof(fixed16_16), REGION_TAG_RENDERER);
 		buildRcpYTable();
 	}
 
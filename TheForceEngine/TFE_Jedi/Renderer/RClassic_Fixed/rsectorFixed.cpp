@@ -72,18 +72,12 @@ namespace TFE_Jedi
 		s32 cullObjects(RSector* sector, SecObject** buffer)
 		{
 			s32 drawCount = 0;
-			SecObject** obj = sector->objectList;
+			SecObject** obj = sector->objectDense;
 			s32 count = sector->objectCount;
 
 			for (s32 i = count - 1; i >= 0 && drawCount < MAX_VIEW_OBJ_COUNT; i--, obj++)
 			{
-				// Search for the next allocated object.
 				SecObject* curObj = *obj;
-				while (!curObj)
-				{
-					obj++;
-					curObj = *obj;
-				}
 
 				if (curObj->flags & OBJ_FLAG_NEEDS_TRANSFORM)
 				{
@@ -231,15 +225,10 @@ namespace TFE_Jedi
 			TFE_ZONE_END(secXform);
 
 			TFE_ZONE_BEGIN(objXform, "Sector Object Transform");
-				SecObject** obj = s_curSector->objectList;
+				SecObject** obj = s_curSector->objectDense;
 				for (s32 i = s_curSector->objectCount - 1; i >= 0; i--, obj++)
 				{
 					SecObject* curObj = *obj;
-					while (!curObj)
-					{
-						obj++;
-						curObj = *obj;
-					}
 
 					if (curObj->flags & OBJ_FLAG_NEEDS_TRANSFORM)
 					{
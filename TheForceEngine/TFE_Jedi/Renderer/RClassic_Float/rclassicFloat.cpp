@@ -217,11 +217,11 @@ namespace RClassic_Float
 		s_rcfltState.flatEdge = flatEdge;
 		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState.windowMaxY, 0, s_rcfltState.windowMinY);
 		
-		s_columnTop = (s32*)game_realloc(s_columnTop, s_width * sizeof(s32));
-		s_columnBot = (s32*)game_realloc(s_columnBot, s_width * sizeof(s32));
-		s_rcfltState.depth1d_all = (f32*)game_realloc(s_rcfltState.depth1d_all, s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1));
-		s_windowTop_all = (s32*)game_realloc(s_windowTop_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
-		s_windowBot_all = (s32*)game_realloc(s_windowBot_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		s_columnTop = (s32*)game_reallocTagged(s_columnTop, s_width * sizeof(s32), REGION_TAG_RENDERER);
+		s_columnBot = (s32*)game_reallocTagged(s_columnBot, s_width * sizeof(s32), REGION_TAG_RENDERER);
+		s_rcfltState.depth1d_all = (f32*)game_reallocTagged(s_rcfltState.depth1d_all, s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1), REGION_TAG_RENDERER);
+		s_windowTop_all = (s32*)game_reallocTagged(s_windowTop_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1), REGION_TAG_RENDERER);
+		s_windowBot_all = (s32*)game_reallocTagged(s_windowBot_all, s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1), REGION_TAG_RENDERER);
 
 		// This table is giant with higher limits, so for now allocate directly from the heap (13 MB)
 		if (!s_rcfltState.adjoinEdgeList)
@@ -233,7 +233,7 @@ namespace RClassic_Float
 		memset(s_windowBot_all, s_maxScreenY, s_width);
 
 		// Build tables
-		s_rcfltState.skyTable = (f32*)game_realloc(s_rcfltState.skyTable, (s_width + 1) * sizeof(f32));
+		s_rcfltState.skyTable = (f32*)game_reallocTagged(s_rcfltState.skyTable, (s_width + 1) * sizeof(f32), REGION_TAG_RENDERER);
 	}
 
 	void computeSkyTable()
@@ -81,20 +81,14 @@ namespace TFE_Jedi
 		s32 cullObjects(RSector* sector, SecObject** buffer)
 		{
 			s32 drawCount = 0;
-			SecObject** obj = sector->objectList;
+			SecObject** obj = sector->objectDense;
 			s32 count = sector->objectCount;
 
 			const SectorCached* cached = &s_ctx->m_cachedSectors[sector->index];
 
 			for (s32 i = count - 1; i >= 0 && drawCount < MAX_VIEW_OBJ_COUNT; i--, obj++)
 			{
-				// Search for the next allocated object.
 				SecObject* curObj = *obj;
-				while (!curObj)
-				{
-					obj++;
-					curObj = *obj;
-				}
 
 				if (curObj->flags & OBJ_FLAG_NEEDS_TRANSFORM)
 				{
@@ -266,16 +260,11 @@ namespace TFE_Jedi
 			TFE_ZONE_END(secXform);
 
 			TFE_ZONE_BEGIN(objXform, "Sector Object Transform");
-				SecObject** obj = s_curSector->objectList;
+				SecObject** obj = s_curSector->objectDense;
 				vec3_float* objPosVS = cachedSector->objPosVS;
 				for (s32 i = s_curSector->objectCount - 1; i >= 0; i--, obj++)
 				{
 					SecObject* curObj = *obj;
-					while (!curObj)
-					{
-						obj++;
-						curObj = *obj;
-					}
 
 					if (curObj->flags & OBJ_FLAG_NEEDS_TRANSFORM)
 					{
@@ -699,7 +688,7 @@ namespace TFE_Jedi
 		RSector* srcSector = cached->sector;
 		if (flags & SDF_INIT_SETUP)
 		{
-			cached->cachedWalls = (WallCached*)level_alloc(sizeof(WallCached) * srcSector->wallCount);
+			cached->cachedWalls = (WallCached*)level_allocTagged(sizeof(WallCached) * srcSector->wallCount, REGION_TAG_RENDERER);
 			memset(cached->cachedWalls, 0, sizeof(WallCached) * srcSector->wallCount);
 		}
 
@@ -752,7 +741,7 @@ namespace TFE_Jedi
 
 		if (flags & SDF_INIT_SETUP)
 		{
-			cached->verticesVS = (vec2_float*)level_alloc(sizeof(vec2_float) * srcSector->vertexCount);
+			cached->verticesVS = (vec2_float*)level_allocTagged(sizeof(vec2_float) * srcSector->vertexCount, REGION_TAG_RENDERER);
 		}
 
 		if (flags & SDF_HEIGHTS)
@@ -772,7 +761,7 @@ namespace TFE_Jedi
 		if (cached->objectCapacity < srcSector->objectCapacity)
 		{
 			cached->objectCapacity = srcSector->objectCapacity;
-			cached->objPosVS = (vec3_float*)level_realloc(cached->objPosVS, sizeof(vec3_float) * cached->objectCapacity);
+			cached->objPosVS = (vec3_float*)level_reallocTagged(cached->objPosVS, sizeof(vec3_float) * cached->objectCapacity, REGION_TAG_RENDERER);
 		}
 
 		updateCachedWalls(cached, flags);
@@ -789,7 +778,7 @@ namespace TFE_Jedi
 		if (!m_cachedSectors)
 		{
 			m_cachedSectorCount = s_levelState.sectorCount;
-			m_cachedSectors = (SectorCached*)level_alloc(sizeof(SectorCached) * m_cachedSectorCount);
+			m_cachedSectors = (SectorCached*)level_allocTagged(sizeof(SectorCached) * m_cachedSectorCount, REGION_TAG_RENDERER);
 			memset(m_cachedSectors, 0, sizeof(SectorCached) * m_cachedSectorCount);
 
 			for (u32 i = 0; i < m_cachedSectorCount; i++)
@@ -1,4 +1,5 @@
 #include <cstring>
+#include <algorithm>
 
 #include <TFE_System/profiler.h>
 #include <TFE_System/math.h>
@@ -20,6 +21,13 @@
 #include "frustum.h"
 #include "../rcommon.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define FRUSTUM_CULL_SSE 1
+	#include <emmintrin.h>
+#else
+	#define FRUSTUM_CULL_SSE 0
+#endif
+
 namespace TFE_Jedi
 {
 	// A small epsilon value to make point vs. plane side determinations more robust to numerical error.
@@ -138,6 +146,136 @@ namespace TFE_Jedi
 		}
 		return true;
 	}
+
+	void frustum_spheresInside(s32 count, const f32* x, const f32* y, const f32* z, const f32* radius, u8* inside)
+	{
+		const Frustum* frustum = frustum_getBack();
+		if (!frustum || frustum->planeCount < 1)
+		{
+			memset(inside, 1, count);
+			return;
+		}
+		const u32 planeCount = frustum->planeCount;
+		const Vec4f* planes = frustum->planes;
+
+		s32 i = 0;
+	#if FRUSTUM_CULL_SSE
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 px = _mm_loadu_ps(x + i);
+			const __m128 py = _mm_loadu_ps(y + i);
+			const __m128 pz = _mm_loadu_ps(z + i);
+			const __m128 pr = _mm_loadu_ps(radius + i);
+
+			__m128 outside = zero;
+			for (u32 p = 0; p < planeCount; p++)
+			{
+				// dist + radius, where dist = dot(n, pos) + w
+				__m128 dist = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(planes[p].x)), _mm_set1_ps(planes[p].w));
+				dist = _mm_add_ps(dist, _mm_mul_ps(py, _mm_set1_ps(planes[p].y)));
+				dist = _mm_add_ps(dist, _mm_mul_ps(pz, _mm_set1_ps(planes[p].z)));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, pr), zero));
+				// Stop early once all 4 are culled.
+				if (_mm_movemask_ps(outside) == 0xf) { break; }
+			}
+
+			const s32 outsideMask = _mm_movemask_ps(outside);
+			inside[i + 0] = (outsideMask & 1) ? 0 : 1;
+			inside[i + 1] = (outsideMask & 2) ? 0 : 1;
+			inside[i + 2] = (outsideMask & 4) ? 0 : 1;
+			inside[i + 3] = (outsideMask & 8) ? 0 : 1;
+		}
+	#endif
+		// Remainder or non-SIMD builds.
+		for (; i < count; i++)
+		{
+			inside[i] = 1;
+			for (u32 p = 0; p < planeCount; p++)
+			{
+				const f32 dist = planes[p].x*x[i] + planes[p].y*y[i] + planes[p].z*z[i] + planes[p].w;
+				if (dist + radius[i] < 0.0f)
+				{
+					inside[i] = 0;
+					break;
+				}
+			}
+		}
+	}
+
+	// The quads are vertical, so the distance to each corner splits into an XZ term and a Y term.
+	// The quad is outside of a plane if the farthest corner is, which is max(XZ terms) + max(Y terms).
+	void frustum_quadsInside(s32 count, const f32* x0, const f32* y0, const f32* z0, const f32* x1, const f32* y1, const f32* z1, u8* inside)
+	{
+		const Frustum* frustum = frustum_getBack();
+		if (!frustum || frustum->planeCount < 1)
+		{
+			memset(inside, 1, count);
+			return;
+		}
+		const u32 planeCount = frustum->planeCount;
+		const Vec4f* planes = frustum->planes;
+
+		// Make the near plane test less aggressive.
+		const f32 nearPlaneEps = -c_planeEps * 10.0f;
+		const u32 nearPlaneIdx = planeCount - 1;
+
+		s32 i = 0;
+	#if FRUSTUM_CULL_SSE
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 ax = _mm_loadu_ps(x0 + i);
+			const __m128 ay = _mm_loadu_ps(y0 + i);
+			const __m128 az = _mm_loadu_ps(z0 + i);
+			const __m128 bx = _mm_loadu_ps(x1 + i);
+			const __m128 by = _mm_loadu_ps(y1 + i);
+			const __m128 bz = _mm_loadu_ps(z1 + i);
+
+			__m128 outside = _mm_setzero_ps();
+			for (u32 p = 0; p < planeCount; p++)
+			{
+				const __m128 nx = _mm_set1_ps(planes[p].x);
+				const __m128 ny = _mm_set1_ps(planes[p].y);
+				const __m128 nz = _mm_set1_ps(planes[p].z);
+				const __m128 nw = _mm_set1_ps(planes[p].w);
+				const __m128 eps = _mm_set1_ps(p == nearPlaneIdx ? nearPlaneEps : c_planeEps);
+
+				const __m128 h0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, nx), _mm_mul_ps(az, nz)), nw);
+				const __m128 h1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(bx, nx), _mm_mul_ps(bz, nz)), nw);
+				const __m128 v0 = _mm_mul_ps(ay, ny);
+				const __m128 v1 = _mm_mul_ps(by, ny);
+				const __m128 maxDist = _mm_add_ps(_mm_max_ps(h0, h1), _mm_max_ps(v0, v1));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(maxDist, eps));
+				// Stop early once all 4 are culled.
+				if (_mm_movemask_ps(outside) == 0xf) { break; }
+			}
+
+			const s32 outsideMask = _mm_movemask_ps(outside);
+			inside[i + 0] = (outsideMask & 1) ? 0 : 1;
+			inside[i + 1] = (outsideMask & 2) ? 0 : 1;
+			inside[i + 2] = (outsideMask & 4) ? 0 : 1;
+			inside[i + 3] = (outsideMask & 8) ? 0 : 1;
+		}
+	#endif
+		// Remainder or non-SIMD builds.
+		for (; i < count; i++)
+		{
+			inside[i] = 1;
+			for (u32 p = 0; p < planeCount; p++)
+			{
+				const f32 eps = (p == nearPlaneIdx) ? nearPlaneEps : c_planeEps;
+				const f32 h0 = planes[p].x*x0[i] + planes[p].z*z0[i] + planes[p].w;
+				const f32 h1 = planes[p].x*x1[i] + planes[p].z*z1[i] + planes[p].w;
+				const f32 v0 = planes[p].y*y0[i];
+				const f32 v1 = planes[p].y*y1[i];
+				if (std::max(h0, h1) + std::max(v0, v1) < eps)
+				{
+					inside[i] = 0;
+					break;
+				}
+			}
+		}
+	}
 						
 	bool frustum_clipQuadToFrustum(Vec3f corner0, Vec3f corner1, Polygon* output, bool ignoreNearPlane)
 	{
@@ -41,6 +41,14 @@ namespace TFE_Jedi
 	// Returns true if the quad is in front of the near plane.
 	bool frustum_quadInside(const Vec3f v0, const Vec3f v1);
 
+	// Batch culling against the current frustum on the stack, objects are passed as structure of arrays
+	// so that several objects can be tested at once. inside[i] is set to 1 if object i is fully or partially
+	// inside of the frustum, else 0.
+	// Spheres use the same test as frustum_sphereInside().
+	void frustum_spheresInside(s32 count, const f32* x, const f32* y, const f32* z, const f32* radius, u8* inside);
+	// Vertical quads formed from {corner0, corner1}, using the same test as frustum_quadInside().
+	void frustum_quadsInside(s32 count, const f32* x0, const f32* y0, const f32* z0, const f32* x1, const f32* y1, const f32* z1, u8* inside);
+
 	// This clips the quad formed from {corner0, corner1} against the current frustum on the stack.
 	// Returns false if the quad is outside of the frustum, else true.
 	bool frustum_clipQuadToFrustum(Vec3f corner0, Vec3f corner1, Polygon* output, bool ignoreNearPlane = false);
@@ -2,6 +2,7 @@
 
 #include <TFE_System/profiler.h>
 #include <TFE_System/math.h>
+#include <TFE_System/hash.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/Level/level.h>
@@ -29,6 +30,7 @@
 
 #include <algorithm>
 #include <map>
+#include <set>
 #include <vector>
 
 using namespace TFE_RenderBackend;
@@ -55,11 +57,40 @@ namespace TFE_Jedi
 		u32 color;
 	};
 
+	// GPU models are cached by content so levels that reuse the same 3DO share the geometry.
+	// Geometry is built the first time a model is drawn and may be evicted later to make room for other models.
 	struct ModelGPU
 	{
 		ModelShader shader;
-		s32 indexStart;
+		s32 indexStart;		// -1 when the geometry is not resident.
 		s32 polyCount;
+
+		// Arena ranges.
+		u32 vertexStart;
+		u32 vertexCount;
+		u32 indexCount;
+
+		u64 key;
+		u64 textureIdKey;	// Texture IDs baked into the geometry, they change when the textures are packed again for a new level.
+		f32 radius;			// Bounding sphere radius, centered on the model origin.
+		u32 lastFrame;		// Last frame the model was drawn, models drawn this frame cannot be evicted.
+		bool buildFailed;	// The model does not fit in the arena.
+		ModelGPU* lruPrev;	// Most recently used resident models are at the head.
+		ModelGPU* lruNext;
+	};
+
+	// Free ranges in a fixed size vertex or index arena.
+	struct ArenaRange
+	{
+		u32 start;
+		u32 count;
+	};
+
+	struct ModelArena
+	{
+		u32 capacity;
+		u32 used;
+		std::vector<ArenaRange> freeRanges;	// Sorted by start, adjacent ranges are merged.
 	};
 
 	struct ModelDraw
@@ -91,14 +122,31 @@ namespace TFE_Jedi
 	static const u32 c_modelAttrCount = TFE_ARRAYSIZE(c_modelAttrMapping);
 
 	static Shader s_modelShaders[MGPU_SHADER_COUNT];
-	static VertexBuffer s_modelVertexBuffer;	// vertex buffer contains vertices for all loaded models.
-	static IndexBuffer  s_modelIndexBuffer;		// index buffer for all loaded models.
-
+	static VertexBuffer s_modelVertexBuffer;	// vertex arena shared by all resident models.
+	static IndexBuffer  s_modelIndexBuffer;		// index arena shared by all resident models.
+
+	// Arena sizes: 9Mb of vertices and 3Mb of indices.
+	static const u32 c_modelArenaVertexCount = 256 * 1024;
+	static const u32 c_modelArenaIndexCount  = 768 * 1024;
+	static ModelArena s_vertexArena;
+	static ModelArena s_indexArena;
+
+	static std::map<u64, ModelGPU*> s_modelCache;
+	static std::map<const TextureData*, u64> s_textureHashes;	// Texture content hashes, only kept while models are being mapped.
+	static ModelGPU* s_lruHead = nullptr;
+	static ModelGPU* s_lruTail = nullptr;
+	static u32 s_modelFrame = 0;
+
+	// Scratch buffers used to build a single model.
 	static std::vector<ModelVertex> s_vertexData;
 	static std::vector<u32> s_indexData;
 
 	static s32 s_3doRendered = 0;
 	static s32 s_3doPolygons = 0;
+	static s32 s_3doResident = 0;
+	static s32 s_3doBuilt = 0;
+	static s32 s_3doEvicted = 0;
+	static s32 s_3doArenaUsage = 0;
 
 	static ModelShaderSettings s_shaderSettings = {};
 
@@ -168,14 +216,6 @@ namespace TFE_Jedi
 
 	bool model_updateShaders(bool initialize);
 
-	static ModelGPU *newModelGPU(void)
-	{
-		ModelGPU* mgpu = (ModelGPU *)malloc(sizeof(ModelGPU));
-		if (!mgpu) { return nullptr; }
-		memset(mgpu, 0, sizeof(ModelGPU));
-		return mgpu;
-	}
-
 	static bool model_buildShaderVariant(ModelShader variant, s32 defineCount, ShaderDefine* defines)
 	{
 		Shader* shader = &s_modelShaders[variant];
@@ -209,11 +249,171 @@ namespace TFE_Jedi
 		return true;
 	}
 
+	static void arena_init(ModelArena* arena, u32 capacity)
+	{
+		arena->capacity = capacity;
+		arena->used = 0;
+		arena->freeRanges.clear();
+		arena->freeRanges.push_back({ 0, capacity });
+	}
+
+	// First fit, models are allocated and freed in roughly LRU order so fragmentation stays low.
+	static bool arena_alloc(ModelArena* arena, u32 count, u32* start)
+	{
+		const size_t rangeCount = arena->freeRanges.size();
+		for (size_t i = 0; i < rangeCount; i++)
+		{
+			ArenaRange& range = arena->freeRanges[i];
+			if (range.count < count) { continue; }
+
+			*start = range.start;
+			range.start += count;
+			range.count -= count;
+			if (!range.count)
+			{
+				arena->freeRanges.erase(arena->freeRanges.begin() + i);
+			}
+			arena->used += count;
+			return true;
+		}
+		return false;
+	}
+
+	static void arena_free(ModelArena* arena, u32 start, u32 count)
+	{
+		if (!count) { return; }
+		arena->used -= count;
+
+		std::vector<ArenaRange>& ranges = arena->freeRanges;
+		std::vector<ArenaRange>::iterator next = std::lower_bound(ranges.begin(), ranges.end(), start,
+			[](const ArenaRange& range, u32 value) { return range.start < value; });
+		// Merge with the following range.
+		if (next != ranges.end() && start + count == next->start)
+		{
+			next->start = start;
+			next->count += count;
+		}
+		else
+		{
+			next = ranges.insert(next, { start, count });
+		}
+		// Merge with the previous range.
+		if (next != ranges.begin())
+		{
+			std::vector<ArenaRange>::iterator prev = next - 1;
+			if (prev->start + prev->count == next->start)
+			{
+				prev->count += next->count;
+				ranges.erase(next);
+			}
+		}
+	}
+
+	static void lru_remove(ModelGPU* mgpu)
+	{
+		if (mgpu->lruPrev) { mgpu->lruPrev->lruNext = mgpu->lruNext; }
+		else { s_lruHead = mgpu->lruNext; }
+		if (mgpu->lruNext) { mgpu->lruNext->lruPrev = mgpu->lruPrev; }
+		else { s_lruTail = mgpu->lruPrev; }
+		mgpu->lruPrev = nullptr;
+		mgpu->lruNext = nullptr;
+	}
+
+	static void lru_pushFront(ModelGPU* mgpu)
+	{
+		mgpu->lruPrev = nullptr;
+		mgpu->lruNext = s_lruHead;
+		if (s_lruHead) { s_lruHead->lruPrev = mgpu; }
+		s_lruHead = mgpu;
+		if (!s_lruTail) { s_lruTail = mgpu; }
+	}
+
+	static void updateArenaCounters()
+	{
+		const u32 vtxUsage = s_vertexArena.capacity ? s_vertexArena.used * 100 / s_vertexArena.capacity : 0;
+		const u32 idxUsage = s_indexArena.capacity  ? s_indexArena.used  * 100 / s_indexArena.capacity  : 0;
+		s_3doArenaUsage = (s32)std::max(vtxUsage, idxUsage);
+	}
+
+	static void model_evict(ModelGPU* mgpu)
+	{
+		arena_free(&s_vertexArena, mgpu->vertexStart, mgpu->vertexCount);
+		arena_free(&s_indexArena, u32(mgpu->indexStart), mgpu->indexCount);
+		mgpu->indexStart = -1;
+		mgpu->vertexCount = 0;
+		mgpu->indexCount = 0;
+		lru_remove(mgpu);
+
+		s_3doResident--;
+		s_3doEvicted++;
+		updateArenaCounters();
+	}
+
+	// Evict the least recently used model, returns false if every resident model is needed for the current frame.
+	static bool model_evictLRU()
+	{
+		ModelGPU* mgpu = s_lruTail;
+		if (!mgpu || mgpu->lastFrame == s_modelFrame) { return false; }
+		model_evict(mgpu);
+		return true;
+	}
+
+	// Cache entries are kept since models may still reference them through drawId, only the geometry is released.
+	static void model_clearCache()
+	{
+		std::map<u64, ModelGPU*>::iterator iModel = s_modelCache.begin();
+		for (; iModel != s_modelCache.end(); ++iModel)
+		{
+			ModelGPU* mgpu = iModel->second;
+			mgpu->indexStart = -1;
+			mgpu->vertexCount = 0;
+			mgpu->indexCount = 0;
+			mgpu->lruPrev = nullptr;
+			mgpu->lruNext = nullptr;
+		}
+		s_lruHead = nullptr;
+		s_lruTail = nullptr;
+		s_3doResident = 0;
+
+		arena_init(&s_vertexArena, c_modelArenaVertexCount);
+		arena_init(&s_indexArena,  c_modelArenaIndexCount);
+		updateArenaCounters();
+	}
+
+	// Free every cache entry, models loaded later are mapped again by model_loadGpuModels().
+	static void model_freeCache()
+	{
+		for (s32 pool = 0; pool < POOL_COUNT; pool++)
+		{
+			const std::vector<JediModel*>& modelList = TFE_Model_Jedi::getModelList(AssetPool(pool));
+			const size_t modelCount = modelList.size();
+			for (size_t i = 0; i < modelCount; i++)
+			{
+				modelList[i]->drawId = nullptr;
+			}
+		}
+
+		std::map<u64, ModelGPU*>::iterator iModel = s_modelCache.begin();
+		for (; iModel != s_modelCache.end(); ++iModel)
+		{
+			free(iModel->second);
+		}
+		s_modelCache.clear();
+	}
+
 	bool model_init()
 	{
 		bool result = model_updateShaders(true);
 		TFE_COUNTER(s_3doRendered, "3DO Objects Rendered");
 		TFE_COUNTER(s_3doPolygons, "3DO Polygons Rendered");
+		TFE_COUNTER(s_3doResident, "3DO GPU Models Resident");
+		TFE_COUNTER(s_3doBuilt,    "3DO GPU Models Built");
+		TFE_COUNTER(s_3doEvicted,  "3DO GPU Models Evicted");
+		TFE_COUNTER(s_3doArenaUsage, "3DO GPU Arena Usage %");
+
+		model_clearCache();
+		result = result && s_modelVertexBuffer.create(c_modelArenaVertexCount, sizeof(ModelVertex), c_modelAttrCount, c_modelAttrMapping, true);
+		result = result && s_modelIndexBuffer.create(c_modelArenaIndexCount, sizeof(u32), true);
 		return result;
 	}
 
@@ -223,6 +423,10 @@ namespace TFE_Jedi
 		{
 			s_modelShaders[i].destroy();
 		}
+		s_modelVertexBuffer.destroy();
+		s_modelIndexBuffer.destroy();
+		model_clearCache();
+		model_freeCache();
 	}
 		
 	bool model_updateShaders(bool initialize)
@@ -287,7 +491,7 @@ namespace TFE_Jedi
 		return result;
 	}
 
-	static bool buildModelDrawVertices(JediModel* model, s32* indexStart, s32* vertexStart)
+	static void buildModelDrawVertices(JediModel* model, ModelGPU* mgpu, s32* indexStart, s32* vertexStart)
 	{
 		// In this version, we render one quad per vertex.
 		// Store store 4 vertices per quad, but store corner in uv.
@@ -343,15 +547,8 @@ namespace TFE_Jedi
 			outIdx[5] = 3 + vidx;
 		}
 
-		ModelGPU* mgpu = newModelGPU();
-		if (!mgpu) { return false; }
-
-		mgpu->indexStart = (s32)curIdxSize;
 		mgpu->polyCount = model->vertexCount * 2;
 		mgpu->shader = MGPU_SHADER_HOLOGRAM;
-		model->drawId = (void *)mgpu;
-
-		return true;
 	}
 		
 	static void startModel(struct ModelBuildCtx *ctx, JediModel* model, s32* indexStart, s32* vertexStart)
@@ -364,16 +561,10 @@ namespace TFE_Jedi
 		ctx->modelVertexList.clear();
 	}
 
-	static void endModel(struct ModelBuildCtx *ctx)
+	static void endModel(struct ModelBuildCtx *ctx, ModelGPU* mgpu)
 	{
-		// Create the entry.
-		ModelGPU* mgpu = newModelGPU();
-		if (!mgpu) { return; } 
-
-		mgpu->indexStart = *(ctx->curIndexStart);
 		mgpu->polyCount = ((s32)s_indexData.size() - (*(ctx->curIndexStart))) / 3;
 		mgpu->shader = ctx->modelTrans ? MGPU_SHADER_TRANS : MGPU_SHADER_SOLID;
-		ctx->model->drawId = (void *)mgpu;
 
 		// Add vertices.
 		const u32 vtxCount = (u32)ctx->modelVertexList.size();
@@ -624,18 +815,250 @@ namespace TFE_Jedi
 		s_indexData.push_back(outIndices[3] + vertexStart);
 	}
 
-	void model_loadGpuModels()
+	// Build the geometry for a single model into the scratch buffers, indices are relative to the first vertex.
+	static void buildModelGeometry(JediModel* model, ModelGPU* mgpu)
 	{
-		ModelBuildCtx ctx;
+		static ModelBuildCtx s_buildCtx;
+		ModelBuildCtx* ctx = &s_buildCtx;
 		s32 indexStart  = 0;
 		s32 vertexStart = 0;
 		s_vertexData.clear();
 		s_indexData.clear();
 
-		s_modelVertexBuffer.destroy();
-		s_modelIndexBuffer.destroy();
+		if (model->flags & MFLAG_DRAW_VERTICES)
+		{
+			buildModelDrawVertices(model, mgpu, &indexStart, &vertexStart);
+			return;
+		}
+
+		// This model has solid polygons.
+		startModel(ctx, model, &indexStart, &vertexStart);
+		for (s32 p = 0; p < model->polygonCount; p++)
+		{
+			JmPolygon* poly = &model->polygons[p];
+			if (poly->texture && (poly->texture->flags & OPACITY_TRANS) && poly->shading == PSHADE_PLANE)
+			{
+				ctx->modelTrans = true;
+			}
+
+			switch (poly->shading)
+			{
+				case PSHADE_FLAT:
+				{
+					// Flat shaded polygon
+					if (poly->vertexCount == 3)
+					{
+						addFlatTriangle(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], -1);
+					}
+					else
+					{
+						addFlatQuad(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], -1);
+					}
+				} break;
+				case PSHADE_GOURAUD:
+				{
+					// Smooth shaded polygon
+					if (poly->vertexCount == 3)
+					{
+						addSmoothTriangle(ctx, poly->indices, poly->color, poly->uv, -1);
+					}
+					else
+					{
+						addSmoothQuad(ctx, poly->indices, poly->color, poly->uv, -1);
+					}
+				} break;
+				case PSHADE_TEXTURE:
+				{
+					// Flat shaded textured polygon
+					if (poly->vertexCount == 3)
+					{
+						addFlatTriangle(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], poly->texture->textureId);
+					}
+					else
+					{
+						addFlatQuad(ctx, poly->indices, poly->color, poly->uv, &model->polygonNormals[p], poly->texture->textureId);
+					}
+				} break;
+				case PSHADE_GOURAUD_TEXTURE:
+				{
+					// Smooth shaded textured polygon
+					if (poly->vertexCount == 3)
+					{
+						addSmoothTriangle(ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
+					}
+					else
+					{
+						addSmoothQuad(ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
+					}
+				} break;
+				case PSHADE_PLANE:
+				{
+					// "Plane" shaded textured polygon
+					if (poly->vertexCount == 3)
+					{
+						addPlaneTriangle(ctx, poly->indices, &model->polygonNormals[p], poly->texture->textureId);
+					}
+					else
+					{
+						addPlaneQuad(ctx, poly->indices, &model->polygonNormals[p], poly->texture->textureId);
+					}
+				} break;
+			};
+		}
+		endModel(ctx, mgpu);
+	}
 
+	static bool model_makeResident(ModelGPU* mgpu, JediModel* model)
+	{
+		buildModelGeometry(model, mgpu);
+		s_3doBuilt++;
+
+		const u32 vertexCount = (u32)s_vertexData.size();
+		const u32 indexCount  = (u32)s_indexData.size();
+		if (vertexCount > s_vertexArena.capacity || indexCount > s_indexArena.capacity)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Model GPU", "3DO model is too large for the GPU model arena (%u vertices, %u indices).", vertexCount, indexCount);
+			mgpu->buildFailed = true;
+			return false;
+		}
+
+		// Evict least recently used models until there is room.
+		u32 vertexStart = 0, indexStart = 0;
+		while (!arena_alloc(&s_vertexArena, vertexCount, &vertexStart))
+		{
+			if (!model_evictLRU()) { return false; }
+		}
+		while (!arena_alloc(&s_indexArena, indexCount, &indexStart))
+		{
+			if (!model_evictLRU())
+			{
+				arena_free(&s_vertexArena, vertexStart, vertexCount);
+				return false;
+			}
+		}
+
+		// Rebase the indices to the vertex range.
+		u32* index = s_indexData.data();
+		for (u32 i = 0; i < indexCount; i++)
+		{
+			index[i] += vertexStart;
+		}
+		if (vertexCount)
+		{
+			s_modelVertexBuffer.updateRange(s_vertexData.data(), vertexStart * sizeof(ModelVertex), vertexCount * sizeof(ModelVertex));
+		}
+		if (indexCount)
+		{
+			s_modelIndexBuffer.updateRange(s_indexData.data(), indexStart * sizeof(u32), indexCount * sizeof(u32));
+		}
+
+		mgpu->indexStart  = (s32)indexStart;
+		mgpu->vertexStart = vertexStart;
+		mgpu->vertexCount = vertexCount;
+		mgpu->indexCount  = indexCount;
+		lru_pushFront(mgpu);
+		s_3doResident++;
+		updateArenaCounters();
+		return true;
+	}
+
+	// Texture IDs are reassigned every time the textures are packed, so textures are identified by their content instead.
+	static u64 model_hashTexture(const TextureData* texture)
+	{
+		std::map<const TextureData*, u64>::iterator iHash = s_textureHashes.find(texture);
+		if (iHash != s_textureHashes.end())
+		{
+			return iHash->second;
+		}
+
+		const s32 header[] = { texture->width, texture->height, texture->uvWidth, texture->uvHeight, texture->flags, texture->compressed };
+		u64 hash = TFE_Hash::hashBuffer(header, sizeof(header));
+		if (texture->image)
+		{
+			const size_t imageSize = texture->compressed ? texture->dataSize : size_t(texture->width) * size_t(texture->height);
+			hash = TFE_Hash::hashBuffer(texture->image, imageSize, hash);
+		}
+		s_textureHashes[texture] = hash;
+		return hash;
+	}
+
+	static u64 model_computeTextureIdKey(const JediModel* model)
+	{
+		u64 hash = TFE_Hash::hashValue(model->polygonCount);
+		for (s32 p = 0; p < model->polygonCount; p++)
+		{
+			const s32 textureId = model->polygons[p].texture ? model->polygons[p].texture->textureId : -1;
+			hash = TFE_Hash::hashValue(textureId, hash);
+		}
+		return hash;
+	}
+
+	// Hash everything that ends up in the GPU geometry, except the texture IDs which are tracked separately.
+	static u64 model_computeKey(const JediModel* model)
+	{
+		u64 hash = TFE_Hash::hashValue(model->flags);
+		hash = TFE_Hash::hashValue(model->vertexCount, hash);
+		hash = TFE_Hash::hashBuffer(model->vertices, sizeof(vec3) * model->vertexCount, hash);
+		if (model->vertexNormals)
+		{
+			hash = TFE_Hash::hashBuffer(model->vertexNormals, sizeof(vec3) * model->vertexCount, hash);
+		}
+		if (model->polygonNormals)
+		{
+			hash = TFE_Hash::hashBuffer(model->polygonNormals, sizeof(vec3) * model->polygonCount, hash);
+		}
+
+		hash = TFE_Hash::hashValue(model->polygonCount, hash);
+		for (s32 p = 0; p < model->polygonCount; p++)
+		{
+			const JmPolygon* poly = &model->polygons[p];
+			const s32 polyData[] =
+			{
+				poly->shading, poly->color, poly->vertexCount,
+				poly->texture ? poly->texture->flags : 0,
+			};
+			hash = TFE_Hash::hashBuffer(polyData, sizeof(polyData), hash);
+			hash = TFE_Hash::hashValue(poly->texture ? model_hashTexture(poly->texture) : 0ull, hash);
+			hash = TFE_Hash::hashBuffer(poly->indices, sizeof(s32) * poly->vertexCount, hash);
+			if (poly->uv)
+			{
+				hash = TFE_Hash::hashBuffer(poly->uv, sizeof(vec2) * poly->vertexCount, hash);
+			}
+		}
+		return hash;
+	}
+
+	static ModelGPU* model_getCacheEntry(const JediModel* model)
+	{
+		const u64 key = model_computeKey(model);
+		std::map<u64, ModelGPU*>::iterator iModel = s_modelCache.find(key);
+		if (iModel != s_modelCache.end())
+		{
+			return iModel->second;
+		}
+
+		ModelGPU* mgpu = (ModelGPU*)malloc(sizeof(ModelGPU));
+		if (!mgpu) { return nullptr; }
+		memset(mgpu, 0, sizeof(ModelGPU));
+		mgpu->indexStart = -1;
+		mgpu->key = key;
+		mgpu->textureIdKey = model_computeTextureIdKey(model);
+		// JediModel::radius is computed in fixed point, which overflows for large models.
+		for (s32 v = 0; v < model->vertexCount; v++)
+		{
+			const Vec3f pos = { fixed16ToFloat(model->vertices[v].x), fixed16ToFloat(model->vertices[v].y), fixed16ToFloat(model->vertices[v].z) };
+			mgpu->radius = std::max(mgpu->radius, pos.x*pos.x + pos.y*pos.y + pos.z*pos.z);
+		}
+		mgpu->radius = sqrtf(mgpu->radius);
+		s_modelCache[key] = mgpu;
+		return mgpu;
+	}
+
+	// Geometry is built lazily when a model is first drawn, so this only maps models to cache entries.
+	void model_loadGpuModels()
+	{
 		// For now handle both pools here.
+		std::set<ModelGPU*> liveEntries;
 		for (s32 pool = 0; pool < POOL_COUNT; pool++)
 		{
 			const std::vector<JediModel*>& modelList = TFE_Model_Jedi::getModelList(AssetPool(pool));
@@ -643,96 +1066,42 @@ namespace TFE_Jedi
 			JediModel*const* model = modelList.data();
 			for (size_t i = 0; i < modelCount; i++)
 			{
-				if (model[i]->flags & MFLAG_DRAW_VERTICES)
-				{
-					if (!buildModelDrawVertices(model[i], &indexStart, &vertexStart))
-					{
-						// Too many unique models!
-						break;
-					}
-					continue;
-				}
+				ModelGPU* mgpu = model_getCacheEntry(model[i]);
+				model[i]->drawId = mgpu;
+				if (!mgpu || !liveEntries.insert(mgpu).second) { continue; }
 
-				// This model has solid polygons.
-				startModel(&ctx, model[i], &indexStart, &vertexStart);
-				for (s32 p = 0; p < model[i]->polygonCount; p++)
+				// Geometry kept from a previous level has that level's texture IDs baked in, so rebuild it when they changed.
+				const u64 textureIdKey = model_computeTextureIdKey(model[i]);
+				if (mgpu->textureIdKey != textureIdKey)
 				{
-					JmPolygon* poly = &model[i]->polygons[p];
-					if (poly->texture && (poly->texture->flags & OPACITY_TRANS) && poly->shading == PSHADE_PLANE)
+					if (mgpu->indexStart >= 0)
 					{
-						ctx.modelTrans = true;
+						model_evict(mgpu);
 					}
-
-					switch (poly->shading)
-					{
-						case PSHADE_FLAT:
-						{
-							// Flat shaded polygon
-							if (poly->vertexCount == 3)
-							{
-								addFlatTriangle(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], -1);
-							}
-							else
-							{
-								addFlatQuad(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], -1);
-							}
-						} break;
-						case PSHADE_GOURAUD:
-						{
-							// Smooth shaded polygon
-							if (poly->vertexCount == 3)
-							{
-								addSmoothTriangle(&ctx, poly->indices, poly->color, poly->uv, -1);
-							}
-							else
-							{
-								addSmoothQuad(&ctx, poly->indices, poly->color, poly->uv, -1);
-							}
-						} break;
-						case PSHADE_TEXTURE:
-						{
-							// Flat shaded textured polygon
-							if (poly->vertexCount == 3)
-							{
-								addFlatTriangle(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-							else
-							{
-								addFlatQuad(&ctx, poly->indices, poly->color, poly->uv, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-						} break;
-						case PSHADE_GOURAUD_TEXTURE:
-						{
-							// Smooth shaded textured polygon
-							if (poly->vertexCount == 3)
-							{
-								addSmoothTriangle(&ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
-							}
-							else
-							{
-								addSmoothQuad(&ctx, poly->indices, poly->color, poly->uv, poly->texture->textureId);
-							}
-						} break;
-						case PSHADE_PLANE:
-						{
-							// "Plane" shaded textured polygon
-							if (poly->vertexCount == 3)
-							{
-								addPlaneTriangle(&ctx, poly->indices, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-							else
-							{
-								addPlaneQuad(&ctx, poly->indices, &model[i]->polygonNormals[p], poly->texture->textureId);
-							}
-						} break;
-					};
+					mgpu->textureIdKey = textureIdKey;
 				}
-				endModel(&ctx);
 			}
 		}
+		s_textureHashes.clear();
 
-		s_modelVertexBuffer.create((u32)s_vertexData.size(), sizeof(ModelVertex), c_modelAttrCount, c_modelAttrMapping, false, s_vertexData.data());
-		s_modelIndexBuffer.create((u32)s_indexData.size(), sizeof(u32), false, s_indexData.data());
+		// Drop entries that no loaded model uses, such as the models of previous levels.
+		std::map<u64, ModelGPU*>::iterator iModel = s_modelCache.begin();
+		while (iModel != s_modelCache.end())
+		{
+			ModelGPU* mgpu = iModel->second;
+			if (liveEntries.find(mgpu) != liveEntries.end())
+			{
+				++iModel;
+				continue;
+			}
+			if (mgpu->indexStart >= 0)
+			{
+				model_evict(mgpu);
+			}
+			free(mgpu);
+			iModel = s_modelCache.erase(iModel);
+		}
+		updateArenaCounters();
 	}
 
 	void model_drawListClear()
@@ -743,6 +1112,9 @@ namespace TFE_Jedi
 		}
 		s_3doRendered = 0;
 		s_3doPolygons = 0;
+		s_3doBuilt = 0;
+		s_3doEvicted = 0;
+		s_modelFrame++;
 		model_updateShaders(false);
 	}
 
@@ -759,6 +1131,12 @@ namespace TFE_Jedi
 		return &s_modelDrawList[shader].back();
 	}
 
+	f32 model_getRadius(JediModel* model)
+	{
+		if (!model || !model->drawId) { return -1.0f; }
+		return ((ModelGPU*)model->drawId)->radius;
+	}
+
 	void model_add(void* obj, JediModel* model, Vec3f posWS, fixed16_16* transform, f32 ambient, Vec2f floorOffset, Vec2f ceilOffset, u32 portalInfo)
 	{
 		// Make sure the model has been assigned a GPU ID.
@@ -768,6 +1146,20 @@ namespace TFE_Jedi
 		}
 
 		ModelGPU* modelGPU = (ModelGPU *)model->drawId;
+		if (modelGPU->indexStart < 0)
+		{
+			if (modelGPU->buildFailed || !model_makeResident(modelGPU, model))
+			{
+				return;
+			}
+		}
+		else if (modelGPU != s_lruHead)
+		{
+			lru_remove(modelGPU);
+			lru_pushFront(modelGPU);
+		}
+		modelGPU->lastFrame = s_modelFrame;
+
 		ModelDraw* drawItem = getDrawItem(modelGPU->shader);
 		
 		drawItem->modelId = model->drawId;
@@ -798,7 +1190,7 @@ namespace TFE_Jedi
 	{
 		const TFE_Settings_Graphics* settings = TFE_Settings::getGraphicsSettings();
 
-		// Bind the uber-vertex and index buffers. This holds geometry for *all* 3D models currently loaded.
+		// Bind the uber-vertex and index buffers. This holds geometry for all resident 3D models.
 		s_modelVertexBuffer.bind();
 		s_modelIndexBuffer.bind();
 
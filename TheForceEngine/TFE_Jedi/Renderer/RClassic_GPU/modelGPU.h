@@ -19,6 +19,8 @@ namespace TFE_Jedi
 	void model_drawListClear();
 	void model_drawListFinish();
 
+	// Returns the bounding sphere radius of the model in world units or a negative value if the model cannot be drawn.
+	f32  model_getRadius(JediModel* model);
 	void model_add(void* obj, JediModel* model, Vec3f posWS, fixed16_16* transform, f32 ambient, Vec2f floorOffset, Vec2f ceilOffset, u32 portalInfo);
 	void model_drawList();
 }  // TFE_Jedi
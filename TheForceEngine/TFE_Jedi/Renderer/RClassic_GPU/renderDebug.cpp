@@ -65,7 +65,7 @@ namespace TFE_Jedi
 		{
 			s_debugInit = true;
 			// Init.
-			s_lines = (LineVertex*)level_alloc(sizeof(LineVertex) * c_maxLineCount * 2);
+			s_lines = (LineVertex*)level_allocTagged(sizeof(LineVertex) * c_maxLineCount * 2, REGION_TAG_RENDERER);
 			memset(s_lines, 0, sizeof(LineVertex) * c_maxLineCount * 2);
 			s_vertexBuffer.create(c_maxLineCount * 2, sizeof(LineVertex), c_lineAttrCount, c_lineAttrMapping, true, s_lines);
 
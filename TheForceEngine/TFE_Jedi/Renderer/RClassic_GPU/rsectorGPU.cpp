@@ -817,7 +817,7 @@ namespace TFE_Jedi
 			updateShaderSettings(true);
 
 			// Handles up to MAX_DISP_ITEMS sector quads in the view.
-			u32* indices = (u32*)level_alloc(sizeof(u32) * 6u * MAX_DISP_ITEMS);
+			u32* indices = (u32*)level_allocTagged(sizeof(u32) * 6u * MAX_DISP_ITEMS, REGION_TAG_RENDERER);
 			u32* index = indices;
 			for (u32 q = 0; q < MAX_DISP_ITEMS; q++, index += 6u)
 			{
@@ -848,11 +848,11 @@ namespace TFE_Jedi
 			m_levelInit = true;
 
 			// Let's just cache the current data.
-			s_cachedSectors = (GPUCachedSector*)level_alloc(sizeof(GPUCachedSector) * s_levelState.sectorCount);
+			s_cachedSectors = (GPUCachedSector*)level_allocTagged(sizeof(GPUCachedSector) * s_levelState.sectorCount, REGION_TAG_RENDERER);
 			memset(s_cachedSectors, 0, sizeof(GPUCachedSector) * s_levelState.sectorCount);
 
 			s_gpuSourceData.sectorSize = sizeof(Vec4f) * s_levelState.sectorCount * 2;
-			s_gpuSourceData.sectors = (Vec4f*)level_alloc(s_gpuSourceData.sectorSize);
+			s_gpuSourceData.sectors = (Vec4f*)level_allocTagged(s_gpuSourceData.sectorSize, REGION_TAG_RENDERER);
 			memset(s_gpuSourceData.sectors, 0, s_gpuSourceData.sectorSize);
 
 			s32 wallCount = 0;
@@ -879,7 +879,7 @@ namespace TFE_Jedi
 			}
 
 			s_gpuSourceData.wallSize = sizeof(Vec4f) * wallCount * 3;
-			s_gpuSourceData.walls = (Vec4f*)level_alloc(s_gpuSourceData.wallSize);
+			s_gpuSourceData.walls = (Vec4f*)level_allocTagged(s_gpuSourceData.wallSize, REGION_TAG_RENDERER);
 			memset(s_gpuSourceData.walls, 0, s_gpuSourceData.wallSize);
 
 			for (u32 s = 0; s < s_levelState.sectorCount; s++)
@@ -1008,6 +1008,7 @@ namespace TFE_Jedi
 			}
 			s_gpuFrame++;
 		}
+		texturepacker_streamUploads();
 
 		s_flushCache = JFALSE;
 		renderDebug_enable(s_enableDebug);
@@ -1497,27 +1498,70 @@ namespace TFE_Jedi
 		return false;
 	}
 
-	void clipSpriteToView(RSector* curSector, Vec3f posWS, WaxFrame* frame, void* basePtr, void* objPtr, bool fullbright, u32 portalInfo)
+	// Per-sector object candidates, these are gathered first so they can be culled against the frustum in one batch.
+	struct SpriteCandidate
 	{
-		if (!frame) { return; }
-		s_clipSector = curSector;
-		s_clipObjPos = posWS;
+		SecObject* obj;
+		WaxFrame* frame;
+		void* basePtr;
+		Vec3f posWS;
+	};
+
+	struct ModelCandidate
+	{
+		SecObject* obj;
+		Vec3f posWS;
+	};
+
+	// Culling inputs stored as structure of arrays, see frustum_quadsInside() and frustum_spheresInside().
+	// Spheres only use {x0, y0, z0} and x1 as the radius.
+	struct ObjectCullList
+	{
+		std::vector<f32> x0, y0, z0;
+		std::vector<f32> x1, y1, z1;
+		std::vector<u8>  inside;
+	};
+
+	static std::vector<SpriteCandidate> s_spriteCandidates;
+	static std::vector<ModelCandidate>  s_modelCandidates;
+	static ObjectCullList s_spriteCull;
+	static ObjectCullList s_modelCull;
 
+	// These only reallocate when the size is larger than any previous sector.
+	static void cullList_resize(ObjectCullList* list, size_t count)
+	{
+		list->x0.resize(count);
+		list->y0.resize(count);
+		list->z0.resize(count);
+		list->x1.resize(count);
+		list->y1.resize(count);
+		list->z1.resize(count);
+		list->inside.resize(count);
+	}
+
+	static void getSpriteCorners(Vec3f posWS, const WaxFrame* frame, Vec3f* corner0, Vec3f* corner1)
+	{
 		// Compute the (x,z) extents of the frame.
 		const f32 widthWS  = fixed16ToFloat(frame->widthWS);
 		const f32 heightWS = fixed16ToFloat(frame->heightWS);
 		const f32 fOffsetX = fixed16ToFloat(frame->offsetX);
 		const f32 fOffsetY = fixed16ToFloat(frame->offsetY);
 
-		Vec3f corner0 = { posWS.x - s_cameraRight.x*fOffsetX,  posWS.y + fOffsetY,   posWS.z - s_cameraRight.z*fOffsetX };
-		Vec3f corner1 = { corner0.x + s_cameraRight.x*widthWS, corner0.y - heightWS, corner0.z + s_cameraRight.z*widthWS };
+		*corner0 = { posWS.x - s_cameraRight.x*fOffsetX,  posWS.y + fOffsetY,   posWS.z - s_cameraRight.z*fOffsetX };
+		*corner1 = { corner0->x + s_cameraRight.x*widthWS, corner0->y - heightWS, corner0->z + s_cameraRight.z*widthWS };
+	}
+
+	// Note: the sprite has already been culled against the frustum, see addSectorObjects().
+	void clipSpriteToView(RSector* curSector, Vec3f posWS, WaxFrame* frame, Vec3f corner0, Vec3f corner1, void* basePtr, void* objPtr, bool fullbright, u32 portalInfo)
+	{
+		s_clipSector = curSector;
+		s_clipObjPos = posWS;
+
 		Vec2f points[] =
 		{
 			{ corner0.x, corner0.z },
 			{ corner1.x, corner1.z }
 		};
-		// Cull sprites outside of the view before clipping.
-		if (!frustum_quadInside(corner0, corner1)) { return; }
 
 		// Cull sprites too close to the camera.
 		// 2D culling to match the software.
@@ -1610,12 +1654,13 @@ namespace TFE_Jedi
 		const Vec2f floorOffset = { fixed16ToFloat(curSector->floorOffset.x), fixed16ToFloat(curSector->floorOffset.z) };
 		const Vec2f ceilOffset = { fixed16ToFloat(curSector->ceilOffset.x), fixed16ToFloat(curSector->ceilOffset.z) };
 
-		SecObject** objIter = curSector->objectList;
-		for (s32 i = 0; i < curSector->objectCount; objIter++)
+		// 1. Gather the sprite and model candidates.
+		s_spriteCandidates.clear();
+		s_modelCandidates.clear();
+		SecObject** objIter = curSector->objectDense;
+		for (s32 i = 0; i < curSector->objectCount; i++, objIter++)
 		{
 			SecObject* obj = *objIter;
-			if (!obj) { continue; }
-			i++;
 
 			if ((obj->flags & OBJ_FLAG_NEEDS_TRANSFORM) && obj->ptr)
 			{
@@ -1642,20 +1687,79 @@ namespace TFE_Jedi
 							WaxView* view = WAX_ViewPtr(wax, anim, 31 - angleDiff);
 							// And finally the frame from the current sequence.
 							WaxFrame* frame = WAX_FramePtr(wax, view, obj->frame & 31);
-							clipSpriteToView(curSector, posWS, frame, wax, obj, (obj->flags & OBJ_FLAG_FULLBRIGHT) != 0, portalInfo);
+							if (frame)
+							{
+								s_spriteCandidates.push_back({ obj, frame, wax, posWS });
+							}
 						}
 					}
-					else if (type == OBJ_TYPE_FRAME)
+					else if (type == OBJ_TYPE_FRAME && obj->fme)
 					{
-						clipSpriteToView(curSector, posWS, obj->fme, obj->fme, obj, (obj->flags & OBJ_FLAG_FULLBRIGHT) != 0, portalInfo);
+						s_spriteCandidates.push_back({ obj, obj->fme, obj->fme, posWS });
 					}
 				}
 				else if (type == OBJ_TYPE_3D)
 				{
-					model_add(obj, obj->model, posWS, obj->transform, ambient, floorOffset, ceilOffset, portalInfo);
+					s_modelCandidates.push_back({ obj, posWS });
 				}
 			}
 		}
+
+		// 2. Cull sprites outside of the view before clipping.
+		const s32 spriteCount = (s32)s_spriteCandidates.size();
+		if (spriteCount)
+		{
+			cullList_resize(&s_spriteCull, spriteCount);
+			for (s32 i = 0; i < spriteCount; i++)
+			{
+				Vec3f corner0, corner1;
+				getSpriteCorners(s_spriteCandidates[i].posWS, s_spriteCandidates[i].frame, &corner0, &corner1);
+				s_spriteCull.x0[i] = corner0.x;
+				s_spriteCull.y0[i] = corner0.y;
+				s_spriteCull.z0[i] = corner0.z;
+				s_spriteCull.x1[i] = corner1.x;
+				s_spriteCull.y1[i] = corner1.y;
+				s_spriteCull.z1[i] = corner1.z;
+			}
+			frustum_quadsInside(spriteCount, s_spriteCull.x0.data(), s_spriteCull.y0.data(), s_spriteCull.z0.data(),
+				s_spriteCull.x1.data(), s_spriteCull.y1.data(), s_spriteCull.z1.data(), s_spriteCull.inside.data());
+
+			for (s32 i = 0; i < spriteCount; i++)
+			{
+				if (!s_spriteCull.inside[i]) { continue; }
+
+				const SpriteCandidate* sprite = &s_spriteCandidates[i];
+				const Vec3f corner0 = { s_spriteCull.x0[i], s_spriteCull.y0[i], s_spriteCull.z0[i] };
+				const Vec3f corner1 = { s_spriteCull.x1[i], s_spriteCull.y1[i], s_spriteCull.z1[i] };
+				clipSpriteToView(curSector, sprite->posWS, sprite->frame, corner0, corner1, sprite->basePtr, sprite->obj,
+					(sprite->obj->flags & OBJ_FLAG_FULLBRIGHT) != 0, portalInfo);
+			}
+		}
+
+		// 3. Cull models using their bounding spheres.
+		const s32 modelCount = (s32)s_modelCandidates.size();
+		if (modelCount)
+		{
+			cullList_resize(&s_modelCull, modelCount);
+			for (s32 i = 0; i < modelCount; i++)
+			{
+				const f32 radius = model_getRadius(s_modelCandidates[i].obj->model);
+				s_modelCull.x0[i] = s_modelCandidates[i].posWS.x;
+				s_modelCull.y0[i] = s_modelCandidates[i].posWS.y;
+				s_modelCull.z0[i] = s_modelCandidates[i].posWS.z;
+				// Models without GPU data are skipped by model_add() anyway, so they are never culled here.
+				s_modelCull.x1[i] = radius < 0.0f ? FLT_MAX : radius;
+			}
+			frustum_spheresInside(modelCount, s_modelCull.x0.data(), s_modelCull.y0.data(), s_modelCull.z0.data(), s_modelCull.x1.data(), s_modelCull.inside.data());
+
+			for (s32 i = 0; i < modelCount; i++)
+			{
+				if (!s_modelCull.inside[i]) { continue; }
+
+				SecObject* obj = s_modelCandidates[i].obj;
+				model_add(obj, obj->model, s_modelCandidates[i].posWS, obj->transform, ambient, floorOffset, ceilOffset, portalInfo);
+			}
+		}
 	}
 		
 	void traverseSector(RSector* curSector, RSector* prevSector, RWall* portalWall, s32 prevPortalId, s32& level, u32& uploadFlags, Vec2f p0, Vec2f p1)
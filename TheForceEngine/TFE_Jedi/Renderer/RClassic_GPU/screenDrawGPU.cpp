@@ -170,7 +170,8 @@ namespace TFE_Jedi
 				{
 					texturepacker_pack(callbacks[i], POOL_GAME);
 				}
-				texturepacker_commit();
+				// The HUD textures are needed right away.
+				texturepacker_commit(true);
 				texturepacker_reserveCommitedPages(texturePacker);
 			}
 		}
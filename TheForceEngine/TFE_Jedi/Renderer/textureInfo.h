@@ -47,6 +47,7 @@ namespace TFE_Jedi
 		};
 		void* basePtr = nullptr;	// used for WAX/Frame.
 		s32 sortKey = 0;			// Calculated by Texture Packer.
+		s32 listIndex = 0;			// Index before sorting, calculated by Texture Packer.
 	};
 	typedef std::vector<TextureInfo> TextureInfoList;
 	typedef bool(*TextureListCallback)(TextureInfoList& texList, AssetPool pool);
@@ -7,10 +7,14 @@
 #include <TFE_Game/igame.h>
 #include <TFE_System/profiler.h>
 #include <TFE_FrontEndUI/console.h>
+#include <TFE_FileSystem/paths.h>
+#include <TFE_FileSystem/fileutil.h>
 #include <TFE_Jedi/Serialization/serialization.h>
 #include <stdarg.h>
 #include <tuple>
 #include <vector>
+#include <map>
+#include <string>
 
 using namespace TFE_DarkForces;
 using namespace TFE_Memory;
@@ -28,11 +32,11 @@ struct TaskContext
 	s32 ip[TASK_MAX_LEVELS];				// Current instruction pointer (IP) for each level of recursion.
 	TaskFunc callstack[TASK_MAX_LEVELS];	// Funcion pointer for each level of recursion.
 
-	u8* stackMem;		// starts out null, can point to the block if ever needed.
-	u32 stackOffset;	// where in the stack we are.
+	u32 stackOffset;	// total local memory in use across all levels.
 
-	u8* stackPtr[TASK_MAX_LEVELS];
+	u8* stackPtr[TASK_MAX_LEVELS];		// local memory for each level, allocated from the stack pool matching its size.
 	u32 stackSize[TASK_MAX_LEVELS];
+	u8  stackClass[TASK_MAX_LEVELS];	// stack pool each level was allocated from.
 	u8  delayedCall[TASK_MAX_LEVELS];
 
 	s32 level;
@@ -63,6 +67,15 @@ struct Task
 
 	// Timing.
 	Tick nextTick;
+	s32 heapId;				// Schedule heap holding the task, -1 if the task is sleeping or not scheduled.
+	s32 heapIndex;			// Index in that heap.
+
+	// Position in the order the task list is walked, see "Task schedule" below.
+	Task* orderPrev;
+	Task* orderNext;
+	u64 orderKey;
+	u32 orderGen;
+	s32 profileIndex;		// Index into the task profiles, -1 until the task is run with profiling enabled.
 };
 
 namespace TFE_Jedi
@@ -72,12 +85,20 @@ namespace TFE_Jedi
 		TASK_CHUNK_SIZE = 256,
 		TASK_PREALLOCATED_CHUNKS = 1,
 
-		TASK_STACK_SIZE = 32 * 1024,	// 32KB of stack memory.
-		TASK_STACK_CHUNK_SIZE = 64,		// 2MB of memory for 64 tasks with stack memory.
+		TASK_STACK_SIZE = 32 * 1024,	// 32KB of stack memory, the largest pool which handles any overflow.
+
+		// Local memory is allocated per level from power of 2 pools: 32 bytes, 64 bytes, ... TASK_STACK_SIZE.
+		// Most local contexts are tens of bytes, so most tasks only ever touch the smallest pools.
+		TASK_STACK_MIN_SHIFT = 5,
+		TASK_STACK_MAX_SHIFT = 15,
+		TASK_STACK_CLASS_COUNT = TASK_STACK_MAX_SHIFT - TASK_STACK_MIN_SHIFT + 1,
+		TASK_STACK_CHUNK_BYTES = 64 * 1024,	// Target chunk size for each pool.
+		TASK_STACK_MIN_CHUNK_SIZE = 8,		// 256KB chunks for the largest pool.
 	};
+	static_assert((1 << TASK_STACK_MAX_SHIFT) == TASK_STACK_SIZE, "The largest stack pool must match TASK_STACK_SIZE.");
 
 	ChunkedArray* s_tasks = nullptr;
-	ChunkedArray* s_stackBlocks = nullptr;
+	ChunkedArray* s_stackPools[TASK_STACK_CLASS_COUNT] = { nullptr };
 	s32 s_taskCount = 0;
 
 	Task  s_rootTask;
@@ -93,18 +114,90 @@ namespace TFE_Jedi
 	static JBool s_taskSystemPaused = JFALSE;
 	static bool s_enableTimeLimiter = true;
 	static Task* s_taskPauseTask = nullptr;
+	static s32 s_frameVisitedTaskCount = 0;
+	// With a fixed step, the game queues each step from its own clock and the tasks only run when a step is queued.
+	static JBool s_fixedStep = JFALSE;
+	static s32 s_stepsQueued = 0;
+	static TaskStepFunc s_beginStepFunc = nullptr;
+
+	// Task schedule: tasks waiting on a future tick are kept in a heap keyed on nextTick, and tasks that can run (plus the
+	// framebreak tasks, which are always selected) are kept in heaps keyed on their position in the task list walk order.
+	// The "ahead" heap holds the tasks after the current walk position, the "behind" heap the ones that have been passed.
+	// Sleeping tasks are in none of the heaps until they are woken up.
+	enum TaskHeapId
+	{
+		TASK_HEAP_NONE = -1,
+		TASK_HEAP_TIMER = 0,
+		TASK_HEAP_DUE0,
+		TASK_HEAP_DUE1,
+		TASK_HEAP_COUNT
+	};
+	static std::vector<Task*> s_taskHeaps[TASK_HEAP_COUNT];
+	static s32 s_dueAhead = TASK_HEAP_DUE0;
+	static u64 s_dueSplitKey = 0;		// Walk order key the due heaps are split at, 0 is the start of the walk.
+	static Tick s_dueTick = 0;			// s_curTick when the due tasks were last collected.
+	static Task* s_orderFirst = nullptr;
+	static u32 s_orderGen = 0;
+
+	// Opt-in per-task timing, keyed by task name so that every instance of a task (such as each actor) is accumulated together.
+	struct TaskProfile
+	{
+		char name[32];
+		// Current frame.
+		u32 callCount;
+		f64 time;
+		f64 maxCallTime;
+		// Previous frame, safe to read while the next frame is being run.
+		u32 prevCallCount;
+		f64 prevTime;
+		f64 prevMaxCallTime;
+		// Rolling averages and totals since the profile was cleared.
+		f64 callCountAve;
+		f64 timeAve;
+		f64 peakTime;
+		u64 totalCalls;
+		f64 totalTime;
+	};
+	static bool s_enableTaskProfiler = false;
+	static std::vector<TaskProfile> s_taskProfiles;
+	static std::map<std::string, s32> s_taskProfileMap;
+	static u64 s_taskProfileFrames = 0;
 
 	void selectNextTask();
+	void task_runFrame();
+	u8*  stack_alloc(TaskContext* context, s32 level, u32 size);
+	void stack_free(TaskContext* context, s32 level);
+	void schedule_update(Task* task);
+	void schedule_push(s32 heapId, Task* task);
+	void schedule_remove(Task* task);
+	void schedule_collectDue();
+	void schedule_splitDue(u64 splitKey);
+	void schedule_reset();
+	void order_insert(Task* task, Task* prev, Task* next);
+	void order_remove(Task* task);
+	Task* order_firstInSubtree(Task* task);
+	void taskProfile_runFunc(Task* task, TaskFunc runFunc);
+	void taskProfile_endFrame();
+	void taskProfile_dumpCmd(const ConsoleArgList& args);
+	void taskProfile_clearCmd(const ConsoleArgList& args);
 
 	void createRootTask()
 	{
 		s_tasks = createChunkedArray(sizeof(Task), TASK_CHUNK_SIZE, TASK_PREALLOCATED_CHUNKS, s_gameRegion);
-		s_stackBlocks = createChunkedArray(TASK_STACK_SIZE, TASK_STACK_CHUNK_SIZE, TASK_PREALLOCATED_CHUNKS, s_gameRegion);
+		for (s32 i = 0; i < TASK_STACK_CLASS_COUNT; i++)
+		{
+			const u32 size = 1u << (TASK_STACK_MIN_SHIFT + i);
+			const u32 elemPerChunk = max(u32(TASK_STACK_MIN_CHUNK_SIZE), u32(TASK_STACK_CHUNK_BYTES) / size);
+			s_stackPools[i] = createChunkedArray(size, elemPerChunk, TASK_PREALLOCATED_CHUNKS, s_gameRegion);
+		}
 
 		s_rootTask = { 0 };
 		s_rootTask.prev = &s_rootTask;
 		s_rootTask.next = &s_rootTask;
 		s_rootTask.nextTick = TASK_SLEEP;
+		s_rootTask.heapId = TASK_HEAP_NONE;
+		s_rootTask.profileIndex = -1;
+		schedule_reset();
 
 		s_taskIter = &s_rootTask;
 		s_curTask = &s_rootTask;
@@ -112,6 +205,9 @@ namespace TFE_Jedi
 		s_frameActiveTaskCount = 0;
 
 		CVAR_BOOL(s_enableTimeLimiter, "d_enableTaskTimeLimiter", CVFLAG_DO_NOT_SERIALIZE, "Enable the task time limiter.");
+		CVAR_BOOL(s_enableTaskProfiler, "d_enableTaskProfiler", CVFLAG_DO_NOT_SERIALIZE, "Time each task by name, shown in the Profiler View and saved with 'taskProfileDump'.");
+		CCMD("taskProfileDump", taskProfile_dumpCmd, 0, "Save the per-task timing recorded with d_enableTaskProfiler to TaskProfiles/<name>.csv. Example: taskProfileDump secbase");
+		CCMD("taskProfileClear", taskProfile_clearCmd, 0, "Reset the per-task timing.");
 	}
 
 	Task* createSubTask(const char* name, TaskFunc func, TaskFunc localRunFunc)
@@ -128,6 +224,9 @@ namespace TFE_Jedi
 		strcpy(newTask->name, name);
 
 		// Insert newTask at the head of the subtask list in the current "mainline" task.
+		// It is walked before everything in the previous head's subtree, or before the parent if there was none.
+		Task* orderNext = s_curTask->subtaskNext ? order_firstInSubtree(s_curTask->subtaskNext) : s_curTask;
+		order_insert(newTask, orderNext->orderPrev, orderNext);
 		newTask->next = s_curTask->subtaskNext;
 		newTask->prev = nullptr;
 		if (s_curTask->subtaskNext)
@@ -145,6 +244,9 @@ namespace TFE_Jedi
 		newTask->framebreak = JFALSE;
 		
 		newTask->nextTick = 0;
+		newTask->heapId = TASK_HEAP_NONE;
+		newTask->profileIndex = -1;
+		schedule_update(newTask);
 
 		newTask->context = { 0 };
 		newTask->context.callstack[0] = func;
@@ -174,6 +276,8 @@ namespace TFE_Jedi
 		}
 		newTask->prev = s_taskIter;
 		s_taskIter->next = newTask;
+		// Main tasks have no subtasks yet, so the task is walked right after 's_taskIter'.
+		order_insert(newTask, s_taskIter, s_taskIter->orderNext);
 		
 		newTask->subtaskNext = nullptr;
 		newTask->subtaskParent = nullptr;
@@ -186,7 +290,9 @@ namespace TFE_Jedi
 		newTask->localRunFunc = localRunFunc;
 		newTask->context.level = TASK_INIT_LEVEL;
 		newTask->nextTick = s_curTick;
-
+		newTask->heapId = TASK_HEAP_NONE;
+		newTask->profileIndex = -1;
+		schedule_update(newTask);
 		return newTask;
 	}
 	
@@ -195,12 +301,18 @@ namespace TFE_Jedi
 		SERIALIZE(SaveVersionInit, task->context.ip[0], 0);
 		SERIALIZE(SaveVersionInit, task->context.stackSize[0], 0);
 		SERIALIZE(SaveVersionInit, task->nextTick, 0);
-		if (serialization_getMode() == SMODE_READ && !task->context.stackMem)
+		if (serialization_getMode() == SMODE_READ)
 		{
-			task->context.stackMem = (u8*)allocFromChunkedArray(s_stackBlocks);
-			memset(task->context.stackMem, 0, sizeof(u32) * TASK_MAX_LEVELS);
+			schedule_update(task);
+		}
+		if (serialization_getMode() == SMODE_READ)
+		{
+			// The local memory callback may need memory even if nothing was allocated when saving,
+			// so fall back to the largest pool in that case, matching the original fixed size stack.
+			const u32 size = task->context.stackSize[0] ? task->context.stackSize[0] : TASK_STACK_SIZE;
+			stack_free(&task->context, 0);
+			stack_alloc(&task->context, 0, size);
 			task->context.stackOffset = 0;
-			task->context.stackPtr[0] = task->context.stackMem;
 		}
 		SERIALIZE(SaveVersionInit, task->context.stackOffset, 0);
 		if (localMemCallback)
@@ -254,8 +366,14 @@ namespace TFE_Jedi
 			parent->subtaskNext = task->next;
 		}
 		
+		schedule_remove(task);
+		order_remove(task);
+
 		// Free any memory allocated for the local context.
-		freeToChunkedArray(s_stackBlocks, task->context.stackMem);
+		for (s32 i = 0; i < TASK_MAX_LEVELS; i++)
+		{
+			stack_free(&task->context, i);
+		}
 		// Finally free the task itself from the chunked array.
 		freeToChunkedArray(s_tasks, task);
 		s_taskCount--;
@@ -267,6 +385,9 @@ namespace TFE_Jedi
 		s_rootTask.prev = &s_rootTask;
 		s_rootTask.next = &s_rootTask;
 		s_rootTask.nextTick = TASK_SLEEP;
+		s_rootTask.heapId = TASK_HEAP_NONE;
+		s_rootTask.profileIndex = -1;
+		schedule_reset();
 
 		s_taskIter = &s_rootTask;
 		s_curTask = &s_rootTask;
@@ -280,7 +401,11 @@ namespace TFE_Jedi
 	void task_freeAll()
 	{
 		chunkedArrayClear(s_tasks);
-		chunkedArrayClear(s_stackBlocks);
+		for (s32 i = 0; i < TASK_STACK_CLASS_COUNT; i++)
+		{
+			chunkedArrayClear(s_stackPools[i]);
+		}
+		schedule_reset();
 
 		s_curTask    = nullptr;
 		s_curContext = nullptr;
@@ -290,12 +415,15 @@ namespace TFE_Jedi
 	void task_shutdown()
 	{
 		freeChunkedArray(s_tasks);
-		freeChunkedArray(s_stackBlocks);
+		for (s32 i = 0; i < TASK_STACK_CLASS_COUNT; i++)
+		{
+			freeChunkedArray(s_stackPools[i]);
+			s_stackPools[i] = nullptr;
+		}
 
 		s_curTask     = nullptr;
 		s_taskIter    = nullptr;
 		s_tasks       = nullptr;
-		s_stackBlocks = nullptr;
 		s_curContext  = nullptr;
 		s_taskCount   = 0;
 
@@ -304,16 +432,23 @@ namespace TFE_Jedi
 		s_frameActiveTaskCount = 0;
 		s_taskSystemPaused = JFALSE;
 		s_taskPauseTask = nullptr;
+		schedule_reset();
+		for (s32 i = 0; i < TASK_HEAP_COUNT; i++)
+		{
+			std::vector<Task*>().swap(s_taskHeaps[i]);
+		}
 	}
 
 	void task_makeActive(Task* task)
 	{
 		task->nextTick = 0;
+		schedule_update(task);
 	}
 
 	void task_setNextTick(Task* task, Tick tick)
 	{
 		task->nextTick = tick;
+		schedule_update(task);
 	}
 
 	void task_setUserData(Task* task, void* data)
@@ -387,58 +522,54 @@ namespace TFE_Jedi
 			// Return the stack memory allocated for this level.
 			s_curContext->stackOffset -= s_curContext->stackSize[level];
 			assert(s_curContext->stackOffset >= 0 && s_curContext->stackOffset < TASK_STACK_SIZE);
-			s_curContext->stackPtr[level] = nullptr;
+			stack_free(s_curContext, level);
 			s_curContext->stackSize[level] = 0;
 		}
 	}
 
+	// The original code walks the task list from the current task until it finds one that can run or a framebreak task:
+	//  * Go to the next task
+	//  * Check to see if there are sub-tasks
+	//  * If so, the assign current to the sub-task.
+	//  * Execute the task.
+	//  * Once we are on the last sub-task, then go back to the parent.
+	//  * Once the parent executes, then we move on to parent->next and start all over.
+	// TFE: The tasks that walk would stop at are kept in the due heaps ordered by their walk position, so the next one
+	// is taken from the heap instead, which selects the same task without visiting the ones that cannot run.
 	void selectNextTask()
 	{
-		// Find the next task to run.
-		Task* task = s_curTask;
-		while (1)
+		schedule_collectDue();
+
+		// Tasks up to and including the current one have been passed.
+		const u64 curKey = (s_curTask && s_curTask->orderGen == s_orderGen) ? s_curTask->orderKey : 0;
+		if (curKey < s_dueSplitKey)
 		{
-			//////////////////////////////////////////////////////////////////////////////////////////
-			// Execution:
-			//  * Go to the next task
-			//  * Check to see if there are sub-tasks
-			//  * If so, the assign current to the sub-task.
-			//  * Execute the task.
-			//  * Once we are on the last sub-task, then go back to the parent.
-			//  * Once the parent executes, then we move on to parent->next and start all over.
-			if (task->next)
-			{
-				// Move the to the next task.
-				task = task->next;
-				// If the task has sub-tasks, loop until we find the last one.
-				// This is usually only one deep.
-				while (task->subtaskNext)
-				{
-					task = task->subtaskNext;
-				}
-				// Then execute the task.
-				if (task->nextTick <= s_curTick || task->framebreak)
-				{
-					s_currentMsg = MSG_RUN_TASK;
-					s_curTask = task;
-					return;
-				}
-			}
-			else if (task->subtaskParent)
-			{
-				// Otherwise, try to execute the parent.
-				task = task->subtaskParent;
-				if (task->nextTick <= s_curTick || task->framebreak)
-				{
-					s_currentMsg = MSG_RUN_TASK;
-					s_curTask = task;
-					return;
-				}
-			}
-			else
-			{
-				break;
-			}
+			schedule_splitDue(curKey);
+		}
+		s_dueSplitKey = curKey;
+
+		std::vector<Task*>& ahead = s_taskHeaps[s_dueAhead];
+		const s32 behindId = (s_dueAhead == TASK_HEAP_DUE0) ? TASK_HEAP_DUE1 : TASK_HEAP_DUE0;
+		while (!ahead.empty() && ahead[0]->orderKey <= curKey)
+		{
+			s_frameVisitedTaskCount++;
+			Task* task = ahead[0];
+			schedule_remove(task);
+			schedule_push(behindId, task);
+		}
+		// Past the end of the list, the walk starts over from the beginning.
+		if (ahead.empty())
+		{
+			s_dueAhead = behindId;
+			s_dueSplitKey = 0;
+		}
+
+		if (!s_taskHeaps[s_dueAhead].empty())
+		{
+			s_frameVisitedTaskCount++;
+			s_currentMsg = MSG_RUN_TASK;
+			s_curTask = s_taskHeaps[s_dueAhead][0];
+			return;
 		}
 
 		// If no selection is possible, assign the first task.
@@ -508,6 +639,7 @@ namespace TFE_Jedi
 
 		// Update the current tick based on the delay.
 		s_curTask->nextTick = (delay < TASK_SLEEP) ? s_curTick + delay : delay;
+		schedule_update(s_curTask);
 		
 		// Find the next task to run.
 		selectNextTask();
@@ -531,9 +663,25 @@ namespace TFE_Jedi
 				return JFALSE;
 			}
 		}
+		if (s_taskCount && s_fixedStep && s_stepsQueued <= 0)
+		{
+			return JFALSE;
+		}
 		return JTRUE;
 	}
 
+	void task_setFixedStep(JBool enable, TaskStepFunc beginStep)
+	{
+		s_fixedStep = enable;
+		s_stepsQueued = 0;
+		s_beginStepFunc = enable ? beginStep : nullptr;
+	}
+
+	void task_setQueuedSteps(s32 count)
+	{
+		s_stepsQueued = max(0, count);
+	}
+
 	void task_updateTime()
 	{
 		s_prevTime = TFE_System::getTime();
@@ -556,9 +704,42 @@ namespace TFE_Jedi
 		{
 			return JFALSE;
 		}
+		if (s_fixedStep && s_stepsQueued <= 0)
+		{
+			return JFALSE;
+		}
 		s_prevTime = time;
+
+		if (!s_fixedStep)
+		{
+			task_runFrame();
+			return JTRUE;
+		}
+
+		// Fixed step mode: run the tasks once per queued step, so each step sees exactly one step of game time.
+		while (s_stepsQueued > 0 && s_taskCount)
+		{
+			s_stepsQueued--;
+			if (s_beginStepFunc)
+			{
+				s_beginStepFunc();
+			}
+			task_runFrame();
+		}
+		s_stepsQueued = 0;
+		return JTRUE;
+	}
+
+	// Run the tasks until the "framebreak" task is hit.
+	void task_runFrame()
+	{
 		s_currentMsg = MSG_RUN_TASK;
 		s_frameActiveTaskCount = 0;
+		s_frameVisitedTaskCount = 0;
+		if (s_enableTaskProfiler)
+		{
+			taskProfile_endFrame();
+		}
 
 		// Return if the task system is paused.
 		if (s_taskSystemPaused)
@@ -577,11 +758,11 @@ namespace TFE_Jedi
 
 					if (runFunc)
 					{
-						runFunc(s_currentMsg);
+						taskProfile_runFunc(s_curTask, runFunc);
 					}
 				}
 			}
-			return JTRUE;
+			return;
 		}
 
 		// Keep processing tasks until the "framebreak" task is hit.
@@ -605,7 +786,7 @@ namespace TFE_Jedi
 
 				if (runFunc)
 				{
-					runFunc(s_currentMsg);
+					taskProfile_runFunc(s_curTask, runFunc);
 				}
 			}
 			else
@@ -618,7 +799,6 @@ namespace TFE_Jedi
 				break;
 			}
 		}
-		return JTRUE;
 	}
 
 	void task_setDefaults()
@@ -628,6 +808,428 @@ namespace TFE_Jedi
 
 		TFE_COUNTER(s_taskCount, "Task Count");
 		TFE_COUNTER(s_frameActiveTaskCount, "Active Tasks");
+		TFE_COUNTER(s_frameVisitedTaskCount, "Visited Tasks");
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// Task profiler
+	//////////////////////////////////////////////////////////////////////
+	s32 taskProfile_getIndex(Task* task)
+	{
+		if (task->profileIndex >= 0) { return task->profileIndex; }
+
+		std::map<std::string, s32>::iterator iProfile = s_taskProfileMap.find(task->name);
+		if (iProfile != s_taskProfileMap.end())
+		{
+			task->profileIndex = iProfile->second;
+			return task->profileIndex;
+		}
+
+		TaskProfile profile = { 0 };
+		strcpy(profile.name, task->name);
+		task->profileIndex = (s32)s_taskProfiles.size();
+		s_taskProfiles.push_back(profile);
+		s_taskProfileMap[task->name] = task->profileIndex;
+		return task->profileIndex;
+	}
+
+	// Run the task function, timing it if profiling is enabled.
+	// Times are inclusive, so a task that runs another task with task_runAndReturn() includes that time.
+	void taskProfile_runFunc(Task* task, TaskFunc runFunc)
+	{
+		if (!s_enableTaskProfiler)
+		{
+			runFunc(s_currentMsg);
+			return;
+		}
+
+		// Get the index before running the function since the task may be freed by it.
+		const s32 index = taskProfile_getIndex(task);
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		runFunc(s_currentMsg);
+		const f64 callTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		TaskProfile* profile = &s_taskProfiles[index];
+		profile->callCount++;
+		profile->time += callTime;
+		profile->maxCallTime = max(profile->maxCallTime, callTime);
+	}
+
+	void taskProfile_endFrame()
+	{
+		// Use the same blend as the zone averages in TFE_Profiler.
+		const f64 expBlend = 0.99;
+		const size_t count = s_taskProfiles.size();
+		TaskProfile* profile = s_taskProfiles.data();
+		for (size_t i = 0; i < count; i++, profile++)
+		{
+			profile->prevCallCount = profile->callCount;
+			profile->prevTime = profile->time;
+			profile->prevMaxCallTime = profile->maxCallTime;
+
+			profile->callCountAve = expBlend * profile->callCountAve + (1.0 - expBlend) * f64(profile->callCount);
+			profile->timeAve = expBlend * profile->timeAve + (1.0 - expBlend) * profile->time;
+			profile->peakTime = max(profile->peakTime, profile->time);
+			profile->totalCalls += profile->callCount;
+			profile->totalTime += profile->time;
+
+			profile->callCount = 0;
+			profile->time = 0.0;
+			profile->maxCallTime = 0.0;
+		}
+		s_taskProfileFrames++;
+	}
+
+	void task_enableProfiling(JBool enable)
+	{
+		s_enableTaskProfiler = enable != JFALSE;
+	}
+
+	JBool task_isProfilingEnabled()
+	{
+		return s_enableTaskProfiler ? JTRUE : JFALSE;
+	}
+
+	// Reset the timing but keep the entries, since tasks hold indices into the list.
+	void task_clearProfile()
+	{
+		const size_t count = s_taskProfiles.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			TaskProfile cleared = { 0 };
+			strcpy(cleared.name, s_taskProfiles[i].name);
+			s_taskProfiles[i] = cleared;
+		}
+		s_taskProfileFrames = 0;
+	}
+
+	u32 task_getProfileCount()
+	{
+		return (u32)s_taskProfiles.size();
+	}
+
+	void task_getProfileInfo(u32 index, TaskProfileInfo* info)
+	{
+		if (index >= (u32)s_taskProfiles.size()) { return; }
+
+		const TaskProfile* profile = &s_taskProfiles[index];
+		info->name = profile->name;
+		info->callCount = profile->prevCallCount;
+		info->timeInFrame = profile->prevTime * 1000000.0;
+		info->maxCallTime = profile->prevMaxCallTime * 1000000.0;
+		info->callCountAve = profile->callCountAve;
+		info->timeAve = profile->timeAve * 1000000.0;
+		info->peakTime = profile->peakTime * 1000000.0;
+		info->totalCalls = profile->totalCalls;
+		info->totalTime = profile->totalTime * 1000000.0;
+	}
+
+	bool task_writeProfile(const char* path)
+	{
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Task", "Cannot write task profile '%s'.", path);
+			return false;
+		}
+
+		// Times are in microseconds.
+		file.writeString("Task,Frames,Total Calls,Total Time,Time Per Frame,Calls Per Frame,Rolling Time Per Frame,Rolling Calls Per Frame,Peak Frame Time,Last Frame Time,Last Frame Calls,Last Frame Max Call\r\n");
+		const f64 frameScale = s_taskProfileFrames ? 1.0 / f64(s_taskProfileFrames) : 0.0;
+		const size_t count = s_taskProfiles.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			const TaskProfile* profile = &s_taskProfiles[i];
+			file.writeString("%s,%llu,%llu,%0.3f,%0.3f,%0.3f,%0.3f,%0.3f,%0.3f,%0.3f,%u,%0.3f\r\n", profile->name, (unsigned long long)s_taskProfileFrames,
+				(unsigned long long)profile->totalCalls, profile->totalTime * 1000000.0, profile->totalTime * frameScale * 1000000.0, f64(profile->totalCalls) * frameScale,
+				profile->timeAve * 1000000.0, profile->callCountAve, profile->peakTime * 1000000.0, profile->prevTime * 1000000.0, profile->prevCallCount,
+				profile->prevMaxCallTime * 1000000.0);
+		}
+		file.close();
+		return true;
+	}
+
+	// Save the per-task timing as CSV, profiling must be enabled first with "d_enableTaskProfiler true".
+	void taskProfile_dumpCmd(const ConsoleArgList& args)
+	{
+		if (s_taskProfiles.empty())
+		{
+			TFE_Console::addToHistory("No task timing has been recorded, enable it with 'd_enableTaskProfiler true'.");
+			return;
+		}
+
+		char path[TFE_MAX_PATH];
+		TFE_Paths::appendPath(PATH_USER_DOCUMENTS, "TaskProfiles/", path);
+		FileUtil::makeDirectory(path);
+		sprintf(path + strlen(path), "%s.csv", args.size() >= 2 ? args[1].c_str() : "taskProfile");
+		if (task_writeProfile(path))
+		{
+			char res[TFE_MAX_PATH + 64];
+			sprintf(res, "Saved the timing for %u tasks to '%s'.", task_getProfileCount(), path);
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	void taskProfile_clearCmd(const ConsoleArgList& args)
+	{
+		task_clearProfile();
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// Task schedule
+	//////////////////////////////////////////////////////////////////////
+	bool schedule_less(s32 heapId, const Task* a, const Task* b)
+	{
+		return (heapId == TASK_HEAP_TIMER) ? a->nextTick < b->nextTick : a->orderKey < b->orderKey;
+	}
+
+	void schedule_swap(std::vector<Task*>& heap, s32 a, s32 b)
+	{
+		std::swap(heap[a], heap[b]);
+		heap[a]->heapIndex = a;
+		heap[b]->heapIndex = b;
+	}
+
+	void schedule_siftUp(s32 heapId, s32 index)
+	{
+		std::vector<Task*>& heap = s_taskHeaps[heapId];
+		while (index > 0)
+		{
+			const s32 parent = (index - 1) >> 1;
+			if (!schedule_less(heapId, heap[index], heap[parent])) { break; }
+			schedule_swap(heap, parent, index);
+			index = parent;
+		}
+	}
+
+	void schedule_siftDown(s32 heapId, s32 index)
+	{
+		std::vector<Task*>& heap = s_taskHeaps[heapId];
+		const s32 count = (s32)heap.size();
+		while (1)
+		{
+			const s32 left = index * 2 + 1;
+			const s32 right = left + 1;
+			s32 smallest = index;
+			if (left < count && schedule_less(heapId, heap[left], heap[smallest])) { smallest = left; }
+			if (right < count && schedule_less(heapId, heap[right], heap[smallest])) { smallest = right; }
+			if (smallest == index) { break; }
+			schedule_swap(heap, smallest, index);
+			index = smallest;
+		}
+	}
+
+	// Tasks orphaned by task_reset() keep a stale index, so check that the task is actually in the heap.
+	bool schedule_contains(Task* task)
+	{
+		if (task->heapId < 0 || task->heapId >= TASK_HEAP_COUNT) { return false; }
+		const std::vector<Task*>& heap = s_taskHeaps[task->heapId];
+		return task->heapIndex >= 0 && task->heapIndex < (s32)heap.size() && heap[task->heapIndex] == task;
+	}
+
+	void schedule_push(s32 heapId, Task* task)
+	{
+		std::vector<Task*>& heap = s_taskHeaps[heapId];
+		task->heapId = heapId;
+		task->heapIndex = (s32)heap.size();
+		heap.push_back(task);
+		schedule_siftUp(heapId, task->heapIndex);
+	}
+
+	void schedule_remove(Task* task)
+	{
+		if (!schedule_contains(task))
+		{
+			task->heapId = TASK_HEAP_NONE;
+			return;
+		}
+		const s32 heapId = task->heapId;
+		const s32 index = task->heapIndex;
+		std::vector<Task*>& heap = s_taskHeaps[heapId];
+
+		const s32 last = (s32)heap.size() - 1;
+		if (index != last)
+		{
+			schedule_swap(heap, index, last);
+		}
+		heap.pop_back();
+		task->heapId = TASK_HEAP_NONE;
+
+		if (index != last)
+		{
+			schedule_siftUp(heapId, index);
+			schedule_siftDown(heapId, index);
+		}
+	}
+
+	bool schedule_isDue(const Task* task)
+	{
+		return task->heapId == TASK_HEAP_DUE0 || task->heapId == TASK_HEAP_DUE1;
+	}
+
+	void schedule_pushDue(Task* task)
+	{
+		const s32 behindId = (s_dueAhead == TASK_HEAP_DUE0) ? TASK_HEAP_DUE1 : TASK_HEAP_DUE0;
+		schedule_push(task->orderKey > s_dueSplitKey ? s_dueAhead : behindId, task);
+	}
+
+	// Call whenever task->nextTick changes.
+	void schedule_update(Task* task)
+	{
+		// Tasks orphaned by task_reset() are no longer part of the walk.
+		if (task->orderGen != s_orderGen) { return; }
+
+		const bool due = task->framebreak || task->nextTick <= s_curTick;
+		if (due)
+		{
+			if (schedule_contains(task) && schedule_isDue(task)) { return; }
+			schedule_remove(task);
+			schedule_pushDue(task);
+		}
+		else if (task->nextTick == TASK_SLEEP)
+		{
+			// Sleeping tasks are only woken up by task_makeActive() or task_setNextTick().
+			schedule_remove(task);
+		}
+		else if (schedule_contains(task) && task->heapId == TASK_HEAP_TIMER)
+		{
+			schedule_siftUp(TASK_HEAP_TIMER, task->heapIndex);
+			schedule_siftDown(TASK_HEAP_TIMER, task->heapIndex);
+		}
+		else
+		{
+			schedule_remove(task);
+			schedule_push(TASK_HEAP_TIMER, task);
+		}
+	}
+
+	// Rebuild the due heaps split at a new walk position, only needed when the position moves backwards.
+	void schedule_splitDue(u64 splitKey)
+	{
+		std::vector<Task*> due;
+		due.swap(s_taskHeaps[TASK_HEAP_DUE0]);
+		due.insert(due.end(), s_taskHeaps[TASK_HEAP_DUE1].begin(), s_taskHeaps[TASK_HEAP_DUE1].end());
+		s_taskHeaps[TASK_HEAP_DUE0].clear();
+		s_taskHeaps[TASK_HEAP_DUE1].clear();
+
+		s_dueSplitKey = splitKey;
+		for (size_t i = 0; i < due.size(); i++)
+		{
+			schedule_pushDue(due[i]);
+		}
+	}
+
+	// Move the tasks that have become due since the last call into the due heaps.
+	void schedule_collectDue()
+	{
+		// Time only goes backwards when a save is loaded, move the tasks that are no longer due back to the timer heap.
+		if (s_curTick < s_dueTick)
+		{
+			std::vector<Task*> due;
+			due.swap(s_taskHeaps[TASK_HEAP_DUE0]);
+			due.insert(due.end(), s_taskHeaps[TASK_HEAP_DUE1].begin(), s_taskHeaps[TASK_HEAP_DUE1].end());
+			s_taskHeaps[TASK_HEAP_DUE0].clear();
+			s_taskHeaps[TASK_HEAP_DUE1].clear();
+			for (size_t i = 0; i < due.size(); i++)
+			{
+				due[i]->heapId = TASK_HEAP_NONE;
+				schedule_update(due[i]);
+			}
+		}
+		s_dueTick = s_curTick;
+
+		std::vector<Task*>& timers = s_taskHeaps[TASK_HEAP_TIMER];
+		while (!timers.empty() && timers[0]->nextTick <= s_curTick)
+		{
+			Task* task = timers[0];
+			schedule_remove(task);
+			schedule_pushDue(task);
+		}
+	}
+
+	void schedule_reset()
+	{
+		// Tasks still in the heaps are being thrown away, so their heap indices do not need to be reset.
+		for (s32 i = 0; i < TASK_HEAP_COUNT; i++)
+		{
+			s_taskHeaps[i].clear();
+		}
+		s_dueAhead = TASK_HEAP_DUE0;
+		s_dueSplitKey = 0;
+		s_dueTick = s_curTick;
+
+		// Start a new walk order with only the root task, tasks from the previous one are ignored from now on.
+		s_orderFirst = nullptr;
+		s_orderGen++;
+		order_insert(&s_rootTask, nullptr, nullptr);
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// Walk order
+	// Tasks are kept in a list in the order selectNextTask() walks them, each with a key that increases along the list,
+	// so the due heaps can be ordered by walk position.
+	//////////////////////////////////////////////////////////////////////
+	enum TaskOrderConstants
+	{
+		TASK_ORDER_SPACING_SHIFT = 32,
+	};
+
+	// The first task walked in 'task's subtree: subtasks are walked before their parent.
+	Task* order_firstInSubtree(Task* task)
+	{
+		while (task->subtaskNext)
+		{
+			task = task->subtaskNext;
+		}
+		return task;
+	}
+
+	// Spread the keys out evenly, keeping the due heap split at the same position.
+	void order_relabel()
+	{
+		u64 key = 0;
+		u64 splitKey = 0;
+		for (Task* task = s_orderFirst; task; task = task->orderNext)
+		{
+			const u64 prevKey = task->orderKey;
+			key += (1ull << TASK_ORDER_SPACING_SHIFT);
+			task->orderKey = key;
+			if (prevKey <= s_dueSplitKey) { splitKey = key; }
+		}
+		s_dueSplitKey = splitKey;
+	}
+
+	void order_insert(Task* task, Task* prev, Task* next)
+	{
+		task->orderPrev = prev;
+		task->orderNext = next;
+		task->orderGen = s_orderGen;
+		if (prev) { prev->orderNext = task; }
+		else { s_orderFirst = task; }
+		if (next) { next->orderPrev = task; }
+
+		u64 prevKey = prev ? prev->orderKey : 0;
+		u64 nextKey = next ? next->orderKey : ~0ull;
+		if (nextKey - prevKey < 2)
+		{
+			// Mark the new task as not passed so the relabel keeps the due heap split correct, then use the new keys.
+			task->orderKey = ~0ull;
+			order_relabel();
+			prevKey = prev ? prev->orderKey : 0;
+			nextKey = next ? next->orderKey : ~0ull;
+		}
+		task->orderKey = prevKey + (nextKey - prevKey) / 2;
+	}
+
+	void order_remove(Task* task)
+	{
+		if (task->orderGen != s_orderGen) { return; }
+		if (task->orderPrev) { task->orderPrev->orderNext = task->orderNext; }
+		else { s_orderFirst = task->orderNext; }
+		if (task->orderNext) { task->orderNext->orderPrev = task->orderPrev; }
+		task->orderPrev = nullptr;
+		task->orderNext = nullptr;
+		task->orderGen = 0;
 	}
 
 	s32 task_getCount()
@@ -644,26 +1246,56 @@ namespace TFE_Jedi
 	void ctxAllocate(u32 size)
 	{
 		if (!size) { return; }
-		if (!s_curContext->stackMem)
-		{
-			s_curContext->stackMem = (u8*)allocFromChunkedArray(s_stackBlocks);
-			memset(s_curContext->stackSize, 0, sizeof(u32) * TASK_MAX_LEVELS);
-			s_curContext->stackOffset = 0;
-		}
 
 		s32 level = s_curContext->level;
 		if (!s_curContext->stackPtr[level])
 		{
-			s_curContext->stackPtr[level] = s_curContext->stackMem + s_curContext->stackOffset;
+			stack_alloc(s_curContext, level, size);
 			s_curContext->stackSize[level] = size;
 			s_curContext->stackOffset += size;
 			assert(s_curContext->stackOffset >= 0 && s_curContext->stackOffset < TASK_STACK_SIZE);
+		}
+		else if (size > (1u << (TASK_STACK_MIN_SHIFT + s_curContext->stackClass[level])))
+		{
+			// Memory left behind at this level by a delayed return is reused as is, like the original stack.
+			// But it was sized for a different function, so move it to a large enough pool first.
+			u8* prevMem = s_curContext->stackPtr[level];
+			const u32 prevSize = s_curContext->stackSize[level];
+			const s32 prevClass = s_curContext->stackClass[level];
 
-			// Clear out the memory.
-			memset(s_curContext->stackPtr[level], 0, size);
+			stack_alloc(s_curContext, level, size);
+			memcpy(s_curContext->stackPtr[level], prevMem, prevSize);
+			freeToChunkedArray(s_stackPools[prevClass], prevMem);
+
+			s_curContext->stackOffset += size - prevSize;
+			s_curContext->stackSize[level] = size;
 		}
 	}
 
+	// Allocate cleared local memory for 'level' from the smallest pool that fits.
+	u8* stack_alloc(TaskContext* context, s32 level, u32 size)
+	{
+		assert(size <= TASK_STACK_SIZE);
+		s32 stackClass = 0;
+		while (stackClass < TASK_STACK_CLASS_COUNT - 1 && (1u << (TASK_STACK_MIN_SHIFT + stackClass)) < size)
+		{
+			stackClass++;
+		}
+
+		u8* mem = (u8*)allocFromChunkedArray(s_stackPools[stackClass]);
+		memset(mem, 0, size);
+		context->stackPtr[level] = mem;
+		context->stackClass[level] = u8(stackClass);
+		return mem;
+	}
+
+	void stack_free(TaskContext* context, s32 level)
+	{
+		if (!context->stackPtr[level]) { return; }
+		freeToChunkedArray(s_stackPools[context->stackClass[level]], context->stackPtr[level]);
+		context->stackPtr[level] = nullptr;
+	}
+
 	void* ctxGet()
 	{
 		return s_curContext->stackPtr[s_curContext->level];
@@ -25,6 +25,21 @@ enum TaskDelay
 	TASK_NO_DELAY = 0,
 };
 typedef void(*LocalMemorySerCallback)(Stream* stream, void* userData, void* mem);
+typedef void(*TaskStepFunc)();
+
+// Timing for all tasks sharing a name, times are in microseconds.
+struct TaskProfileInfo
+{
+	const char* name;
+	u32 callCount;		// Calls in the last frame.
+	f64 timeInFrame;	// Time in the last frame.
+	f64 maxCallTime;	// Longest single call in the last frame.
+	f64 callCountAve;	// Rolling average of calls per frame.
+	f64 timeAve;		// Rolling average of time per frame.
+	f64 peakTime;		// Worst frame time since the profile was cleared.
+	u64 totalCalls;
+	f64 totalTime;
+};
 
 ////////////////////////////////////////////////////////////////////////
 // Task System API
@@ -76,6 +91,20 @@ namespace TFE_Jedi
 
 	void task_updateTime();
 	s32 task_getCount();
+
+	// Fixed step mode: task_run() runs the tasks once per queued step, in addition to the minimum step interval.
+	// This lets the game drive the tasks from its own fixed rate clock, beginStep is called before each step so the game can advance its time.
+	void task_setFixedStep(JBool enable, TaskStepFunc beginStep);
+	void task_setQueuedSteps(s32 count);
+
+	// Opt-in per-task profiling, also controlled by the "d_enableTaskProfiler" cvar.
+	void  task_enableProfiling(JBool enable);
+	JBool task_isProfilingEnabled();
+	void  task_clearProfile();
+	u32   task_getProfileCount();
+	void  task_getProfileInfo(u32 index, TaskProfileInfo* info);
+	// Write the profile as CSV.
+	bool  task_writeProfile(const char* path);
 }
 ////////////////////////////////////////////////////////////////////////
 // Task Function API:
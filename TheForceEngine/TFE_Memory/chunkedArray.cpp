@@ -1,8 +1,10 @@
 #include <cstring>
+#include <cstddef>
 
 #include "chunkedArray.h"
 #include <TFE_System/system.h>
 #include <TFE_Memory/memoryRegion.h>
+#include <TFE_System/math.h>
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,6 +30,11 @@ struct ChunkedArray
 	u8** chunks;
 	u8** freeSlots;
 	MemoryRegion* region;
+
+	// One bit per element for each chunk, set while the element is allocated.
+	u32** occupancy;
+	// Chunk indices sorted by chunk address, used to find the chunk that owns a pointer.
+	u32* chunkOrder;
 };
 
 namespace TFE_Memory
@@ -37,11 +44,34 @@ namespace TFE_Memory
 		FREE_SLOT_STEP = 32,
 	};
 	void addFreeSlot(ChunkedArray* arr, u8* ptr);
+	void growChunks(ChunkedArray* arr, u32 newChunkCount);
+	void buildChunkOrder(ChunkedArray* arr);
+	bool getElementLocation(ChunkedArray* arr, void* ptr, u32* chunkIndex, u32* elemIndex);
+
+	inline u32 getOccupancyWordCount(ChunkedArray* arr)
+	{
+		return (arr->elemPerChunk + 31u) >> 5u;
+	}
+
+	inline void setOccupied(ChunkedArray* arr, u32 chunkIndex, u32 elemIndex)
+	{
+		arr->occupancy[chunkIndex][elemIndex >> 5u] |= (1u << (elemIndex & 31u));
+	}
+
+	inline void clearOccupied(ChunkedArray* arr, u32 chunkIndex, u32 elemIndex)
+	{
+		arr->occupancy[chunkIndex][elemIndex >> 5u] &= ~(1u << (elemIndex & 31u));
+	}
+
+	inline bool isOccupied(ChunkedArray* arr, u32 chunkIndex, u32 elemIndex)
+	{
+		return (arr->occupancy[chunkIndex][elemIndex >> 5u] & (1u << (elemIndex & 31u))) != 0;
+	}
 
 	void serialize(ChunkedArray* arr, FileStream* file)
 	{
 		assert(file);
-		size_t size = size_t(&arr->chunks) - sizeof(arr);
+		const size_t size = offsetof(ChunkedArray, chunks);
 		file->writeBuffer(arr, (u32)size);
 
 		const u32 chunkAllocSize = arr->elemPerChunk * arr->elemSize;
@@ -63,14 +93,17 @@ namespace TFE_Memory
 		ChunkedArray* arr = (ChunkedArray*)region_alloc(region, sizeof(ChunkedArray));
 		memset(arr, 0, sizeof(ChunkedArray));
 
-		size_t size = size_t(&arr->chunks) - sizeof(arr);
+		const size_t size = offsetof(ChunkedArray, chunks);
 		file->readBuffer(arr, (u32)size);
+		arr->region = region;
+
+		const u32 chunkCount = arr->chunkCount;
+		arr->chunkCount = 0;
+		growChunks(arr, chunkCount);
 
-		arr->chunks = (u8**)region_realloc(region, arr->chunks, sizeof(u8*) * arr->chunkCount);
 		const u32 chunkAllocSize = arr->elemPerChunk * arr->elemSize;
 		for (u32 i = 0; i < arr->chunkCount; i++)
 		{
-			arr->chunks[i] = (u8*)region_alloc(region, chunkAllocSize);
 			file->read(arr->chunks[i], chunkAllocSize);
 		}
 
@@ -81,13 +114,28 @@ namespace TFE_Memory
 			file->read(&freeSlotIndex);
 			if (freeSlotIndex >= 0)
 			{
-				arr->freeSlots[i] = arr->chunks[freeSlotIndex];
+				arr->freeSlots[i] = (u8*)chunkedArrayGet(arr, u32(freeSlotIndex));
 			}
 			else
 			{
 				arr->freeSlots[i] = nullptr;
 			}
 		}
+
+		// The occupancy bitmap is not serialized, rebuild it from the element count and free slots.
+		for (u32 i = 0; i < arr->elemCount; i++)
+		{
+			const u32 chunkIndex = i / arr->elemPerChunk;
+			setOccupied(arr, chunkIndex, i - chunkIndex*arr->elemPerChunk);
+		}
+		for (u32 i = 0; i < arr->freeSlotCount; i++)
+		{
+			u32 chunkIndex, elemIndex;
+			if (getElementLocation(arr, arr->freeSlots[i], &chunkIndex, &elemIndex))
+			{
+				clearOccupied(arr, chunkIndex, elemIndex);
+			}
+		}
 		return arr;
 	}
 
@@ -101,19 +149,13 @@ namespace TFE_Memory
 		arr->elemCount = 0;
 				
 		arr->elemPerChunk = elemPerChunk;
-		arr->chunkCount = initChunkCount;
-		arr->chunks = (u8**)region_realloc(region, arr->chunks, sizeof(u8*) * initChunkCount);
+		arr->chunkCount = 0;
 		
 		arr->freeSlotCount = 0;
 		arr->freeSlotCapacity = 0;
 		arr->freeSlots = nullptr;
 
-		const u32 chunkAllocSize = elemPerChunk * elemSize;
-		for (u32 i = 0; i < initChunkCount; i++)
-		{
-			arr->chunks[i] = (u8*)region_alloc(region, chunkAllocSize);
-		}
-
+		growChunks(arr, initChunkCount);
 		return arr;
 	}
 
@@ -124,8 +166,11 @@ namespace TFE_Memory
 		for (u32 i = 0; i < arr->chunkCount; i++)
 		{
 			region_free(arr->region, arr->chunks[i]);
+			region_free(arr->region, arr->occupancy[i]);
 		}
 		region_free(arr->region, arr->chunks);
+		region_free(arr->region, arr->occupancy);
+		region_free(arr->region, arr->chunkOrder);
 		region_free(arr->region, arr->freeSlots);
 		region_free(arr->region, arr);
 	}
@@ -135,7 +180,14 @@ namespace TFE_Memory
 		if (arr->freeSlotCount)
 		{
 			arr->freeSlotCount--;
-			return arr->freeSlots[arr->freeSlotCount];
+			u8* ptr = arr->freeSlots[arr->freeSlotCount];
+
+			u32 chunkIndex, elemIndex;
+			if (getElementLocation(arr, ptr, &chunkIndex, &elemIndex))
+			{
+				setOccupied(arr, chunkIndex, elemIndex);
+			}
+			return ptr;
 		}
 		s32 elementIndex = arr->elemCount;
 		arr->elemCount++;
@@ -144,18 +196,12 @@ namespace TFE_Memory
 		const u32 newChunkCount = newChunkIndex + 1;
 		if (newChunkCount > arr->chunkCount)
 		{
-			arr->chunks = (u8**)region_realloc(arr->region, arr->chunks, sizeof(u8*) * newChunkCount);
-
-			const u32 chunkAllocSize = arr->elemPerChunk * arr->elemSize;
-			for (u32 i = arr->chunkCount; i < newChunkCount; i++)
-			{
-				arr->chunks[i] = (u8*)region_alloc(arr->region, chunkAllocSize);
-			}
-			arr->chunkCount = newChunkCount;
+			growChunks(arr, newChunkCount);
 		}
 
 		const u32 index = elementIndex - newChunkIndex*arr->elemPerChunk;
 		assert(index < arr->elemPerChunk);
+		setOccupied(arr, newChunkIndex, index);
 		return arr->chunks[newChunkIndex] + index*arr->elemSize;
 	}
 		
@@ -183,6 +229,16 @@ namespace TFE_Memory
 		}
 #endif
 
+		u32 chunkIndex, elemIndex;
+		if (!getElementLocation(arr, ptr, &chunkIndex, &elemIndex))
+		{
+			TFE_System::logWrite(LOG_ERROR, "ChunkedArray", "Attempting to free a pointer that does not belong to the array.");
+			assert(0);
+			return;
+		}
+		assert(isOccupied(arr, chunkIndex, elemIndex));
+		clearOccupied(arr, chunkIndex, elemIndex);
+
 		addFreeSlot(arr, (u8*)ptr);
 	}
 
@@ -192,9 +248,11 @@ namespace TFE_Memory
 
 		arr->elemCount = 0;
 		arr->freeSlotCount = 0;
+		const u32 wordCount = getOccupancyWordCount(arr);
 		for (u32 i = 0; i < arr->chunkCount; i++)
 		{
 			memset(arr->chunks[i], 0, arr->elemPerChunk * arr->elemSize);
+			memset(arr->occupancy[i], 0, wordCount * sizeof(u32));
 		}
 	}
 
@@ -220,6 +278,85 @@ namespace TFE_Memory
 		return arr->chunks[chunkId] + elemId*arr->elemSize;
 	}
 
+	bool chunkedArrayIsLive(ChunkedArray* arr, u32 index)
+	{
+		if (!arr || index >= arr->elemCount) { return false; }
+		const u32 chunkId = index / arr->elemPerChunk;
+		return isOccupied(arr, chunkId, index - chunkId*arr->elemPerChunk);
+	}
+
+	void chunkedArrayForEach(ChunkedArray* arr, ChunkedArrayIterFunc func, void* userData)
+	{
+		if (!arr || !func) { return; }
+
+		const u32 wordCount = getOccupancyWordCount(arr);
+		for (u32 c = 0; c < arr->chunkCount && c*arr->elemPerChunk < arr->elemCount; c++)
+		{
+			for (u32 w = 0; w < wordCount; w++)
+			{
+				// Copy the word so the callback is free to release the current element.
+				u32 bits = arr->occupancy[c][w];
+				while (bits)
+				{
+					const u32 elemIndex = (w << 5u) + TFE_Math::bitScanForward(bits);
+					bits &= bits - 1u;
+					func(arr->chunks[c] + elemIndex*arr->elemSize, userData);
+				}
+			}
+		}
+	}
+
+	void growChunks(ChunkedArray* arr, u32 newChunkCount)
+	{
+		if (newChunkCount <= arr->chunkCount) { return; }
+		arr->chunks = (u8**)region_realloc(arr->region, arr->chunks, sizeof(u8*) * newChunkCount);
+		arr->occupancy = (u32**)region_realloc(arr->region, arr->occupancy, sizeof(u32*) * newChunkCount);
+		arr->chunkOrder = (u32*)region_realloc(arr->region, arr->chunkOrder, sizeof(u32) * newChunkCount);
+
+		const u32 chunkAllocSize = arr->elemPerChunk * arr->elemSize;
+		const u32 wordCount = getOccupancyWordCount(arr);
+		for (u32 i = arr->chunkCount; i < newChunkCount; i++)
+		{
+			arr->chunks[i] = (u8*)region_alloc(arr->region, chunkAllocSize);
+			arr->occupancy[i] = (u32*)region_alloc(arr->region, wordCount * sizeof(u32));
+			memset(arr->occupancy[i], 0, wordCount * sizeof(u32));
+		}
+		arr->chunkCount = newChunkCount;
+		buildChunkOrder(arr);
+	}
+
+	// Chunks are only added or released rarely, so the order is simply rebuilt when that happens.
+	void buildChunkOrder(ChunkedArray* arr)
+	{
+		for (u32 i = 0; i < arr->chunkCount; i++)
+		{
+			arr->chunkOrder[i] = i;
+		}
+		u8** chunks = arr->chunks;
+		std::sort(arr->chunkOrder, arr->chunkOrder + arr->chunkCount, [chunks](u32 a, u32 b) { return chunks[a] < chunks[b]; });
+	}
+
+	bool getElementLocation(ChunkedArray* arr, void* ptr, u32* chunkIndex, u32* elemIndex)
+	{
+		// Binary search for the last chunk that starts at or before ptr.
+		u32 lo = 0, hi = arr->chunkCount;
+		while (lo < hi)
+		{
+			const u32 mid = (lo + hi) >> 1u;
+			if (arr->chunks[arr->chunkOrder[mid]] <= (u8*)ptr) { lo = mid + 1; }
+			else { hi = mid; }
+		}
+		if (lo == 0) { return false; }
+
+		const u32 i = arr->chunkOrder[lo - 1];
+		const size_t chunkAllocSize = arr->elemPerChunk * arr->elemSize;
+		if ((u8*)ptr >= arr->chunks[i] + chunkAllocSize) { return false; }
+
+		*chunkIndex = i;
+		*elemIndex = u32((u8*)ptr - arr->chunks[i]) / arr->elemSize;
+		return true;
+	}
+
 	void addFreeSlot(ChunkedArray* arr, u8* ptr)
 	{
 		if (arr->freeSlotCount + 1 >= arr->freeSlotCapacity)
@@ -233,13 +370,11 @@ namespace TFE_Memory
 
 	s32 getSlotIndex(ChunkedArray* arr, u8* ptr)
 	{
-		for (s32 i = 0; i < (s32)arr->chunkCount; i++)
+		u32 chunkIndex, elemIndex;
+		if (!getElementLocation(arr, ptr, &chunkIndex, &elemIndex))
 		{
-			if (arr->chunks[i] == ptr)
-			{
-				return i;
-			}
+			return -1;
 		}
-		return -1;
+		return s32(chunkIndex * arr->elemPerChunk + elemIndex);
 	}
 }
@@ -10,6 +10,9 @@
 struct ChunkedArray;
 struct MemoryRegion;
 
+// Called for each live element during iteration.
+typedef void(*ChunkedArrayIterFunc)(void* elem, void* userData);
+
 namespace TFE_Memory
 {
 	ChunkedArray* createChunkedArray(u32 elemSize, u32 elemPerChunk, u32 initChunkCount, MemoryRegion* region);
@@ -24,9 +27,16 @@ namespace TFE_Memory
 	u32 chunkedArraySize(ChunkedArray* arr);
 	u32 chunkedArrayCount(ChunkedArray* arr);
 	void* chunkedArrayGet(ChunkedArray* arr, u32 index);
+	// Returns true if the element at 'index' is currently allocated.
+	bool chunkedArrayIsLive(ChunkedArray* arr, u32 index);
+
+	// Visit every live element in index order, skipping free slots using the occupancy bitmap.
+	// The callback may free the element it is given.
+	void chunkedArrayForEach(ChunkedArray* arr, ChunkedArrayIterFunc func, void* userData);
 
 	void serialize(ChunkedArray* arr, FileStream* file);
 	ChunkedArray* restore(FileStream* file, MemoryRegion* region);
 
+	// Returns the element index of ptr, which can be passed to chunkedArrayGet(), or -1 if it is not in the array.
 	s32 getSlotIndex(ChunkedArray* arr, u8* ptr);
 }
\ No newline at end of file
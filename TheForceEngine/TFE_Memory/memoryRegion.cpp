@@ -1,15 +1,23 @@
 #include <cstring>
+#include <cstddef>
 
 #include "memoryRegion.h"
 #include <TFE_System/system.h>
 #include <TFE_System/memoryPool.h>
 #include <TFE_System/math.h>
+#include <TFE_FrontEndUI/console.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <algorithm>
+#ifdef TFE_REGION_TAGS
+#include <map>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 // #define _VERIFY_MEMORY
 
@@ -31,8 +39,19 @@ enum
 	// No more then 256 blocks, and no more than 16MB per block for a total of 4GB.
 	MAX_BLOCK_COUNT = 256,
 	MAX_BLOCK_SIZE  = 16 * 1024 * 1024,
+	// Block backing.
+	PREFAULT_PAGE_SIZE = 4096,
+	HUGE_PAGE_SIZE     = 2 * 1024 * 1024,
 	RELATIVE_NON_NULL_BIT = 1u,
 	SHARED_HEADER_SIZE = 8,	// 8 bytes are shared between RegionAllocHeader{} and AllocHeaderFree{}
+	// TLSF: the first level splits sizes by powers of 2, the second level splits each power of 2 into 16 linear bins.
+	// Sizes below TLSF_SMALL_SIZE are stored in first level 0, in 8 byte steps.
+	TLSF_ALIGN_LOG2 = 3,
+	TLSF_SL_LOG2 = 4,
+	TLSF_SL_COUNT = 1 << TLSF_SL_LOG2,
+	TLSF_FL_SHIFT = TLSF_SL_LOG2 + TLSF_ALIGN_LOG2,
+	TLSF_SMALL_SIZE = 1 << TLSF_FL_SHIFT,
+	TLSF_FL_COUNT = 24 - TLSF_FL_SHIFT + 2,	// Up to MAX_BLOCK_SIZE (2^24) inclusive.
 };
 
 struct RegionAllocHeader
@@ -41,7 +60,8 @@ struct RegionAllocHeader
 	u8  free;
 	u8  bin;
 	u8  pad8[2];
-	u32 pad4[2];	// pad to 16 bytes.
+	u32 tag;		// Allocation tag id, only used with TFE_REGION_TAGS.
+	u32 pad4;		// pad to 16 bytes.
 };
 
 // free structure is larger than header, because it fits within the
@@ -65,6 +85,11 @@ struct MemoryBlock
 {
 	u32 sizeFree;
 	u32 count;
+	u32 strategy;	// RegionAllocStrategy, determines which free lists are used.
+	// TLSF bitmaps, a set bit means the matching list is not empty.
+	u32 flBitmap;
+	u32 slBitmap[TLSF_FL_COUNT];
+	u32 pad32;
 	// Head pointer to each bin.
 	// Bin index = clamp(log2(nextPow2(size)) - 5, 0, 5)
 	// bin 0: [0,  32]
@@ -74,6 +99,8 @@ struct MemoryBlock
 	//     4: [257, 512]
 	//     5: [513+]
 	AllocHeaderFree* freeListBins[ALLOC_BIN_COUNT];
+	// TLSF free lists, free headers store the first level index in 'bin' and the second level index in 'pad8[0]'.
+	AllocHeaderFree* tlsfBins[TLSF_FL_COUNT][TLSF_SL_COUNT];
 };
 
 struct MemoryRegion
@@ -85,10 +112,34 @@ struct MemoryRegion
 	size_t blockCount;
 	size_t blockSize;
 	size_t maxBlocks;
+	RegionAllocStrategy strategy;
+	u32 backing;	// RegionBackingFlags, fixed when the region is created.
+
+	// Telemetry
+	size_t highWater;
+	u64 allocCount;
+	u64 freeCount;
+	u32 allocHistogram[REGION_SIZE_CLASS_COUNT];
+
+	// Allocation trace, only allocated while recording.
+	std::vector<RegionTraceOp>* trace;
+};
+
+struct RegionSnapshot
+{
+	char name[32];
+	u64  blockSize;
+	u32  blockCount;
+	u32  strategy;
+	u64  blockAddress[MAX_BLOCK_COUNT];	// Block addresses when the snapshot was taken, used to detect and fix up relocation.
+	// Block images, each is sizeof(MemoryBlock) + blockSize bytes.
+	u8*  data;
+	size_t dataCapacity;
 };
 
 static_assert(sizeof(RegionAllocHeader) == 16, "RegionAllocHeader is the wrong size.");
 static_assert(sizeof(AllocHeaderFree) == 24, "AllocHeaderFree is the wrong size.");
+static_assert((sizeof(MemoryBlock) & (ALIGNMENT - 1)) == 0, "MemoryBlock must preserve allocation alignment.");
 
 namespace TFE_Memory
 {
@@ -96,13 +147,45 @@ namespace TFE_Memory
 	// See MAX_BLOCK_COUNT and MAX_BLOCK_SIZE above.
 	static const u32 c_relativeBlockShift = 24u;
 	static const u32 c_relativeOffsetMask = (1u << c_relativeBlockShift) - 1u;
+	static RegionAllocStrategy s_defaultStrategy = REGION_ALLOC_TLSF;
+	static u32 s_defaultBacking = REGION_BACKING_DEFAULT;
+	// Live regions, so the console commands can look them up by name.
+	static std::vector<MemoryRegion*> s_regions;
+	static std::vector<RegionSnapshot*> s_cmdSnapshots;
+	static bool s_regionCmdsRegistered = false;
+#ifdef TFE_REGION_TAGS
+	// Tag 0 is used for allocations made through the untagged functions.
+	static std::vector<const char*> s_tagNames = { "untagged" };
+	// The same tag literal may have a different address in each translation unit, so compare the strings.
+	struct TagNameLess
+	{
+		bool operator()(const char* a, const char* b) const { return strcmp(a, b) < 0; }
+	};
+	static std::map<const char*, u32, TagNameLess> s_tagIds;
+#endif
 
 	void freeSlot(RegionAllocHeader* alloc, RegionAllocHeader* next, MemoryBlock* block);
 	size_t alloc_align(size_t baseSize);
 	s32  getBinFromSize(u32 size);
 	bool allocateNewBlock(MemoryRegion* region);
+	MemoryBlock* allocBlockMemory(MemoryRegion* region);
+	void freeBlockMemory(MemoryRegion* region, MemoryBlock* block);
+	void prefaultBlock(MemoryRegion* region, MemoryBlock* block);
+	void resetBlock(MemoryRegion* region, MemoryBlock* block);
+	void clearFreelists(MemoryBlock* block);
+	void rebuildFreelists(MemoryBlock* block);
 	void removeHeaderFromFreelist(MemoryBlock* block, RegionAllocHeader* header);
 	void insertBlockIntoFreelist(MemoryBlock* block, RegionAllocHeader* header);
+	AllocHeaderFree* findFreeHeader(MemoryBlock* block, u32 size);
+	void* allocInternal(MemoryRegion* region, size_t size);
+	void  freeInternal(MemoryRegion* region, void* ptr);
+	void  registerConsoleCommands();
+
+	// Blocks are allocated separately, so there is no guarantee that they are in address order.
+	inline bool blockContainsPtr(MemoryRegion* region, MemoryBlock* block, void* ptr)
+	{
+		return ptr >= block && (u8*)ptr < (u8*)block + sizeof(MemoryBlock) + region->blockSize;
+	}
 
 	void verifyMemory(MemoryRegion* region)
 	{
@@ -134,9 +217,51 @@ namespace TFE_Memory
 					}
 				}
 			}
+
+			for (s32 fl = 0; fl < TLSF_FL_COUNT; fl++)
+			{
+				assert(((block->flBitmap >> fl) & 1) == (block->slBitmap[fl] ? 1u : 0u));
+				for (s32 sl = 0; sl < TLSF_SL_COUNT; sl++)
+				{
+					AllocHeaderFree* slot = block->tlsfBins[fl][sl];
+					assert(((block->slBitmap[fl] >> sl) & 1) == (slot ? 1u : 0u));
+					while (slot)
+					{
+						assert(slot->free == 1 && slot->bin == fl && slot->pad8[0] == sl);
+						assert(slot->size <= block->sizeFree);
+						slot = slot->binNext;
+					}
+				}
+			}
 		}
 	}
 
+	void region_setDefaultStrategy(RegionAllocStrategy strategy)
+	{
+		if (strategy < REGION_ALLOC_FIRST_FIT || strategy >= REGION_ALLOC_COUNT) { return; }
+		s_defaultStrategy = strategy;
+	}
+
+	RegionAllocStrategy region_getDefaultStrategy()
+	{
+		return s_defaultStrategy;
+	}
+
+	void region_setDefaultBacking(u32 flags)
+	{
+		s_defaultBacking = flags;
+	}
+
+	u32 region_getDefaultBacking()
+	{
+		return s_defaultBacking;
+	}
+
+	RegionAllocStrategy region_getStrategy(MemoryRegion* region)
+	{
+		return region ? region->strategy : s_defaultStrategy;
+	}
+
 	MemoryRegion* region_create(const char* name, size_t blockSize, size_t maxSize)
 	{
 		assert(name);
@@ -160,6 +285,13 @@ namespace TFE_Memory
 		region->blockCount = 0;
 		region->blockSize = blockSize;
 		region->maxBlocks = maxSize ? (maxSize + blockSize - 1) / blockSize : 0;
+		region->strategy = s_defaultStrategy;
+		region->backing = s_defaultBacking;
+		region->highWater = 0;
+		region->allocCount = 0;
+		region->freeCount = 0;
+		memset(region->allocHistogram, 0, sizeof(region->allocHistogram));
+		region->trace = nullptr;
 		if (!allocateNewBlock(region))
 		{
 			free(region);
@@ -168,23 +300,28 @@ namespace TFE_Memory
 		}
 		VERIFY_MEMORY();
 
+		s_regions.push_back(region);
+		if (!s_regionCmdsRegistered)
+		{
+			registerConsoleCommands();
+			s_regionCmdsRegistered = true;
+		}
 		return region;
 	}
 
 	void region_clear(MemoryRegion* region)
 	{
 		assert(region);
+		if (region->trace)
+		{
+			const RegionTraceOp op = { RTRACE_CLEAR, 0, 0, 0 };
+			region->trace->push_back(op);
+		}
+		// Everything is free, so this is the time to pick up a strategy change.
+		region->strategy = s_defaultStrategy;
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
-			MemoryBlock* block = region->memBlocks[i];
-			block->sizeFree = u32(region->blockSize);
-			block->count = 1;
-
-			RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
-			header->size = block->sizeFree;
-			header->free = 0;
-			memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
-			insertBlockIntoFreelist(block, header);
+			resetBlock(region, region->memBlocks[i]);
 			VERIFY_MEMORY();
 		}
 	}
@@ -194,9 +331,20 @@ namespace TFE_Memory
 		assert(region);
 		for (s32 i = 0; i < region->blockCount; i++)
 		{
-			free(region->memBlocks[i]);
+			freeBlockMemory(region, region->memBlocks[i]);
 		}
 		free(region->memBlocks);
+		delete region->trace;
+
+		s_regions.erase(std::remove(s_regions.begin(), s_regions.end(), region), s_regions.end());
+		if (s_regions.empty())
+		{
+			for (size_t i = 0; i < s_cmdSnapshots.size(); i++)
+			{
+				region_snapshotFree(s_cmdSnapshots[i]);
+			}
+			s_cmdSnapshots.clear();
+		}
 		free(region);
 	}
 		
@@ -231,7 +379,7 @@ namespace TFE_Memory
 		return (u8*)header + sizeof(RegionAllocHeader);
 	}
 
-	void* region_alloc(MemoryRegion* region, size_t size)
+	void* allocInternal(MemoryRegion* region, size_t size)
 	{
 		assert(region);
 		if (size == 0) { return nullptr; }
@@ -248,22 +396,19 @@ namespace TFE_Memory
 				continue;
 			}
 
-			// Try to allocate from the closest matching bin.
-			s32 bin = getBinFromSize((u32)size);
-			for (s32 b = bin; b < ALLOC_BIN_COUNT; b++)
+			AllocHeaderFree* header = findFreeHeader(block, (u32)size);
+			if (header)
 			{
-				AllocHeaderFree* header = block->freeListBins[b];
-				while (header)
-				{
-					if (header->size >= size)
-					{
-						VERIFY_MEMORY();
-						void* mem = allocFromHeader(block, (RegionAllocHeader*)header, (u32)size);
-						VERIFY_MEMORY();
-						return mem;
-					}
-					header = header->binNext;
-				}
+				VERIFY_MEMORY();
+				void* mem = allocFromHeader(block, (RegionAllocHeader*)header, (u32)size);
+				VERIFY_MEMORY();
+
+				region->allocCount++;
+				region->allocHistogram[region_getSizeClass(size)]++;
+			#ifdef TFE_REGION_TAGS
+				((RegionAllocHeader*)header)->tag = 0;
+			#endif
+				return mem;
 			}
 		}
 
@@ -272,7 +417,7 @@ namespace TFE_Memory
 			if (allocateNewBlock(region))
 			{
 				VERIFY_MEMORY();
-				void* mem = region_alloc(region, size);
+				void* mem = allocInternal(region, size);
 				VERIFY_MEMORY();
 				return mem;
 			}
@@ -283,10 +428,10 @@ namespace TFE_Memory
 		return nullptr;
 	}
 
-	void* region_realloc(MemoryRegion* region, void* ptr, size_t size)
+	void* reallocInternal(MemoryRegion* region, void* ptr, size_t size)
 	{
 		assert(region);
-		if (!ptr) { return region_alloc(region, size); }
+		if (!ptr) { return allocInternal(region, size); }
 		if (size == 0) { return nullptr; }
 
 		size = alloc_align(size + sizeof(RegionAllocHeader));
@@ -304,7 +449,7 @@ namespace TFE_Memory
 		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
 		{
 			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
+			if (blockContainsPtr(region, block, ptr))
 			{
 				RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
 				RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
@@ -363,28 +508,31 @@ namespace TFE_Memory
 		}
 
 		// Allocate a new block of memory.
-		void* newMem = region_alloc(region, size);
+		void* newMem = allocInternal(region, size);
 		if (!newMem) { return nullptr; }
+	#ifdef TFE_REGION_TAGS
+		((RegionAllocHeader*)((u8*)newMem - sizeof(RegionAllocHeader)))->tag = header->tag;
+	#endif
 		// Copy over the contents from the previous block.
 		if (prevSize > sizeof(RegionAllocHeader))
 		{
 			memcpy(newMem, ptr, std::min((u32)size, prevSize) - sizeof(RegionAllocHeader));
 		}
 		// Free the previous block
-		region_free(region, ptr);
+		freeInternal(region, ptr);
 		// Then return the new block.
 		VERIFY_MEMORY();
 		return newMem;
 	}
 		
-	void region_free(MemoryRegion* region, void* ptr)
+	void freeInternal(MemoryRegion* region, void* ptr)
 	{
 		if (!ptr || !region) { return; }
 
 		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
 		{
 			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
+			if (blockContainsPtr(region, block, ptr))
 			{
 				RegionAllocHeader* header = (RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader));
 				RegionAllocHeader* nextHeader = (RegionAllocHeader*)((u8*)header + header->size);
@@ -403,11 +551,150 @@ namespace TFE_Memory
 				VERIFY_MEMORY();
 				freeSlot(header, nextHeader, block);
 				VERIFY_MEMORY();
+				region->freeCount++;
 				return;
 			}
 		}
 	}
 		
+	inline void recordTraceOp(MemoryRegion* region, RegionTraceOpType type, size_t size, void* ptr, void* prevPtr)
+	{
+		const RegionTraceOp op = { u32(type), u32(size), u64(size_t(ptr)), u64(size_t(prevPtr)) };
+		region->trace->push_back(op);
+	}
+
+	void* region_alloc(MemoryRegion* region, size_t size)
+	{
+		void* ptr = allocInternal(region, size);
+		if (region->trace) { recordTraceOp(region, RTRACE_ALLOC, size, ptr, nullptr); }
+		return ptr;
+	}
+
+	void* region_realloc(MemoryRegion* region, void* ptr, size_t size)
+	{
+		void* newPtr = reallocInternal(region, ptr, size);
+		if (region->trace) { recordTraceOp(region, RTRACE_REALLOC, size, newPtr, ptr); }
+		return newPtr;
+	}
+
+	void region_free(MemoryRegion* region, void* ptr)
+	{
+		if (region && ptr && region->trace) { recordTraceOp(region, RTRACE_FREE, 0, ptr, nullptr); }
+		freeInternal(region, ptr);
+	}
+
+	void region_beginTrace(MemoryRegion* region)
+	{
+		if (!region) { return; }
+		if (!region->trace) { region->trace = new std::vector<RegionTraceOp>(); }
+		region->trace->clear();
+	}
+
+	void region_endTrace(MemoryRegion* region, std::vector<RegionTraceOp>& ops)
+	{
+		ops.clear();
+		if (!region || !region->trace) { return; }
+		ops.swap(*region->trace);
+		delete region->trace;
+		region->trace = nullptr;
+	}
+
+	bool region_isTracing(MemoryRegion* region)
+	{
+		return region && region->trace;
+	}
+
+#ifdef TFE_REGION_TAGS
+	u32 getTagId(const char* tag)
+	{
+		if (!tag) { return 0; }
+		std::map<const char*, u32, TagNameLess>::iterator iTag = s_tagIds.find(tag);
+		if (iTag != s_tagIds.end()) { return iTag->second; }
+
+		const u32 id = (u32)s_tagNames.size();
+		s_tagNames.push_back(tag);
+		s_tagIds[tag] = id;
+		return id;
+	}
+
+	void setTag(void* ptr, const char* tag)
+	{
+		if (ptr)
+		{
+			((RegionAllocHeader*)((u8*)ptr - sizeof(RegionAllocHeader)))->tag = getTagId(tag);
+		}
+	}
+#endif
+
+	void* region_allocTagged(MemoryRegion* region, size_t size, const char* tag)
+	{
+		void* ptr = region_alloc(region, size);
+	#ifdef TFE_REGION_TAGS
+		setTag(ptr, tag);
+	#endif
+		return ptr;
+	}
+
+	void* region_reallocTagged(MemoryRegion* region, void* ptr, size_t size, const char* tag)
+	{
+		void* newPtr = region_realloc(region, ptr, size);
+	#ifdef TFE_REGION_TAGS
+		setTag(newPtr, tag);
+	#endif
+		return newPtr;
+	}
+
+	void region_getTagUsage(MemoryRegion* region, std::vector<RegionTagUsage>& usage)
+	{
+		usage.clear();
+	#ifdef TFE_REGION_TAGS
+		if (!region) { return; }
+
+		std::vector<RegionTagUsage> tagUsage(s_tagNames.size());
+		for (size_t i = 0; i < s_tagNames.size(); i++)
+		{
+			tagUsage[i] = { s_tagNames[i], 0, 0 };
+		}
+		for (s32 i = 0; i < region->blockCount; i++)
+		{
+			MemoryBlock* block = region->memBlocks[i];
+			u8* memPtr = (u8*)block + sizeof(MemoryBlock);
+			for (u32 al = 0; al < block->count; al++)
+			{
+				RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
+				if (!header->free && header->tag < tagUsage.size())
+				{
+					tagUsage[header->tag].size += header->size;
+					tagUsage[header->tag].count++;
+				}
+				memPtr += header->size;
+			}
+		}
+
+		// The same file may have been registered through different string literals.
+		for (size_t i = 0; i < tagUsage.size(); i++)
+		{
+			if (!tagUsage[i].count) { continue; }
+
+			size_t u = 0;
+			for (; u < usage.size(); u++)
+			{
+				if (strcmp(usage[u].tag, tagUsage[i].tag) == 0) { break; }
+			}
+			if (u < usage.size())
+			{
+				usage[u].size += tagUsage[i].size;
+				usage[u].count += tagUsage[i].count;
+			}
+			else
+			{
+				usage.push_back(tagUsage[i]);
+			}
+		}
+		std::sort(usage.begin(), usage.end(), [](const RegionTagUsage& a, const RegionTagUsage& b) { return a.size > b.size; });
+	#endif
+	}
+
 	size_t region_getMemoryUsed(MemoryRegion* region)
 	{
 		size_t used = 0;
@@ -428,6 +715,97 @@ namespace TFE_Memory
 	{
 		return region->blockCount * region->blockSize;
 	}
+
+	const char* region_getName(MemoryRegion* region)
+	{
+		return region ? region->name : "";
+	}
+
+	MemoryRegion* region_find(const char* name)
+	{
+		for (size_t i = 0; i < s_regions.size(); i++)
+		{
+			if (strcasecmp(s_regions[i]->name, name) == 0)
+			{
+				return s_regions[i];
+			}
+		}
+		return nullptr;
+	}
+
+	s32 region_getSizeClass(size_t size)
+	{
+		s32 sizeClass = 0;
+		size >>= REGION_SIZE_CLASS_SHIFT;
+		while (size && sizeClass < REGION_SIZE_CLASS_COUNT - 1)
+		{
+			size >>= 1;
+			sizeClass++;
+		}
+		return sizeClass;
+	}
+
+	u32 getLargestInList(AllocHeaderFree* header)
+	{
+		u32 largest = 0;
+		for (; header; header = header->binNext)
+		{
+			largest = max(largest, header->size);
+		}
+		return largest;
+	}
+
+	// Only the highest non-empty bin needs to be searched, since the bins are ordered by size.
+	u32 getLargestFree(MemoryBlock* block)
+	{
+		if (block->strategy == REGION_ALLOC_TLSF)
+		{
+			if (!block->flBitmap) { return 0; }
+			const s32 fl = TFE_Math::bitScanReverse(block->flBitmap);
+			const s32 sl = TFE_Math::bitScanReverse(block->slBitmap[fl]);
+			return getLargestInList(block->tlsfBins[fl][sl]);
+		}
+		for (s32 b = ALLOC_BIN_LAST; b >= 0; b--)
+		{
+			if (block->freeListBins[b]) { return getLargestInList(block->freeListBins[b]); }
+		}
+		return 0;
+	}
+
+	void region_getTelemetry(MemoryRegion* region, RegionTelemetry* telemetry, bool countFreeRanges)
+	{
+		memset(telemetry, 0, sizeof(RegionTelemetry));
+		if (!region) { return; }
+
+		telemetry->capacity = region_getMemoryCapacity(region);
+		for (s32 i = 0; i < region->blockCount; i++)
+		{
+			MemoryBlock* block = region->memBlocks[i];
+			telemetry->freeTotal += block->sizeFree;
+			telemetry->largestFree = std::max(telemetry->largestFree, (size_t)getLargestFree(block));
+
+			if (!countFreeRanges) { continue; }
+			u8* memPtr = (u8*)block + sizeof(MemoryBlock);
+			for (u32 al = 0; al < block->count; al++)
+			{
+				RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
+				if (header->free)
+				{
+					telemetry->freeBlockCount++;
+					telemetry->freeListLength[region_getSizeClass(header->size)]++;
+				}
+				memPtr += header->size;
+			}
+		}
+		telemetry->used = telemetry->capacity - telemetry->freeTotal;
+		telemetry->fragmentation = telemetry->freeTotal ? 1.0f - f32(telemetry->largestFree) / f32(telemetry->freeTotal) : 0.0f;
+
+		region->highWater = std::max(region->highWater, telemetry->used);
+		telemetry->highWater = region->highWater;
+		telemetry->allocCount = region->allocCount;
+		telemetry->freeCount = region->freeCount;
+		memcpy(telemetry->allocHistogram, region->allocHistogram, sizeof(region->allocHistogram));
+	}
 		
 	RelativePointer region_getRelativePointer(MemoryRegion* region, void* ptr)
 	{
@@ -437,7 +815,7 @@ namespace TFE_Memory
 		for (s32 i = (s32)region->blockCount - 1; i >= 0; i--)
 		{
 			MemoryBlock* block = region->memBlocks[i];
-			if (ptr >= block)
+			if (blockContainsPtr(region, block, ptr))
 			{
 				rp = RelativePointer((u8*)ptr - (u8*)block - sizeof(MemoryBlock));
 				rp |= (i << c_relativeBlockShift);
@@ -484,6 +862,8 @@ namespace TFE_Memory
 		file->write(&region->blockCount);
 		file->write(&region->blockSize);
 		file->write(&region->maxBlocks);
+		u32 strategy = region->strategy;
+		file->write(&strategy);
 
 		for (s32 b = 0; b < region->blockCount; b++)
 		{
@@ -531,7 +911,11 @@ namespace TFE_Memory
 		if (!region)
 		{
 			region = (MemoryRegion*)malloc(sizeof(MemoryRegion));
-			region->blockArrCapacity = 0;
+			if (region)
+			{
+				memset(region, 0, sizeof(MemoryRegion));
+				region->backing = s_defaultBacking;
+			}
 		}
 		if (!region)
 		{
@@ -540,6 +924,7 @@ namespace TFE_Memory
 		}
 
 		size_t blockAllocStart = 0;
+		u32 strategy = REGION_ALLOC_FIRST_FIT;
 		file->readBuffer(region->name, 32);
 		if (region->blockArrCapacity == 0)
 		{
@@ -547,6 +932,7 @@ namespace TFE_Memory
 			file->read(&region->blockCount);
 			file->read(&region->blockSize);
 			file->read(&region->maxBlocks);
+			file->read(&strategy);
 			region->memBlocks = (MemoryBlock**)malloc(sizeof(MemoryBlock*)*region->blockArrCapacity);
 		}
 		else
@@ -556,6 +942,7 @@ namespace TFE_Memory
 			file->read(&blockCount);
 			file->read(&blockSize);
 			file->read(&maxBlocks);
+			file->read(&strategy);
 
 			// The region is just too different, we have to start again.
 			if (blockSize != region->blockSize)
@@ -563,7 +950,7 @@ namespace TFE_Memory
 				// Free memory since we have to reallocate from scratch.
 				for (s32 i = 0; i < region->blockCount; i++)
 				{
-					free(region->memBlocks[i]);
+					freeBlockMemory(region, region->memBlocks[i]);
 				}
 				free(region->memBlocks);
 
@@ -596,13 +983,14 @@ namespace TFE_Memory
 			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Failed to allocate region.");
 			return nullptr;
 		}
+		region->strategy = strategy < REGION_ALLOC_COUNT ? RegionAllocStrategy(strategy) : REGION_ALLOC_FIRST_FIT;
 		
 		for (s32 b = 0; b < region->blockCount; b++)
 		{
 			// Only allocate the block if it was not part of the original region passed in.
 			if (b >= blockAllocStart)
 			{
-				region->memBlocks[b] = (MemoryBlock*)malloc(sizeof(MemoryBlock) + region->blockSize);
+				region->memBlocks[b] = allocBlockMemory(region);
 			}
 
 			MemoryBlock* block = region->memBlocks[b];
@@ -615,6 +1003,7 @@ namespace TFE_Memory
 
 			file->read(&block->count);
 			file->read(&block->sizeFree);
+			clearFreelists(block);
 			for (s32 bin = 0; bin < ALLOC_BIN_COUNT; bin++)
 			{
 				RelativePointer ptr;
@@ -645,11 +1034,217 @@ namespace TFE_Memory
 
 				memPtr += header->size;
 			}
+
+			// TLSF bitmaps and list heads are not serialized, instead they are rebuilt from the free headers.
+			block->strategy = region->strategy;
+			if (block->strategy == REGION_ALLOC_TLSF)
+			{
+				rebuildFreelists(block);
+			}
 		}
 
 		return region;
 	}
 
+	//////////////////////////////////////////////////////
+	// Snapshots
+	//////////////////////////////////////////////////////
+	static const u32 c_snapshotMagic = 0x50534752;	// "RGSP"
+	static const u32 c_snapshotVersion = 1;
+
+	bool snapshot_reserve(RegionSnapshot* snapshot, size_t size)
+	{
+		if (size <= snapshot->dataCapacity) { return true; }
+		u8* data = (u8*)realloc(snapshot->data, size);
+		if (!data) { return false; }
+		snapshot->data = data;
+		snapshot->dataCapacity = size;
+		return true;
+	}
+
+	RegionSnapshot* snapshot_alloc(RegionSnapshot* snapshot)
+	{
+		if (snapshot) { return snapshot; }
+		snapshot = (RegionSnapshot*)malloc(sizeof(RegionSnapshot));
+		if (snapshot)
+		{
+			memset(snapshot, 0, sizeof(RegionSnapshot));
+		}
+		return snapshot;
+	}
+
+	size_t region_snapshotGetSize(const RegionSnapshot* snapshot)
+	{
+		return snapshot ? snapshot->blockCount * (sizeof(MemoryBlock) + snapshot->blockSize) : 0;
+	}
+
+	RegionSnapshot* region_snapshotCreate(MemoryRegion* region, RegionSnapshot* snapshot)
+	{
+		if (!region) { return nullptr; }
+		RegionSnapshot* result = snapshot_alloc(snapshot);
+		if (!result) { return nullptr; }
+
+		const size_t stride = sizeof(MemoryBlock) + region->blockSize;
+		if (!snapshot_reserve(result, stride * region->blockCount))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Cannot allocate %zu bytes for a snapshot of region '%s'.", stride * region->blockCount, region->name);
+			if (!snapshot) { region_snapshotFree(result); }
+			return nullptr;
+		}
+
+		strcpy(result->name, region->name);
+		result->blockSize = region->blockSize;
+		result->blockCount = u32(region->blockCount);
+		result->strategy = region->strategy;
+		for (s32 i = 0; i < region->blockCount; i++)
+		{
+			result->blockAddress[i] = u64(size_t(region->memBlocks[i]));
+			memcpy(result->data + i * stride, region->memBlocks[i], stride);
+		}
+		return result;
+	}
+
+	void region_snapshotFree(RegionSnapshot* snapshot)
+	{
+		if (!snapshot) { return; }
+		free(snapshot->data);
+		free(snapshot);
+	}
+
+	// Fix up the pointers owned by the allocator after a block has been copied to a new address.
+	// The free lists never cross blocks, so every pointer moves by the same amount.
+	void relocateBlock(MemoryBlock* block, u64 prevAddress)
+	{
+		const ptrdiff_t delta = ptrdiff_t(size_t(block) - size_t(prevAddress));
+		#define RELOCATE(ptr) if (ptr) { ptr = (AllocHeaderFree*)((u8*)(ptr) + delta); }
+
+		for (s32 b = 0; b < ALLOC_BIN_COUNT; b++)
+		{
+			RELOCATE(block->freeListBins[b]);
+		}
+		for (s32 fl = 0; fl < TLSF_FL_COUNT; fl++)
+		{
+			for (s32 sl = 0; sl < TLSF_SL_COUNT; sl++)
+			{
+				RELOCATE(block->tlsfBins[fl][sl]);
+			}
+		}
+
+		u8* memPtr = (u8*)block + sizeof(MemoryBlock);
+		for (u32 al = 0; al < block->count; al++)
+		{
+			AllocHeaderFree* header = (AllocHeaderFree*)memPtr;
+			if (header->free)
+			{
+				RELOCATE(header->binNext);
+				RELOCATE(header->binPrev);
+			}
+			memPtr += header->size;
+		}
+		#undef RELOCATE
+	}
+
+	bool region_snapshotRestore(MemoryRegion* region, const RegionSnapshot* snapshot, bool allowRelocation)
+	{
+		if (!region || !snapshot) { return false; }
+		if (snapshot->blockSize != region->blockSize)
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Cannot restore snapshot of '%s' into region '%s', the block sizes do not match.", snapshot->name, region->name);
+			return false;
+		}
+
+		bool relocate = snapshot->blockCount > region->blockCount;
+		for (s32 i = 0; i < region->blockCount && i < snapshot->blockCount && !relocate; i++)
+		{
+			relocate = u64(size_t(region->memBlocks[i])) != snapshot->blockAddress[i];
+		}
+		if (relocate && !allowRelocation)
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Cannot restore snapshot of '%s' into region '%s', the memory blocks have moved.", snapshot->name, region->name);
+			return false;
+		}
+		while (region->blockCount < snapshot->blockCount)
+		{
+			if (!allocateNewBlock(region)) { return false; }
+		}
+
+		const size_t stride = sizeof(MemoryBlock) + region->blockSize;
+		region->strategy = RegionAllocStrategy(snapshot->strategy);
+		for (s32 i = 0; i < region->blockCount; i++)
+		{
+			MemoryBlock* block = region->memBlocks[i];
+			if (i >= snapshot->blockCount)
+			{
+				// The region grew after the snapshot was taken.
+				resetBlock(region, block);
+				continue;
+			}
+
+			memcpy(block, snapshot->data + i * stride, stride);
+			if (u64(size_t(block)) != snapshot->blockAddress[i])
+			{
+				relocateBlock(block, snapshot->blockAddress[i]);
+			}
+		}
+		VERIFY_MEMORY();
+		return true;
+	}
+
+	bool region_snapshotWrite(const RegionSnapshot* snapshot, Stream* stream)
+	{
+		if (!snapshot || !stream) { return false; }
+
+		const u64 dataSize = region_snapshotGetSize(snapshot);
+		if (dataSize > 0xffffffffull) { return false; }
+
+		const u32 magic = c_snapshotMagic;
+		const u32 version = c_snapshotVersion;
+		const u32 blockHeaderSize = sizeof(MemoryBlock);
+		stream->write(&magic);
+		stream->write(&version);
+		stream->write(&blockHeaderSize);
+		stream->writeBuffer(snapshot->name, 32);
+		stream->write(&snapshot->blockSize);
+		stream->write(&snapshot->blockCount);
+		stream->write(&snapshot->strategy);
+		stream->write(snapshot->blockAddress, snapshot->blockCount);
+		stream->writeBuffer(snapshot->data, u32(dataSize));
+		return true;
+	}
+
+	RegionSnapshot* region_snapshotRead(Stream* stream, RegionSnapshot* snapshot)
+	{
+		if (!stream) { return nullptr; }
+
+		u32 magic, version, blockHeaderSize;
+		stream->read(&magic);
+		stream->read(&version);
+		stream->read(&blockHeaderSize);
+		// The block images include the MemoryBlock header, so its layout must match as well.
+		if (magic != c_snapshotMagic || version != c_snapshotVersion || blockHeaderSize != sizeof(MemoryBlock))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Invalid or incompatible region snapshot.");
+			return nullptr;
+		}
+
+		RegionSnapshot* result = snapshot_alloc(snapshot);
+		if (!result) { return nullptr; }
+		stream->readBuffer(result->name, 32);
+		stream->read(&result->blockSize);
+		stream->read(&result->blockCount);
+		stream->read(&result->strategy);
+		if (result->blockCount > MAX_BLOCK_COUNT || result->blockSize > MAX_BLOCK_SIZE || result->strategy >= REGION_ALLOC_COUNT ||
+			!snapshot_reserve(result, region_snapshotGetSize(result)))
+		{
+			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Invalid region snapshot '%s'.", result->name);
+			if (!snapshot) { region_snapshotFree(result); }
+			return nullptr;
+		}
+		stream->read(result->blockAddress, result->blockCount);
+		stream->readBuffer(result->data, u32(region_snapshotGetSize(result)));
+		return result;
+	}
+
 	void freeSlot(RegionAllocHeader* alloc, RegionAllocHeader* next, MemoryBlock* block)
 	{
 		block->sizeFree += alloc->size;
@@ -684,15 +1279,111 @@ namespace TFE_Memory
 		return 5;
 	}
 
+	//////////////////////////////////////////////////////
+	// TLSF
+	//////////////////////////////////////////////////////
+	void tlsf_mapping(u32 size, s32* fl, s32* sl)
+	{
+		if (size < TLSF_SMALL_SIZE)
+		{
+			*fl = 0;
+			*sl = s32(size >> TLSF_ALIGN_LOG2);
+		}
+		else
+		{
+			const s32 log2 = TFE_Math::bitScanReverse(size);
+			*sl = s32(size >> (log2 - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+			*fl = log2 - TLSF_FL_SHIFT + 1;
+		}
+		assert(*fl < TLSF_FL_COUNT && *sl < TLSF_SL_COUNT);
+	}
+
+	AllocHeaderFree* tlsf_findFreeHeader(MemoryBlock* block, u32 size)
+	{
+		// Round the size up to the next second level bin, so any header in the bin found is large enough.
+		u32 searchSize = size;
+		if (size >= TLSF_SMALL_SIZE)
+		{
+			searchSize += (1u << (TFE_Math::bitScanReverse(size) - TLSF_SL_LOG2)) - 1u;
+		}
+		s32 fl, sl;
+		tlsf_mapping(searchSize, &fl, &sl);
+
+		u32 slMap = fl < TLSF_FL_COUNT ? block->slBitmap[fl] & (~0u << sl) : 0u;
+		if (!slMap)
+		{
+			const u32 flMap = fl + 1 < TLSF_FL_COUNT ? block->flBitmap & (~0u << (fl + 1)) : 0u;
+			if (flMap)
+			{
+				fl = TFE_Math::bitScanForward(flMap);
+				slMap = block->slBitmap[fl];
+			}
+		}
+		if (slMap)
+		{
+			return block->tlsfBins[fl][TFE_Math::bitScanForward(slMap)];
+		}
+
+		// Rounding up can skip over a header that is just large enough, which matters near the end of a block.
+		// Check the exact bin before giving up on this block.
+		tlsf_mapping(size, &fl, &sl);
+		AllocHeaderFree* header = block->tlsfBins[fl][sl];
+		while (header && header->size < size)
+		{
+			header = header->binNext;
+		}
+		return header;
+	}
+
+	//////////////////////////////////////////////////////
+	// Free lists
+	//////////////////////////////////////////////////////
+	AllocHeaderFree* findFreeHeader(MemoryBlock* block, u32 size)
+	{
+		if (block->strategy == REGION_ALLOC_TLSF)
+		{
+			return tlsf_findFreeHeader(block, size);
+		}
+
+		// Try to allocate from the closest matching bin.
+		s32 bin = getBinFromSize(size);
+		for (s32 b = bin; b < ALLOC_BIN_COUNT; b++)
+		{
+			AllocHeaderFree* header = block->freeListBins[b];
+			while (header)
+			{
+				if (header->size >= size)
+				{
+					return header;
+				}
+				header = header->binNext;
+			}
+		}
+		return nullptr;
+	}
+
+	AllocHeaderFree** getFreelistHead(MemoryBlock* block, AllocHeaderFree* freeHeader)
+	{
+		if (block->strategy == REGION_ALLOC_TLSF)
+		{
+			assert(freeHeader->bin < TLSF_FL_COUNT && freeHeader->pad8[0] < TLSF_SL_COUNT);
+			return &block->tlsfBins[freeHeader->bin][freeHeader->pad8[0]];
+		}
+		assert(freeHeader->bin < ALLOC_BIN_COUNT);
+		return &block->freeListBins[freeHeader->bin];
+	}
+
 	void removeHeaderFromFreelist(MemoryBlock* block, RegionAllocHeader* header)
 	{
 		AllocHeaderFree* freeHeader = (AllocHeaderFree*)header;
 		assert(freeHeader->free == 1);
-		assert(freeHeader->bin < ALLOC_BIN_COUNT);
 
-		u8 bin = freeHeader->bin;
+		AllocHeaderFree** head = getFreelistHead(block, freeHeader);
+		const u8 fl = freeHeader->bin;
+		const u8 sl = freeHeader->pad8[0];
 		freeHeader->free = 0;
 		freeHeader->bin = 0;
+		freeHeader->pad8[0] = 0;
 		if (freeHeader->binPrev)
 		{
 			AllocHeaderFree* nextFree = freeHeader->binNext;
@@ -705,19 +1396,27 @@ namespace TFE_Memory
 		}
 		else if (freeHeader->binNext)
 		{
-			assert(freeHeader == block->freeListBins[bin]);
-			if (freeHeader == block->freeListBins[bin])
+			assert(freeHeader == *head);
+			if (freeHeader == *head)
 			{
-				block->freeListBins[bin] = freeHeader->binNext;
-				block->freeListBins[bin]->binPrev = nullptr;
+				*head = freeHeader->binNext;
+				(*head)->binPrev = nullptr;
 			}
 		}
 		else
 		{
-			assert(freeHeader->binPrev || freeHeader == block->freeListBins[bin]);
-			if (freeHeader == block->freeListBins[bin])
+			assert(freeHeader->binPrev || freeHeader == *head);
+			if (freeHeader == *head)
 			{
-				block->freeListBins[bin] = nullptr;
+				*head = nullptr;
+				if (block->strategy == REGION_ALLOC_TLSF)
+				{
+					block->slBitmap[fl] &= ~(1u << sl);
+					if (!block->slBitmap[fl])
+					{
+						block->flBitmap &= ~(1u << fl);
+					}
+				}
 			}
 		}
 	}
@@ -726,27 +1425,80 @@ namespace TFE_Memory
 	{
 		AllocHeaderFree* freeNext = (AllocHeaderFree*)header;
 		assert(freeNext->free == 0);
-		s32 bin = getBinFromSize(header->size);
 		freeNext->free = 1;
-		freeNext->bin = bin;
 		freeNext->pad8[0] = 0;
 		freeNext->pad8[1] = 0;
-		if (!block->freeListBins[bin])
+		if (block->strategy == REGION_ALLOC_TLSF)
+		{
+			s32 fl, sl;
+			tlsf_mapping(header->size, &fl, &sl);
+			freeNext->bin = u8(fl);
+			freeNext->pad8[0] = u8(sl);
+			block->flBitmap |= (1u << fl);
+			block->slBitmap[fl] |= (1u << sl);
+		}
+		else
+		{
+			freeNext->bin = getBinFromSize(header->size);
+		}
+
+		AllocHeaderFree** head = getFreelistHead(block, freeNext);
+		if (!*head)
 		{
-			block->freeListBins[bin] = freeNext;
+			*head = freeNext;
 			freeNext->binPrev = nullptr;
 			freeNext->binNext = nullptr;
 		}
 		else
 		{
-			block->freeListBins[bin]->binPrev = freeNext;
-			freeNext->binNext = block->freeListBins[bin];
+			(*head)->binPrev = freeNext;
+			freeNext->binNext = *head;
 			freeNext->binPrev = nullptr;
 
-			block->freeListBins[bin] = freeNext;
+			*head = freeNext;
+		}
+	}
+
+	void clearFreelists(MemoryBlock* block)
+	{
+		memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
+		memset(block->tlsfBins, 0, sizeof(block->tlsfBins));
+		memset(block->slBitmap, 0, sizeof(block->slBitmap));
+		block->flBitmap = 0;
+	}
+
+	// Rebuild the free lists of a block by walking its headers, the header sizes and free flags must be valid.
+	void rebuildFreelists(MemoryBlock* block)
+	{
+		clearFreelists(block);
+		u8* memPtr = (u8*)block + sizeof(MemoryBlock);
+		for (u32 al = 0; al < block->count; al++)
+		{
+			RegionAllocHeader* header = (RegionAllocHeader*)memPtr;
+			if (header->free)
+			{
+				header->free = 0;
+				insertBlockIntoFreelist(block, header);
+			}
+			memPtr += header->size;
 		}
 	}
 
+	// Reset a block so that its memory is a single free header.
+	void resetBlock(MemoryRegion* region, MemoryBlock* block)
+	{
+		block->sizeFree = u32(region->blockSize);
+		block->count = 1;
+		block->strategy = region->strategy;
+		block->pad32 = 0;
+
+		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
+		header->size = block->sizeFree;
+		header->free = 0;
+		clearFreelists(block);
+		insertBlockIntoFreelist(block, header);
+	}
+
 	bool allocateNewBlock(MemoryRegion* region)
 	{
 		if (region->blockCount >= MAX_BLOCK_COUNT)
@@ -773,7 +1525,7 @@ namespace TFE_Memory
 
 		size_t blockIndex = region->blockCount;
 		assert(blockIndex < region->blockArrCapacity);
-		region->memBlocks[blockIndex] = (MemoryBlock*)malloc(sizeof(MemoryBlock) + region->blockSize);
+		region->memBlocks[blockIndex] = allocBlockMemory(region);
 		if (!region->memBlocks[blockIndex])
 		{
 			TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Failed to allocate block of size %u in region '%s'.", region->blockSize, region->name);
@@ -782,19 +1534,111 @@ namespace TFE_Memory
 		region->blockCount++;
 		TFE_System::logWrite(LOG_MSG, "MemoryRegion", "Allocated new memory block in region '%s' - new size is %u blocks, total size is '%u'", region->name, region->blockCount, region->blockSize * region->blockCount);
 
-		MemoryBlock* block = region->memBlocks[blockIndex];
-		block->sizeFree = u32(region->blockSize);
-		block->count = 1;
+		resetBlock(region, region->memBlocks[blockIndex]);
+		return true;
+	}
 
-		RegionAllocHeader* header = (RegionAllocHeader*)((u8*)block + sizeof(MemoryBlock));
-		header->size = block->sizeFree;
-		header->free = 0;
-		memset(block->freeListBins, 0, sizeof(AllocHeaderFree*)*ALLOC_BIN_COUNT);
-		insertBlockIntoFreelist(block, header);
+	bool region_reserve(MemoryRegion* region, size_t size)
+	{
+		if (!region) { return false; }
+		const size_t prevBlockCount = region->blockCount;
+		while (region->blockCount * region->blockSize < size)
+		{
+			if ((region->maxBlocks && region->blockCount >= region->maxBlocks) || !allocateNewBlock(region))
+			{
+				return false;
+			}
+		}
 
+		// New blocks are pre-faulted when they are allocated, blocks from before may still have untouched pages.
+		if (region->backing & REGION_BACKING_PREFAULT)
+		{
+			for (size_t i = 0; i < prevBlockCount; i++)
+			{
+				prefaultBlock(region, region->memBlocks[i]);
+			}
+		}
 		return true;
 	}
 
+	size_t getBlockAllocSize(MemoryRegion* region)
+	{
+		const size_t size = sizeof(MemoryBlock) + region->blockSize;
+	#ifdef __linux__
+		if (region->backing & REGION_BACKING_HUGE_PAGES)
+		{
+			return (size + HUGE_PAGE_SIZE - 1) & ~size_t(HUGE_PAGE_SIZE - 1);
+		}
+	#endif
+		return size;
+	}
+
+	MemoryBlock* allocBlockMemory(MemoryRegion* region)
+	{
+		MemoryBlock* block = nullptr;
+	#ifdef __linux__
+		if (region->backing & REGION_BACKING_HUGE_PAGES)
+		{
+			// Over-allocate so the block can start on a huge page boundary, then unmap the unused head and tail.
+			const size_t size = getBlockAllocSize(region);
+			u8* mem = (u8*)mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (mem == MAP_FAILED)
+			{
+				TFE_System::logWrite(LOG_ERROR, "MemoryRegion", "Failed to map %zu bytes for region '%s'.", size, region->name);
+				return nullptr;
+			}
+			u8* aligned = (u8*)((size_t(mem) + HUGE_PAGE_SIZE - 1) & ~size_t(HUGE_PAGE_SIZE - 1));
+			const size_t head = size_t(aligned - mem);
+			const size_t tail = HUGE_PAGE_SIZE - head;
+			if (head) { munmap(mem, head); }
+			if (tail) { munmap(aligned + size, tail); }
+
+			// This is only a hint, if transparent huge pages are disabled the block is still usable.
+			if (madvise(aligned, size, MADV_HUGEPAGE) != 0)
+			{
+				TFE_System::logWrite(LOG_WARNING, "MemoryRegion", "Transparent huge pages are not available for region '%s'.", region->name);
+			}
+			block = (MemoryBlock*)aligned;
+		}
+		else
+	#endif
+		{
+			block = (MemoryBlock*)malloc(sizeof(MemoryBlock) + region->blockSize);
+		}
+
+		if (block && (region->backing & REGION_BACKING_PREFAULT))
+		{
+			prefaultBlock(region, block);
+		}
+		return block;
+	}
+
+	void freeBlockMemory(MemoryRegion* region, MemoryBlock* block)
+	{
+		if (!block) { return; }
+	#ifdef __linux__
+		if (region->backing & REGION_BACKING_HUGE_PAGES)
+		{
+			munmap(block, getBlockAllocSize(region));
+			return;
+		}
+	#endif
+		free(block);
+	}
+
+	// Write to every page so the OS commits the memory now rather than on first use.
+	// Writing back the existing value keeps the contents of blocks that are already in use intact.
+	void prefaultBlock(MemoryRegion* region, MemoryBlock* block)
+	{
+		volatile u8* mem = (volatile u8*)block;
+		const size_t size = sizeof(MemoryBlock) + region->blockSize;
+		for (size_t offset = 0; offset < size; offset += PREFAULT_PAGE_SIZE)
+		{
+			mem[offset] = mem[offset];
+		}
+		mem[size - 1] = mem[size - 1];
+	}
+
 	// 20k allocations and 1250 deallocations:
 	// Malloc = 0.005514 sec.
 	// Region = 0.000991 sec.
@@ -822,21 +1666,194 @@ namespace TFE_Memory
 			free(alloc[i]);
 		}
 
-		MemoryRegion* region = region_create("Test", 32 * 1024 * 1024);
-		start = TFE_System::getCurrentTimeInTicks();
-		for (s32 i = 0; i < ALLOC_COUNT; i++)
+		// Time each region strategy with the same allocation pattern.
+		const RegionAllocStrategy prevStrategy = s_defaultStrategy;
+		u64 regionDelta[REGION_ALLOC_COUNT];
+		for (s32 s = 0; s < REGION_ALLOC_COUNT; s++)
 		{
-			alloc[i] = region_alloc(region, _testAllocSize[i&mask]);
-			if ((i % 16) == 0)
+			s_defaultStrategy = RegionAllocStrategy(s);
+			MemoryRegion* region = region_create("Test", 16 * 1024 * 1024);
+			start = TFE_System::getCurrentTimeInTicks();
+			for (s32 i = 0; i < ALLOC_COUNT; i++)
 			{
-				region_free(region, alloc[i]);
-				alloc[i] = nullptr;
+				alloc[i] = region_alloc(region, _testAllocSize[i&mask]);
+				if ((i % 16) == 0)
+				{
+					region_free(region, alloc[i]);
+					alloc[i] = nullptr;
+				}
 			}
+			regionDelta[s] = TFE_System::getCurrentTimeInTicks() - start;
+			// Free memory.
+			region_destroy(region);
 		}
-		u64 regionDelta = TFE_System::getCurrentTimeInTicks() - start;
-		// Free memory.
-		region_destroy(region);
+		s_defaultStrategy = prevStrategy;
+
+		TFE_System::logWrite(LOG_MSG, "MemoryRegion", "Malloc: %f, Region (first-fit): %f, Region (TLSF): %f", TFE_System::convertFromTicksToSeconds(mallocDelta),
+			TFE_System::convertFromTicksToSeconds(regionDelta[REGION_ALLOC_FIRST_FIT]), TFE_System::convertFromTicksToSeconds(regionDelta[REGION_ALLOC_TLSF]));
+	}
 
-		TFE_System::logWrite(LOG_MSG, "MemoryRegion", "Malloc: %f, Region: %f", TFE_System::convertFromTicksToSeconds(mallocDelta), TFE_System::convertFromTicksToSeconds(regionDelta));
+	//////////////////////////////////////////////////////
+	// Console commands
+	//////////////////////////////////////////////////////
+	static const char* c_regionAllocStrategyName[REGION_ALLOC_COUNT] =
+	{
+		"firstfit",	// REGION_ALLOC_FIRST_FIT
+		"tlsf",		// REGION_ALLOC_TLSF
+	};
+
+	// Get the regions named in the command arguments, or every live region if none are named.
+	bool getCmdRegions(const ConsoleArgList& args, std::vector<MemoryRegion*>& regions)
+	{
+		if (args.size() < 2)
+		{
+			regions = s_regions;
+			return true;
+		}
+
+		regions.clear();
+		for (size_t i = 1; i < args.size(); i++)
+		{
+			MemoryRegion* region = region_find(args[i].c_str());
+			if (!region)
+			{
+				char res[256];
+				sprintf(res, "Unknown region '%s'.", args[i].c_str());
+				TFE_Console::addToHistory(res);
+				return false;
+			}
+			regions.push_back(region);
+		}
+		return true;
+	}
+
+	void setRegionAllocator(const ConsoleArgList& args)
+	{
+		char res[256];
+		if (args.size() >= 2)
+		{
+			s32 strategy = -1;
+			for (s32 i = 0; i < REGION_ALLOC_COUNT; i++)
+			{
+				if (strcasecmp(args[1].c_str(), c_regionAllocStrategyName[i]) == 0)
+				{
+					strategy = i;
+					break;
+				}
+			}
+			if (strategy < 0)
+			{
+				sprintf(res, "Invalid allocator '%s', valid values are: firstfit, tlsf.", args[1].c_str());
+				TFE_Console::addToHistory(res);
+				return;
+			}
+			region_setDefaultStrategy(RegionAllocStrategy(strategy));
+		}
+
+		sprintf(res, "Default: %s - regions switch the next time they are cleared (such as the level region on level load).", c_regionAllocStrategyName[s_defaultStrategy]);
+		TFE_Console::addToHistory(res);
+		for (size_t i = 0; i < s_regions.size(); i++)
+		{
+			sprintf(res, "  %s: %s", s_regions[i]->name, c_regionAllocStrategyName[s_regions[i]->strategy]);
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	void displayRegionTelemetry(MemoryRegion* region)
+	{
+		char res[256];
+		RegionTelemetry telemetry;
+		region_getTelemetry(region, &telemetry, true);
+
+		sprintf(res, "Region '%s' - %s allocator", region->name, c_regionAllocStrategyName[region->strategy]);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "  Used: %zu, Peak: %zu, Capacity: %zu", telemetry.used, telemetry.highWater, telemetry.capacity);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "  Free: %zu in %u ranges, Largest Free: %zu, Fragmentation: %.1f%%", telemetry.freeTotal, telemetry.freeBlockCount, telemetry.largestFree, telemetry.fragmentation * 100.0f);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "  Allocations: %llu, Frees: %llu", (unsigned long long)telemetry.allocCount, (unsigned long long)telemetry.freeCount);
+		TFE_Console::addToHistory(res);
+		TFE_Console::addToHistory("  Size Class      | Free Ranges | Allocations");
+		for (s32 i = 0; i < REGION_SIZE_CLASS_COUNT; i++)
+		{
+			if (!telemetry.freeListLength[i] && !telemetry.allocHistogram[i]) { continue; }
+
+			const u32 minSize = i ? 1u << (REGION_SIZE_CLASS_SHIFT + i - 1) : 0u;
+			if (i == REGION_SIZE_CLASS_COUNT - 1) { sprintf(res, "  %7u+         | %11u | %11u", minSize, telemetry.freeListLength[i], telemetry.allocHistogram[i]); }
+			else { sprintf(res, "  %7u - %-7u | %11u | %11u", minSize, (1u << (REGION_SIZE_CLASS_SHIFT + i)) - 1, telemetry.freeListLength[i], telemetry.allocHistogram[i]); }
+			TFE_Console::addToHistory(res);
+		}
+	}
+
+	void displayRegionStats(const ConsoleArgList& args)
+	{
+		std::vector<MemoryRegion*> regions;
+		if (!getCmdRegions(args, regions)) { return; }
+		for (size_t i = 0; i < regions.size(); i++)
+		{
+			displayRegionTelemetry(regions[i]);
+		}
+	}
+
+	void displayRegionTags(const ConsoleArgList& args)
+	{
+	#ifdef TFE_REGION_TAGS
+		std::vector<MemoryRegion*> regions;
+		if (!getCmdRegions(args, regions)) { return; }
+
+		char res[256];
+		std::vector<RegionTagUsage> usage;
+		for (size_t r = 0; r < regions.size(); r++)
+		{
+			region_getTagUsage(regions[r], usage);
+
+			sprintf(res, "Region '%s'", regions[r]->name);
+			TFE_Console::addToHistory(res);
+			TFE_Console::addToHistory("  Tag                              |  Memory Used | Allocations");
+			for (size_t i = 0; i < usage.size(); i++)
+			{
+				sprintf(res, "  %-32s | %12zu | %11u", usage[i].tag, usage[i].size, usage[i].count);
+				TFE_Console::addToHistory(res);
+			}
+		}
+	#else
+		TFE_Console::addToHistory("Allocation tags are not available, rebuild with ENABLE_REGION_TAGS (TFE_REGION_TAGS).");
+	#endif
+	}
+
+	// Time a wholesale snapshot of the regions, for comparison against a regular save.
+	// Restoring is not exposed here since the game state outside of the regions is not captured.
+	void timeRegionSnapshot(const ConsoleArgList& args)
+	{
+		std::vector<MemoryRegion*> regions;
+		if (!getCmdRegions(args, regions)) { return; }
+		if (s_cmdSnapshots.size() < regions.size())
+		{
+			s_cmdSnapshots.resize(regions.size(), nullptr);
+		}
+
+		char res[256];
+		size_t size = 0;
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (size_t i = 0; i < regions.size(); i++)
+		{
+			s_cmdSnapshots[i] = region_snapshotCreate(regions[i], s_cmdSnapshots[i]);
+		}
+		const f64 ms = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start) * 1000.0;
+
+		for (size_t i = 0; i < regions.size(); i++)
+		{
+			size += region_snapshotGetSize(s_cmdSnapshots[i]);
+		}
+		sprintf(res, "Snapshot of %zu regions: %zu KB in %.3f ms.", regions.size(), size >> 10, ms);
+		TFE_Console::addToHistory(res);
+	}
+
+	void registerConsoleCommands()
+	{
+		CCMD("regionStats", displayRegionStats, 0, "Display region telemetry: fragmentation, peak usage, free ranges and allocation sizes. Optionally pass region names (such as 'game' or 'level') to show only those regions.");
+		CCMD("regionTags", displayRegionTags, 0, "Display live memory per allocation tag (subsystem), requires a build with TFE_REGION_TAGS. Optionally pass region names to show only those regions.");
+		CCMD("regionSnapshotTime", timeRegionSnapshot, 0, "Experimental: time a wholesale in-memory snapshot of every region, or only the named regions.");
+		CCMD("regionAllocator", setRegionAllocator, 0, "Get or set the memory region allocator - valid values are: firstfit, tlsf. Example: regionAllocator tlsf");
 	}
 }
\ No newline at end of file
@@ -8,24 +8,130 @@
 #include <vector>
 #include <string>
 
+// Define TFE_REGION_TAGS (ENABLE_REGION_TAGS in CMake) to record the subsystem tag passed to region_allocTagged()
+// in each allocation header, so that 'regionTags' can report memory usage per subsystem. This has no cost when disabled.
+// #define TFE_REGION_TAGS
+
+// Subsystem tags, allocations made through region_alloc() and region_realloc() are reported as "untagged".
+#define REGION_TAG_RENDERER "Renderer"
+#define REGION_TAG_LEVEL    "Level"
+#define REGION_TAG_INF      "INF"
+#define REGION_TAG_AUDIO    "Audio"
+
 struct MemoryRegion;
+struct RegionSnapshot;
 typedef u32 RelativePointer;
 
 #define NULL_RELATIVE_POINTER 0
 
+enum RegionAllocStrategy
+{
+	REGION_ALLOC_FIRST_FIT = 0,	// Original allocator: first-fit search through 6 power of 2 size bins.
+	REGION_ALLOC_TLSF,			// Two-level segregated fit, constant time allocation and free.
+	REGION_ALLOC_COUNT
+};
+
+// How region blocks are backed, set per region when it is created.
+enum RegionBackingFlags
+{
+	REGION_BACKING_DEFAULT    = 0,		// Blocks are allocated with malloc() and faulted in as they are used.
+	REGION_BACKING_HUGE_PAGES = 1 << 0,	// Linux: map blocks directly and request transparent huge pages, ignored elsewhere.
+	REGION_BACKING_PREFAULT   = 1 << 1,	// Touch every page when a block is allocated, so the page faults happen up front.
+};
+
+enum RegionTelemetryConstants
+{
+	// Size classes used for telemetry, class 0 = [0, 32), class 1 = [32, 64), ... the last class holds everything 512KB and above.
+	REGION_SIZE_CLASS_COUNT = 16,
+	REGION_SIZE_CLASS_SHIFT = 5,
+};
+
+struct RegionTagUsage
+{
+	const char* tag;	// Source file that made the allocations, or "untagged".
+	size_t size;		// Bytes currently allocated, including headers.
+	u32 count;			// Live allocations.
+};
+
+enum RegionTraceOpType
+{
+	RTRACE_ALLOC = 0,
+	RTRACE_REALLOC,
+	RTRACE_FREE,
+	RTRACE_CLEAR,	// region_clear(), everything allocated so far is released.
+};
+
+// A single recorded region call, pointers are only used to match up allocations when replaying a trace.
+struct RegionTraceOp
+{
+	u32 type;		// RegionTraceOpType
+	u32 size;		// Requested size, 0 for RTRACE_FREE and RTRACE_CLEAR.
+	u64 ptr;		// Returned pointer for alloc/realloc, freed pointer for RTRACE_FREE.
+	u64 prevPtr;	// Pointer passed into realloc.
+};
+
+struct RegionTelemetry
+{
+	size_t used;
+	size_t capacity;
+	size_t highWater;		// Highest 'used' value seen by region_getTelemetry().
+	size_t freeTotal;
+	size_t largestFree;		// Largest single free range, the largest allocation possible without adding a block.
+	f32    fragmentation;	// External fragmentation: 1 - largestFree / freeTotal.
+	u64    allocCount;		// Running totals, sample twice to get per-frame counts.
+	u64    freeCount;
+	u32    allocHistogram[REGION_SIZE_CLASS_COUNT];
+	// Only filled in when 'countFreeRanges' is true.
+	u32    freeBlockCount;
+	u32    freeListLength[REGION_SIZE_CLASS_COUNT];
+};
+
 namespace TFE_Memory
 {
+	// The strategy used for newly created regions. Existing regions switch over the next time they are cleared,
+	// since the free lists can only be rebuilt when nothing is allocated.
+	void region_setDefaultStrategy(RegionAllocStrategy strategy);
+	RegionAllocStrategy region_getDefaultStrategy();
+	RegionAllocStrategy region_getStrategy(MemoryRegion* region);
+	// Backing flags (RegionBackingFlags) for newly created regions.
+	void region_setDefaultBacking(u32 flags);
+	u32  region_getDefaultBacking();
+
 	MemoryRegion* region_create(const char* name, size_t blockSize, size_t maxSize = 0u);
 	void region_clear(MemoryRegion* region);
 	void region_destroy(MemoryRegion* region);
+	// Allocate blocks up front until the region can hold at least 'size' bytes, and pre-fault every block if the
+	// region was created with REGION_BACKING_PREFAULT. Call this while loading to avoid growing the region mid-level.
+	// Returns false if the region cannot grow to the requested size.
+	bool region_reserve(MemoryRegion* region, size_t size);
 
 	void* region_alloc(MemoryRegion* region, size_t size);
 	void* region_realloc(MemoryRegion* region, void* ptr, size_t size);
 	void  region_free(MemoryRegion* region, void* ptr);
+	// Allocate and record 'tag' in the allocation header, the tag must be a string literal (such as REGION_TAG_LEVEL)
+	// or otherwise outlive the region.
+	// Without TFE_REGION_TAGS these are the same as region_alloc() and region_realloc().
+	void* region_allocTagged(MemoryRegion* region, size_t size, const char* tag);
+	void* region_reallocTagged(MemoryRegion* region, void* ptr, size_t size, const char* tag);
+	// Live memory per tag, sorted from largest to smallest. Empty without TFE_REGION_TAGS.
+	void  region_getTagUsage(MemoryRegion* region, std::vector<RegionTagUsage>& usage);
 
 	size_t region_getMemoryUsed(MemoryRegion* region);
 	size_t region_getMemoryCapacity(MemoryRegion* region);
 	void region_getBlockInfo(MemoryRegion* region, size_t* blockCount, size_t* blockSize);
+	// Fill in the region telemetry. Counting free ranges walks every allocation header, so it is optional.
+	void region_getTelemetry(MemoryRegion* region, RegionTelemetry* telemetry, bool countFreeRanges = false);
+	s32  region_getSizeClass(size_t size);
+	const char* region_getName(MemoryRegion* region);
+	// Find a live region by name (case insensitive), returns null if there is no such region.
+	MemoryRegion* region_find(const char* name);
+
+	// Record every alloc, realloc and free made on the region until region_endTrace() is called.
+	// Only calls made from outside the region are recorded, internal reallocations are not.
+	void region_beginTrace(MemoryRegion* region);
+	// Stop recording and move the recorded operations into 'ops'.
+	void region_endTrace(MemoryRegion* region, std::vector<RegionTraceOp>& ops);
+	bool region_isTracing(MemoryRegion* region);
 
 	RelativePointer region_getRelativePointer(MemoryRegion* region, void* ptr);
 	void* region_getRealPointer(MemoryRegion* region, RelativePointer ptr);
@@ -36,5 +142,19 @@ namespace TFE_Memory
 	// otherwise it will attempt to reuse the existing region.
 	MemoryRegion* region_restoreFromDisk(MemoryRegion* region, FileStream* file);
 
+	// Experimental: snapshot the region wholesale, one copy per block rather than walking each allocation.
+	// Pass in a previous snapshot to reuse its memory.
+	RegionSnapshot* region_snapshotCreate(MemoryRegion* region, RegionSnapshot* snapshot = nullptr);
+	void region_snapshotFree(RegionSnapshot* snapshot);
+	size_t region_snapshotGetSize(const RegionSnapshot* snapshot);
+	// Restore the region contents from a snapshot taken from a region with the same block size.
+	// If the region still owns the blocks the snapshot was taken from, the restore is a straight copy and raw pointers
+	// into the region stay valid. Otherwise the blocks are relocated, which only fixes up the allocator bookkeeping, so
+	// 'allowRelocation' should only be set if the region data refers to itself using RelativePointers.
+	bool region_snapshotRestore(MemoryRegion* region, const RegionSnapshot* snapshot, bool allowRelocation = false);
+	// Write or read a snapshot with a single large buffer write/read.
+	bool region_snapshotWrite(const RegionSnapshot* snapshot, Stream* stream);
+	RegionSnapshot* region_snapshotRead(Stream* stream, RegionSnapshot* snapshot = nullptr);
+
 	void region_test();
 }
\ No newline at end of file
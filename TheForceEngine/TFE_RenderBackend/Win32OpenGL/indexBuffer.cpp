@@ -41,6 +41,13 @@ void IndexBuffer::update(const void* buffer, size_t size)
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+void IndexBuffer::updateRange(const void* buffer, size_t offset, size_t size)
+{
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gpuHandle);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)offset, (GLsizeiptr)size, (const GLvoid*)buffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
 u32 IndexBuffer::bind() const
 {
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gpuHandle);
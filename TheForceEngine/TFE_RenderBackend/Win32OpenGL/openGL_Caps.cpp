@@ -11,6 +11,7 @@ enum CapabilityFlags
 	CAP_UBO = (1 << 3),
 	CAP_NON_POW_2 = (1 << 4),
 	CAP_TEXTURE_ARRAY = (1 << 5),
+	CAP_PROGRAM_BINARY = (1 << 6),
 
 	CAP_2_1_FULL = (CAP_VBO | CAP_PBO | CAP_NON_POW_2),
 	CAP_3_3_FULL = (CAP_PBO | CAP_VBO | CAP_FBO | CAP_UBO | CAP_NON_POW_2 | CAP_TEXTURE_ARRAY)
@@ -37,6 +38,13 @@ namespace OpenGL_Caps
 		if (GLEW_ARB_uniform_buffer_object){ m_supportFlags |= CAP_UBO; }
 		if (GLEW_ARB_pixel_buffer_object)  { m_supportFlags |= CAP_NON_POW_2; }
 		if (GLEW_EXT_texture_array)        { m_supportFlags |= CAP_TEXTURE_ARRAY; }
+		if (GLEW_ARB_get_program_binary || GLEW_VERSION_4_1)
+		{
+			// Some drivers expose the extension without supporting any binary formats.
+			GLint formatCount = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+			if (formatCount > 0) { m_supportFlags |= CAP_PROGRAM_BINARY; }
+		}
 
 		// Get texture buffer maximum size.
 		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &m_textureBufferMaxSize);
@@ -85,6 +93,11 @@ namespace OpenGL_Caps
 		return (m_supportFlags&CAP_TEXTURE_ARRAY) != 0;
 	}
 
+	bool supportsProgramBinary()
+	{
+		return (m_supportFlags&CAP_PROGRAM_BINARY) != 0;
+	}
+
 	bool deviceSupportsGpuBlit()
 	{
 		return m_deviceTier > DEV_TIER_0;
@@ -1,14 +1,21 @@
 #include "glslParser.h"
+#include "openGL_Caps.h"
 #include <TFE_RenderBackend/shader.h>
 #include <TFE_RenderBackend/vertexBuffer.h>
 #include <TFE_System/system.h>
+#include <TFE_System/hash.h>
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/fileutil.h>
 #include <TFE_FileSystem/paths.h>
+#include <TFE_Settings/settings.h>
 #include <TFE_RenderBackend/renderBackend.h>
 #include <GL/glew.h>
 #include <assert.h>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <map>
+#include <set>
 
 namespace ShaderGL
 {
@@ -71,12 +78,319 @@ namespace ShaderGL
 
 		return (GLboolean)status == GL_TRUE;
 	}
+
+	////////////////////////////////////////////////
+	// Program binary cache
+	// Linked programs are saved to disk keyed by the final source, defines and driver,
+	// so changing settings or restarting skips the compile and link step.
+	////////////////////////////////////////////////
+	struct ProgramCacheHeader
+	{
+		u32 magic;
+		u32 version;
+		u64 key;
+		u64 driverHash;
+		u32 format;
+		u32 size;
+	};
+	struct ProgramCacheIndexHeader
+	{
+		u32 magic;
+		u32 version;
+		s32 entryCount;
+		s32 pad;
+	};
+
+	struct ProgramCacheIndexEntry
+	{
+		u64 key;
+		u64 lastUse;	// Use counter value when the file was last written or loaded.
+		u64 size;		// File size in bytes.
+	};
+
+	static const u32 c_programCacheMagic = 0x42534654;	// "TFSB"
+	static const u32 c_programCacheIndexMagic = 0x58495354;	// "TSIX"
+	static const u32 c_programCacheVersion = 1;
+	// The least recently used files are deleted once the cache exceeds either limit.
+	static const s32 c_programCacheMaxFiles = 512;
+	static const u64 c_programCacheMaxBytes = 128ull * 1024ull * 1024ull;	// 128MB
+	static std::map<u64, ProgramCacheIndexEntry> s_programCacheIndex;
+	static u64  s_programCacheUseCounter = 0;
+	static bool s_programCacheIndexLoaded = false;
+	static u64  s_driverHash = 0;
+	static bool s_driverHashValid = false;
+
+	bool binaryCache_isEnabled()
+	{
+		return TFE_Settings::getGraphicsSettings()->shaderCache && OpenGL_Caps::supportsProgramBinary();
+	}
+
+	// A driver update may change the binary format without changing the format enum, so the driver strings are part of the key.
+	u64 binaryCache_getDriverHash()
+	{
+		if (!s_driverHashValid)
+		{
+			s_driverHash = TFE_Hash::hashString((const char*)glGetString(GL_VENDOR));
+			s_driverHash = TFE_Hash::hashString((const char*)glGetString(GL_RENDERER), s_driverHash);
+			s_driverHash = TFE_Hash::hashString((const char*)glGetString(GL_VERSION), s_driverHash);
+			s_driverHashValid = true;
+		}
+		return s_driverHash;
+	}
+
+	u64 binaryCache_computeKey(const GLchar* versionString, const char* defineString, const char* vertexShaderGLSL, const char* fragmentShaderGLSL)
+	{
+		u64 hash = TFE_Hash::hashString(versionString, binaryCache_getDriverHash());
+		hash = TFE_Hash::hashString(defineString, hash);
+		hash = TFE_Hash::hashString(vertexShaderGLSL, hash);
+		hash = TFE_Hash::hashString(fragmentShaderGLSL, hash);
+		for (u32 i = 0; i < ATTR_COUNT; i++)
+		{
+			hash = TFE_Hash::hashString(c_shaderAttrName[i], hash);
+		}
+		return hash;
+	}
+
+	void binaryCache_getPath(u64 key, char* path)
+	{
+		sprintf(path, "%sCache/Shaders/%016llx.bin", TFE_Paths::getPath(PATH_PROGRAM_DATA), (unsigned long long)key);
+	}
+
+	void binaryCache_getIndexPath(char* path)
+	{
+		sprintf(path, "%sCache/Shaders/index.dat", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+	}
+
+	void binaryCache_saveIndex()
+	{
+		char path[TFE_MAX_PATH];
+		binaryCache_getIndexPath(path);
+
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Shader", "Cannot write program binary cache index '%s'.", path);
+			return;
+		}
+		ProgramCacheIndexHeader header = {};
+		header.magic = c_programCacheIndexMagic;
+		header.version = c_programCacheVersion;
+		header.entryCount = (s32)s_programCacheIndex.size();
+		file.writeBuffer(&header, sizeof(ProgramCacheIndexHeader));
+
+		std::map<u64, ProgramCacheIndexEntry>::iterator iEntry = s_programCacheIndex.begin();
+		for (; iEntry != s_programCacheIndex.end(); ++iEntry)
+		{
+			file.writeBuffer(&iEntry->second, sizeof(ProgramCacheIndexEntry));
+		}
+		file.close();
+	}
+
+	// Load the index the first time the cache is used, which happens while the startup shaders are built. Cache files
+	// that are not in the index, such as files written by an older version, are deleted so they cannot pile up.
+	void binaryCache_loadIndex()
+	{
+		if (s_programCacheIndexLoaded) { return; }
+		s_programCacheIndexLoaded = true;
+		s_programCacheIndex.clear();
+		s_programCacheUseCounter = 0;
+
+		char dir[TFE_MAX_PATH];
+		sprintf(dir, "%sCache/Shaders/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		if (!FileUtil::directoryExits(dir)) { return; }
+
+		char path[TFE_MAX_PATH];
+		binaryCache_getIndexPath(path);
+		if (FileUtil::exists(path))
+		{
+			u8* buffer = nullptr;
+			const u32 size = FileStream::readContents(path, (void**)&buffer);
+			const ProgramCacheIndexHeader* header = (size >= sizeof(ProgramCacheIndexHeader)) ? (ProgramCacheIndexHeader*)buffer : nullptr;
+			if (header && header->magic == c_programCacheIndexMagic && header->version == c_programCacheVersion && header->entryCount >= 0 &&
+				size >= sizeof(ProgramCacheIndexHeader) + sizeof(ProgramCacheIndexEntry) * size_t(header->entryCount))
+			{
+				const ProgramCacheIndexEntry* entries = (ProgramCacheIndexEntry*)(buffer + sizeof(ProgramCacheIndexHeader));
+				for (s32 i = 0; i < header->entryCount; i++)
+				{
+					s_programCacheIndex[entries[i].key] = entries[i];
+					s_programCacheUseCounter = std::max(s_programCacheUseCounter, entries[i].lastUse);
+				}
+			}
+			free(buffer);
+		}
+
+		FileList files;
+		FileUtil::readDirectory(dir, "bin", files);
+		std::set<u64> filesOnDisk;
+		const size_t fileCount = files.size();
+		for (size_t i = 0; i < fileCount; i++)
+		{
+			const char* name = files[i].c_str();
+			char* end = nullptr;
+			const u64 key = (u64)strtoull(name, &end, 16);
+			if (end == name + 16 && s_programCacheIndex.find(key) != s_programCacheIndex.end())
+			{
+				filesOnDisk.insert(key);
+				continue;
+			}
+			sprintf(path, "%s%s", dir, name);
+			FileUtil::deleteFile(path);
+		}
+
+		// Drop entries whose files no longer exist.
+		const size_t indexCount = s_programCacheIndex.size();
+		std::map<u64, ProgramCacheIndexEntry>::iterator iEntry = s_programCacheIndex.begin();
+		while (iEntry != s_programCacheIndex.end())
+		{
+			if (filesOnDisk.find(iEntry->first) == filesOnDisk.end()) { iEntry = s_programCacheIndex.erase(iEntry); }
+			else { ++iEntry; }
+		}
+		if (indexCount != s_programCacheIndex.size() || fileCount != filesOnDisk.size())
+		{
+			binaryCache_saveIndex();
+		}
+	}
+
+	void binaryCache_removeEntry(u64 key)
+	{
+		char path[TFE_MAX_PATH];
+		binaryCache_getPath(key, path);
+		FileUtil::deleteFile(path);
+		if (s_programCacheIndex.erase(key))
+		{
+			binaryCache_saveIndex();
+		}
+	}
+
+	// Mark the entry as the most recently used and evict the least recently used files until the cache fits the budget.
+	void binaryCache_touch(u64 key, u64 size)
+	{
+		ProgramCacheIndexEntry& entry = s_programCacheIndex[key];
+		entry.key = key;
+		entry.lastUse = ++s_programCacheUseCounter;
+		entry.size = size;
+
+		u64 totalSize = 0;
+		std::map<u64, ProgramCacheIndexEntry>::iterator iEntry = s_programCacheIndex.begin();
+		for (; iEntry != s_programCacheIndex.end(); ++iEntry)
+		{
+			totalSize += iEntry->second.size;
+		}
+		while (s_programCacheIndex.size() > 1 && (s32(s_programCacheIndex.size()) > c_programCacheMaxFiles || totalSize > c_programCacheMaxBytes))
+		{
+			std::map<u64, ProgramCacheIndexEntry>::iterator iOldest = s_programCacheIndex.end();
+			for (iEntry = s_programCacheIndex.begin(); iEntry != s_programCacheIndex.end(); ++iEntry)
+			{
+				if (iEntry->first != key && (iOldest == s_programCacheIndex.end() || iEntry->second.lastUse < iOldest->second.lastUse))
+				{
+					iOldest = iEntry;
+				}
+			}
+			totalSize -= iOldest->second.size;
+
+			char path[TFE_MAX_PATH];
+			binaryCache_getPath(iOldest->first, path);
+			FileUtil::deleteFile(path);
+			s_programCacheIndex.erase(iOldest);
+		}
+		binaryCache_saveIndex();
+	}
+
+	// Returns a linked program or 0 if there is no usable binary.
+	GLuint binaryCache_load(u64 key)
+	{
+		binaryCache_loadIndex();
+		if (s_programCacheIndex.find(key) == s_programCacheIndex.end()) { return 0; }
+
+		char path[TFE_MAX_PATH];
+		binaryCache_getPath(key, path);
+		if (!FileUtil::exists(path))
+		{
+			binaryCache_removeEntry(key);
+			return 0;
+		}
+
+		u8* buffer = nullptr;
+		const u32 size = FileStream::readContents(path, (void**)&buffer);
+		const ProgramCacheHeader* header = (ProgramCacheHeader*)buffer;
+		if (!buffer || size < sizeof(ProgramCacheHeader) || header->magic != c_programCacheMagic || header->version != c_programCacheVersion ||
+			header->key != key || header->driverHash != binaryCache_getDriverHash() || header->size != size - sizeof(ProgramCacheHeader))
+		{
+			free(buffer);
+			binaryCache_removeEntry(key);
+			return 0;
+		}
+
+		// Clear out any pre-existing errors so they are not attributed to the binary.
+		glGetError();
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header->format, buffer + sizeof(ProgramCacheHeader), header->size);
+		free(buffer);
+
+		// The driver is free to reject binaries at any time, in which case the program is compiled from source.
+		GLint status = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		const GLenum error = glGetError();
+		if (status != GL_TRUE || error != GL_NO_ERROR)
+		{
+			TFE_System::logWrite(LOG_WARNING, "Shader", "Cached program binary rejected by the driver, recompiling '%s', '%s'.", s_vertexFile.c_str(), s_fragmentFile.c_str());
+			glDeleteProgram(program);
+			binaryCache_removeEntry(key);
+			return 0;
+		}
+		binaryCache_touch(key, size);
+		return program;
+	}
+
+	void binaryCache_write(u64 key, GLuint program)
+	{
+		GLint binarySize = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+		if (binarySize <= 0) { return; }
+
+		std::vector<u8> binary(binarySize);
+		GLenum format = 0;
+		GLsizei length = 0;
+		glGetProgramBinary(program, binarySize, &length, &format, binary.data());
+		if (glGetError() != GL_NO_ERROR || length <= 0) { return; }
+
+		char path[TFE_MAX_PATH];
+		sprintf(path, "%sCache/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		FileUtil::makeDirectory(path);
+		strcat(path, "Shaders/");
+		FileUtil::makeDirectory(path);
+		binaryCache_loadIndex();
+		binaryCache_getPath(key, path);
+
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "Shader", "Cannot write program binary cache '%s'.", path);
+			return;
+		}
+		ProgramCacheHeader header = { c_programCacheMagic, c_programCacheVersion, key, binaryCache_getDriverHash(), (u32)format, (u32)length };
+		file.writeBuffer(&header, sizeof(ProgramCacheHeader));
+		file.writeBuffer(binary.data(), (u32)length);
+		file.close();
+		binaryCache_touch(key, sizeof(ProgramCacheHeader) + u64(length));
+	}
 }
 
 bool Shader::create(const char* vertexShaderGLSL, const char* fragmentShaderGLSL, const char* defineString/* = nullptr*/, ShaderVersion version/* = SHADER_VER_COMPTABILE*/)
 {
-	// Create shaders
 	m_shaderVersion = version;
+
+	// Try the program binary cache first.
+	const bool useCache = ShaderGL::binaryCache_isEnabled();
+	u64 cacheKey = 0;
+	if (useCache)
+	{
+		cacheKey = ShaderGL::binaryCache_computeKey(ShaderGL::c_glslVersionString[m_shaderVersion], defineString ? defineString : "", vertexShaderGLSL, fragmentShaderGLSL);
+		m_gpuHandle = ShaderGL::binaryCache_load(cacheKey);
+		if (m_gpuHandle) { return true; }
+	}
+
+	// Create shaders
 	const GLchar* vertex_shader_with_version[3] = { ShaderGL::c_glslVersionString[m_shaderVersion], defineString ? defineString : "", vertexShaderGLSL };
 	u32 vertHandle = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertHandle, 3, vertex_shader_with_version, NULL);
@@ -100,9 +414,18 @@ bool Shader::create(const char* vertexShaderGLSL, const char* fragmentShaderGLSL
 	{
 		glBindAttribLocation(m_gpuHandle, i, ShaderGL::c_shaderAttrName[i]);
 	}
+	if (useCache)
+	{
+		glProgramParameteri(m_gpuHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glLinkProgram(m_gpuHandle);
 	if (!ShaderGL::CheckProgram(m_gpuHandle, "shader program", m_shaderVersion)) { return false; }
 
+	if (useCache)
+	{
+		ShaderGL::binaryCache_write(cacheKey, m_gpuHandle);
+	}
+
 	return m_gpuHandle != 0;
 }
 
@@ -186,6 +186,38 @@ bool TextureGpu::update(const void* buffer, size_t size, s32 layer, s32 mipLevel
 	return true;
 }
 
+bool TextureGpu::updateRows(const void* buffer, s32 layer, s32 mipLevel, u32 yOffset, u32 rowCount)
+{
+	const u32 width  = m_width  >> mipLevel;
+	const u32 height = m_height >> mipLevel;
+	if (yOffset + rowCount > height) { return false; }
+
+	if (m_layers == 1)
+	{
+		glBindTexture(GL_TEXTURE_2D, m_gpuHandle);
+		glTexSubImage2D(GL_TEXTURE_2D, mipLevel, 0, yOffset, width, rowCount, m_channels == 4 ? GL_RGBA : GL_RED, GL_UNSIGNED_BYTE, buffer);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_gpuHandle);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, mipLevel, 0/*xOffset*/, yOffset, layer, width, rowCount, 1,
+			m_channels == 4 ? GL_RGBA : GL_RED, GL_UNSIGNED_BYTE, buffer);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	assert(glGetError() == GL_NO_ERROR);
+	return true;
+}
+
+void TextureGpu::setMinLod(f32 minLod)
+{
+	const GLenum target = m_layers == 1 ? GL_TEXTURE_2D : GL_TEXTURE_2D_ARRAY;
+	glBindTexture(target, m_gpuHandle);
+	glTexParameterf(target, GL_TEXTURE_MIN_LOD, minLod);
+	glBindTexture(target, 0);
+}
+
 void TextureGpu::setFilter(MagFilter magFilter, MinFilter minFilter, bool isArray) const
 {
 	glTexParameteri(isArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter == MAG_FILTER_LINEAR ? GL_LINEAR : GL_NEAREST);
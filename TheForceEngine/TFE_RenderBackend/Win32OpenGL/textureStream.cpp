@@ -0,0 +1,167 @@
+#include <cstring>
+#include <algorithm>
+
+#include "../textureStream.h"
+#include "openGL_Caps.h"
+#include <TFE_System/system.h>
+#include <GL/glew.h>
+#include <assert.h>
+
+#ifdef _DEBUG
+	#define CHECK_GL_ERROR checkGlError();
+#else
+	#define CHECK_GL_ERROR
+#endif
+namespace
+{
+	void checkGlError()
+	{
+		GLenum error = glGetError();
+		if (error == GL_NO_ERROR) { return; }
+
+		TFE_System::logWrite(LOG_ERROR, "Texture Stream", "GL Error = %x", error);
+		assert(error == GL_NO_ERROR);
+	}
+}
+
+TextureStream::~TextureStream()
+{
+	destroy();
+}
+
+bool TextureStream::create(u32 bufferSize, u32 bufferCount)
+{
+	destroy();
+	m_bufferSize  = bufferSize;
+	m_bufferCount = std::max(1u, bufferCount);
+	m_curBuffer   = 0;
+
+	if (OpenGL_Caps::supportsPbo())
+	{
+		m_stagingBuffers = new u32[m_bufferCount];
+		glGenBuffers(m_bufferCount, m_stagingBuffers);
+		for (u32 i = 0; i < m_bufferCount; i++)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffers[i]);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, m_bufferSize, nullptr, GL_STREAM_DRAW);
+		}
+		glGenBuffers(1, &m_fillBuffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		CHECK_GL_ERROR
+	}
+	return true;
+}
+
+void TextureStream::destroy()
+{
+	if (m_stagingBuffers)
+	{
+		glDeleteBuffers(m_bufferCount, m_stagingBuffers);
+		delete[] m_stagingBuffers;
+		m_stagingBuffers = nullptr;
+	}
+	if (m_fillBuffer)
+	{
+		glDeleteBuffers(1, &m_fillBuffer);
+		m_fillBuffer = 0;
+	}
+	m_bufferCount = 0;
+	m_bufferSize = 0;
+	m_fillBytesPerTexel = 0;
+	m_fillData.clear();
+}
+
+u32 TextureStream::getRowsPerCopy(TextureGpu* texture, s32 mipLevel, u32* rowBytes) const
+{
+	*rowBytes = (texture->getWidth() >> mipLevel) * texture->getBytesPerTexel();
+	// The default unpack alignment (4) is used, which all atlas mips satisfy.
+	assert((*rowBytes & 3) == 0);
+	return std::max(1u, m_bufferSize / *rowBytes);
+}
+
+bool TextureStream::uploadRows(TextureGpu* texture, const void* src, s32 layer, s32 mipLevel, u32 y, u32 rowCount)
+{
+	if (!texture || !src || !rowCount) { return false; }
+	if (!m_stagingBuffers)
+	{
+		return texture->updateRows(src, layer, mipLevel, y, rowCount);
+	}
+
+	u32 rowBytes;
+	const u32 rowsPerCopy = getRowsPerCopy(texture, mipLevel, &rowBytes);
+	const u8* srcRows = (const u8*)src;
+	while (rowCount)
+	{
+		const u32 copyRows = std::min(rowCount, rowsPerCopy);
+		const u32 copySize = copyRows * rowBytes;
+
+		// Orphan the previous storage so the driver does not have to wait for a pending copy from this buffer.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffers[m_curBuffer]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, std::max(m_bufferSize, copySize), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, copySize, srcRows);
+		// With a bound unpack buffer the data pointer is an offset into the buffer.
+		texture->updateRows(nullptr, layer, mipLevel, y, copyRows);
+		m_curBuffer = (m_curBuffer + 1) % m_bufferCount;
+
+		srcRows  += copySize;
+		y        += copyRows;
+		rowCount -= copyRows;
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	CHECK_GL_ERROR
+	return true;
+}
+
+bool TextureStream::fillRows(TextureGpu* texture, u32 texel, s32 layer, s32 mipLevel, u32 y, u32 rowCount)
+{
+	if (!texture || !rowCount) { return false; }
+
+	u32 rowBytes;
+	const u32 rowsPerCopy = getRowsPerCopy(texture, mipLevel, &rowBytes);
+	const u32 bytesPerTexel = texture->getBytesPerTexel();
+	const u32 fillSize = std::min(rowCount, rowsPerCopy) * rowBytes;
+
+	// Rebuild the fill data only when the value, format or required size changes.
+	bool fillChanged = false;
+	if (texel != m_fillTexel || bytesPerTexel != m_fillBytesPerTexel || fillSize > m_fillData.size())
+	{
+		m_fillTexel = texel;
+		m_fillBytesPerTexel = bytesPerTexel;
+		m_fillData.resize(std::max(fillSize, (u32)m_fillData.size()));
+		if (bytesPerTexel == 1)
+		{
+			memset(m_fillData.data(), texel & 0xff, m_fillData.size());
+		}
+		else
+		{
+			u32* fill = (u32*)m_fillData.data();
+			const size_t count = m_fillData.size() / sizeof(u32);
+			for (size_t i = 0; i < count; i++) { fill[i] = texel; }
+		}
+		fillChanged = true;
+	}
+
+	if (m_fillBuffer)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_fillBuffer);
+		if (fillChanged)
+		{
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, m_fillData.size(), m_fillData.data(), GL_STATIC_DRAW);
+		}
+	}
+	// The fill source stays the same for every copy, so it is uploaded to the buffer at most once.
+	const void* fillSrc = m_fillBuffer ? nullptr : m_fillData.data();
+	while (rowCount)
+	{
+		const u32 copyRows = std::min(rowCount, rowsPerCopy);
+		texture->updateRows(fillSrc, layer, mipLevel, y, copyRows);
+		y        += copyRows;
+		rowCount -= copyRows;
+	}
+	if (m_fillBuffer)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	CHECK_GL_ERROR
+	return true;
+}
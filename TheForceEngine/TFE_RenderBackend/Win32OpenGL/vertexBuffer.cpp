@@ -79,6 +79,13 @@ void VertexBuffer::update(const void* buffer, size_t size)
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void VertexBuffer::updateRange(const void* buffer, size_t offset, size_t size)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, m_gpuHandle);
+	glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)offset, (GLsizeiptr)size, (const GLvoid*)buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void VertexBuffer::bind() const
 {
 	glBindBuffer(GL_ARRAY_BUFFER, m_gpuHandle);
@@ -16,6 +16,7 @@ public:
 	void destroy();
 
 	void update(const void* buffer, size_t size);
+	void updateRange(const void* buffer, size_t offset, size_t size);	// Update part of the buffer in place, offset and size are in bytes.
 	// bind() returns the size type that should be used in draw commands.
 	u32 bind() const;
 	void unbind() const;
@@ -38,6 +38,8 @@ public:
 	bool createArray(u32 width, u32 height, u32 layers, u32 channels = 4, u32 mipCount = 1);
 	bool createWithData(u32 width, u32 height, const void* buffer, MagFilter magFilter = MAG_FILTER_NONE);
 	bool update(const void* buffer, size_t size, s32 layer = -1, s32 mipLevel = 0);	// layer = -1 means update all layers, otherwise it is the layer index.
+	bool updateRows(const void* buffer, s32 layer, s32 mipLevel, u32 yOffset, u32 rowCount);	// Update 'rowCount' full rows of a single layer.
+	void setMinLod(f32 minLod);	// Clamp sampling to mip levels >= minLod, used while finer mips are still being uploaded.
 	void setFilter(MagFilter magFilter, MinFilter minFilter, bool isArray = false) const;
 	void bind(u32 slot = 0) const;
 	static void clear(u32 slot = 0);
@@ -46,6 +48,8 @@ public:
 	u32  getWidth() const { return m_width; }
 	u32  getHeight() const { return m_height; }
 	u32  getLayers() const { return m_layers; }
+	u32  getMipCount() const { return m_mipCount; }
+	u32  getBytesPerTexel() const { return m_channels * m_bytesPerChannel; }
 
 	void readCpu(u8* image);
 
@@ -0,0 +1,42 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Streams texture data to the GPU in row slices through a ring of
+// pixel unpack buffers (PBOs), so large textures can be uploaded over
+// several frames without stalling on a single large copy.
+//////////////////////////////////////////////////////////////////////
+
+#include <TFE_System/types.h>
+#include <TFE_RenderBackend/textureGpu.h>
+#include <vector>
+
+class TextureStream
+{
+public:
+	TextureStream() : m_bufferSize(0), m_bufferCount(0), m_curBuffer(0), m_stagingBuffers(nullptr), m_fillBuffer(0), m_fillTexel(0), m_fillBytesPerTexel(0) {}
+	~TextureStream();
+
+	bool create(u32 bufferSize, u32 bufferCount = 3);
+	void destroy();
+
+	// Upload 'rowCount' tightly packed rows starting at row 'y' of (layer, mipLevel).
+	// The source is copied before returning, so the caller is free to modify it afterward.
+	bool uploadRows(TextureGpu* texture, const void* src, s32 layer, s32 mipLevel, u32 y, u32 rowCount);
+	// Fill 'rowCount' rows starting at row 'y' of (layer, mipLevel) with a single texel value.
+	// 1 byte texels use the low 8 bits of 'texel'.
+	bool fillRows(TextureGpu* texture, u32 texel, s32 layer, s32 mipLevel, u32 y, u32 rowCount);
+
+	inline u32 getBufferSize() const { return m_bufferSize; }
+
+private:
+	u32 getRowsPerCopy(TextureGpu* texture, s32 mipLevel, u32* rowBytes) const;
+
+	u32  m_bufferSize;
+	u32  m_bufferCount;
+	u32  m_curBuffer;
+	u32* m_stagingBuffers;
+
+	u32 m_fillBuffer;
+	u32 m_fillTexel;
+	u32 m_fillBytesPerTexel;
+	std::vector<u8> m_fillData;
+};
@@ -50,6 +50,7 @@ public:
 	void destroy();
 
 	void update(const void* buffer, size_t size);
+	void updateRange(const void* buffer, size_t offset, size_t size);	// Update part of the buffer in place, offset and size are in bytes.
 	void bind() const;
 	void unbind() const;
 
@@ -2,6 +2,9 @@
 
 #include <TFE_System/profiler.h>
 #include <TFE_System/math.h>
+#include <TFE_System/hash.h>
+#include <TFE_System/threadPool.h>
+#include <TFE_System/frameArena.h>
 #include <TFE_Asset/modelAsset_jedi.h>
 #include <TFE_Game/igame.h>
 #include <TFE_Jedi/Level/level.h>
@@ -17,14 +20,21 @@
 #include <TFE_RenderBackend/indexBuffer.h>
 #include <TFE_RenderBackend/shader.h>
 #include <TFE_RenderBackend/shaderBuffer.h>
+#include <TFE_RenderBackend/textureStream.h>
 #include <TFE_RenderShared/texturePacker.h>
 
 #include <TFE_Settings/settings.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/paths.h>
 
 #include <TFE_Asset/imageAsset.h>
 #include <TFE_Memory/chunkedArray.h>
 
 #include <map>
+#include <set>
+#include <algorithm>
+#include <climits>
 
 #define DEBUG_TEXTURE_ATLAS 0
 
@@ -83,9 +93,69 @@ namespace TFE_Jedi
 	static TexturePacker* s_globalTexturePacker = nullptr;
 
 	static s32 s_colorIndexStart = -1;
+
+	// Deferred packing.
+	enum PackJobType
+	{
+		PACK_JOB_TEXTURE = 0,
+		PACK_JOB_DELT,
+		PACK_JOB_WAX_CELL,
+	};
+
+	struct PackJob
+	{
+		PackJobType type;
+		s32 page;
+		Vec4ui rect;
+		s32 width;		// Size of the area written, including padding.
+		s32 height;
+		const TextureData* texData;
+		const void* basePtr;
+		const WaxCell* cell;
+		Vec4i* tableEntry;
+		s32 paddingX;
+		s32 paddingY;
+		s32 mipCount;
+	};
+
+	// Identifies a packed texture by its position in the (unsorted) texture list and animation frame.
+	struct PackRecord
+	{
+		s32 listIndex;
+		s32 frameIndex;		// -1 if not an animation frame.
+	};
+
+	static std::vector<PackJob> s_packJobs;
+	static std::vector<PackRecord> s_packRecords;
+	static s32 s_curListIndex = 0;
+	static s32 s_curFrameIndex = -1;
+
+	// Streaming page uploads.
+	struct PageUpload
+	{
+		s32 page;
+		s32 mip;
+	};
+	static const u32 c_uploadStagingSize = 1024 * 1024;
+	static const u32 c_uploadFallbackColor = 0xff808080;	// Solid gray for pages without a low resolution fallback.
+
+	static TextureStream s_textureStream;
+	static TexturePacker* s_uploadPacker = nullptr;
+	static std::vector<PageUpload> s_pageUploads;		// Ordered from the coarsest mip to the finest.
+	static s32 s_pageUploadIndex = 0;
+	static u32 s_pageUploadRow = 0;
+	static bool s_uploadClampLod = false;	// Sampling is clamped to the mips uploaded so far.
+	static u64 s_uploadBytesTotal = 0;
+	static u64 s_uploadBytesDone = 0;
+	// Profiler counters.
+	static s32 s_uploadFrameKB = 0;
+	static s32 s_uploadPendingKB = 0;
+	static s32 s_uploadProgress = 100;
 		
 	TextureNode* allocateNode();
 	u8* getWritePointer(s32 page, s32 x, s32 y, u32 mipLevel = 0);
+	void atlasCache_resetChain();
+	void cancelPageUploads();
 
 #if DEBUG_TEXTURE_ATLAS
 	void debug_writeOutAtlas();
@@ -147,8 +217,12 @@ namespace TFE_Jedi
 
 		if (!s_nodePool)
 		{
-			s_texturePackerRegion = TFE_Memory::region_create("game", 8 * 1024 * 1024);
+			s_texturePackerRegion = TFE_Memory::region_create("TexturePacker", 8 * 1024 * 1024);
 			s_nodePool = TFE_Memory::createChunkedArray(sizeof(TextureNode), 256, 1, s_texturePackerRegion);
+
+			TFE_COUNTER(s_uploadFrameKB, "Texture Upload KB/Frame");
+			TFE_COUNTER(s_uploadPendingKB, "Texture Upload Pending KB");
+			TFE_COUNTER(s_uploadProgress, "Texture Upload Progress %");
 		}
 				
 		// Initialize with one page.
@@ -216,6 +290,11 @@ namespace TFE_Jedi
 	void texturepacker_destroy(TexturePacker* texturePacker)
 	{
 		if (!texturePacker) { return; }
+		if (texturePacker == s_uploadPacker)
+		{
+			cancelPageUploads();
+			s_textureStream.destroy();
+		}
 
 		TFE_RenderBackend::freeTexture(texturePacker->texture);
 		texturePacker->textureTableGPU.destroy();
@@ -245,6 +324,8 @@ namespace TFE_Jedi
 	void texturepacker_discardUnreservedPages(TexturePacker* texturePacker)
 	{
 		if (!texturepacker_hasReservedPages(texturePacker)) { return; }
+		// The unreserved pages are about to be overwritten.
+		cancelPageUploads();
 		// Clear pages.
 		for (s32 p = 0; p < s_texturePacker->reservedPages; p++)
 		{
@@ -260,6 +341,7 @@ namespace TFE_Jedi
 		s_textureDataMap.clear();
 		s_waxDataMap.clear();
 		s_texInfoPool.clear();
+		atlasCache_resetChain();
 
 		// Insert the parent that covers all of the available space.
 		s_texturePacker->pageCount = s_texturePacker->reservedPages;
@@ -453,7 +535,7 @@ namespace TFE_Jedi
 		return 1.0;
 	}
 
-	void packNode(const TextureNode* node, const TextureData* texData, Vec4i* tableEntry, s32 paddingX, s32 paddingY, s32 mipCount)
+	void packNode(s32 page, const Vec4ui& rect, const TextureData* texData, Vec4i* tableEntry, s32 paddingX, s32 paddingY, s32 mipCount)
 	{
 		// Copy the texture into place.
 		s32 offsetX = paddingX / 2;
@@ -473,7 +555,7 @@ namespace TFE_Jedi
 			f64 accum[3] = { 0.0 };
 			f64 accumCount = 0.0;
 
-			u32* output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u32* output = (u32*)getWritePointer(page, rect.x, rect.y, 0);
 			for (s32 y = 0; y < texData->height+paddingY; y++, output += s_texturePacker->width)
 			{
 				s32 ySrc = (y - offsetY) % texData->height;
@@ -547,13 +629,13 @@ namespace TFE_Jedi
 				}
 			}
 
-			u32* source = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u32* source = (u32*)getWritePointer(page, rect.x, rect.y, 0);
 			u32 w = texData->width  + paddingX;
 			u32 h = texData->height + paddingY;
 			u32 stride = s_texturePacker->width;
 			for (s32 m = 1; m < mipCount; m++)
 			{
-				output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, m);
+				output = (u32*)getWritePointer(page, rect.x, rect.y, m);
 				generateMipmap(source, output, w, h, stride);
 
 				stride >>= 1;
@@ -564,7 +646,7 @@ namespace TFE_Jedi
 		}
 		else
 		{
-			u8* output = getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u8* output = getWritePointer(page, rect.x, rect.y, 0);
 			for (s32 y = 0; y < texData->height; y++, output += s_texturePacker->width)
 			{
 				for (s32 x = 0; x < texData->width; x++)
@@ -573,16 +655,14 @@ namespace TFE_Jedi
 				}
 			}
 		}
-		s_usedTexels += texData->width * texData->height;
-
 		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x + offsetX;
-		tableEntry->y = (s32)node->rect.y + offsetY;
+		tableEntry->x = (s32)rect.x + offsetX;
+		tableEntry->y = (s32)rect.y + offsetY;
 		tableEntry->z = (s32)texData->width;
 		tableEntry->w = (s32)texData->height;
 
 		// Page the page index into the x offset.
-		tableEntry->x |= (s_currentPage << 12);
+		tableEntry->x |= (page << 12);
 
 		// Half color tint packed.
 		s32 r = s32(halfTint.x * 255.0);
@@ -592,7 +672,7 @@ namespace TFE_Jedi
 		tableEntry->w |= (b << 15);
 	}
 
-	void packNodeDeltaTex(const TextureNode* node, const TextureData* texData, Vec4i* tableEntry, s32 paddingX, s32 paddingY)
+	void packNodeDeltaTex(s32 page, const Vec4ui& rect, const TextureData* texData, Vec4i* tableEntry, s32 paddingX, s32 paddingY)
 	{
 		// Copy the texture into place.
 		s32 offsetX = paddingX / 2;
@@ -602,7 +682,7 @@ namespace TFE_Jedi
 		{
 			const u32* pal = getPalette(texData->palIndex);
 
-			u32* output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u32* output = (u32*)getWritePointer(page, rect.x, rect.y, 0);
 			for (s32 y = 0; y < texData->height + paddingY; y++, output += s_texturePacker->width)
 			{
 				const s32 ySrc = y - offsetY;
@@ -619,7 +699,7 @@ namespace TFE_Jedi
 		}
 		else
 		{
-			u8* output = getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
+			u8* output = getWritePointer(page, rect.x, rect.y, 0);
 			for (s32 y = 0; y < texData->height; y++, output += s_texturePacker->width)
 			{
 				for (s32 x = 0; x < texData->width; x++)
@@ -628,106 +708,99 @@ namespace TFE_Jedi
 				}
 			}
 		}
-		s_usedTexels += texData->width * texData->height;
-
 		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x + offsetX;
-		tableEntry->y = (s32)node->rect.y + offsetY;
+		tableEntry->x = (s32)rect.x + offsetX;
+		tableEntry->y = (s32)rect.y + offsetY;
 		tableEntry->z = (s32)texData->width;
 		tableEntry->w = (s32)texData->height;
 
 		// Page the page index into the x offset.
-		tableEntry->x |= (s_currentPage << 12);
+		tableEntry->x |= (page << 12);
 	}
 		
-	void packNodeCell(const TextureNode* node, const void* basePtr, const WaxCell* cell, Vec4i* tableEntry, s32 paddingX, s32 paddingY)
+	// Returns the uncompressed column 'x' of the cell, 'workBuffer' must hold at least WAX_DECOMPRESS_SIZE bytes.
+	const u8* getCellColumn(const void* basePtr, const WaxCell* cell, s32 x, u8* workBuffer)
+	{
+		const u32* columnOffset = (u32*)((u8*)basePtr + cell->columnOffset);
+		if (cell->compressed)
+		{
+			const u8* colPtr = (u8*)cell + columnOffset[x];
+			sprite_decompressColumn(colPtr, workBuffer, cell->sizeY);
+			return workBuffer;
+		}
+		const u8* image = (u8*)cell + sizeof(WaxCell);
+		return image + columnOffset[x];
+	}
+
+	void packNodeCell(s32 page, const Vec4ui& rect, const void* basePtr, const WaxCell* cell, Vec4i* tableEntry, s32 paddingX, s32 paddingY)
 	{
 		// Copy the texture into place.
 		s32 offsetX = paddingX / 2;
 		s32 offsetY = paddingY / 2;
 
-		const s32 compressed = cell->compressed;
-		u8* imageData = (u8*)cell + sizeof(WaxCell);
-		u8* image = (compressed == 1) ? imageData + (cell->sizeX * sizeof(u32)) : imageData;
-		
+		// Cells are stored by column, so decompress the whole cell into scratch memory from this thread's frame arena
+		// first, which lets the atlas be written a row at a time.
+		const s32 sizeX = cell->sizeX;
+		const s32 sizeY = cell->sizeY;
+		std::vector<u8> fallbackImage;
+		u8* cellImage = (u8*)TFE_System::frameArena_alloc(size_t(sizeX) * size_t(sizeY));
+		if (!cellImage)
+		{
+			fallbackImage.resize(size_t(max(sizeX * sizeY, 1)));
+			cellImage = fallbackImage.data();
+		}
 		u8 columnWorkBuffer[WAX_DECOMPRESS_SIZE];
-		const u32* columnOffset = (u32*)((u8*)basePtr + cell->columnOffset);
+		for (s32 x = 0; x < sizeX; x++)
+		{
+			memcpy(&cellImage[x * sizeY], getCellColumn(basePtr, cell, x, columnWorkBuffer), sizeY);
+		}
+
 		if (s_texturePacker->trueColor)
 		{
 			const u32* pal = getPalette(PALETTE_DEFAULT_IDX);
 			const u8* remap = &TFE_DarkForces::s_levelColorMap[31 << 8];
 
-			u32* output = (u32*)getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
-
-			for (s32 x = 0; x < cell->sizeX + paddingX; x++)
+			u32* output = (u32*)getWritePointer(page, rect.x, rect.y, 0);
+			for (s32 y = 0; y < sizeY + paddingY; y++, output += s_texturePacker->width)
 			{
-				const s32 xSrc = x - offsetX;
-				if (xSrc < 0 || xSrc >= cell->sizeX)
+				const s32 ySrc = y - offsetY;
+				for (s32 x = 0; x < sizeX + paddingX; x++)
 				{
-					for (s32 y = 0; y < cell->sizeY + paddingY; y++)
+					const s32 xSrc = x - offsetX;
+					const bool outside = ySrc < 0 || ySrc >= sizeY || xSrc < 0 || xSrc >= sizeX;
+					const u8 palIndex = outside ? 0u : cellImage[xSrc * sizeY + ySrc];
+					if (s_assetPool == POOL_LEVEL)
 					{
-						output[y*s_texturePacker->width + x] = 0;
+						output[x] = palIndex == 0 ? 0u : pal[remap[palIndex]];
 					}
-				}
-				else
-				{
-					u8* column = (u8*)image + columnOffset[xSrc];
-					if (compressed)
+					else
 					{
-						const u8* colPtr = (u8*)cell + columnOffset[xSrc];
-						sprite_decompressColumn(colPtr, columnWorkBuffer, cell->sizeY);
-						column = columnWorkBuffer;
+						output[x] = palIndex == 0 ? 0u : pal[palIndex];
 					}
 
-					for (s32 y = 0; y < cell->sizeY + paddingY; y++)
-					{
-						const s32 ySrc = y - offsetY;
-						bool outside = ySrc < 0 || ySrc >= cell->sizeY;
-						const u8 palIndex = (outside || column[ySrc] == 0) ? 0u : column[ySrc];
-						const u32 addr = y * s_texturePacker->width + x;
-						if (s_assetPool == POOL_LEVEL)
-						{
-							output[addr] = palIndex == 0 ? 0u : pal[remap[palIndex]];
-						}
-						else
-						{
-							output[addr] = palIndex == 0 ? 0u : pal[palIndex];
-						}
-
-						handleAlpha8Bit(palIndex, &output[addr]);
-					}
+					handleAlpha8Bit(palIndex, &output[x]);
 				}
 			}
 		}
 		else
 		{
-			u8* output = getWritePointer(s_currentPage, node->rect.x, node->rect.y, 0);
-			for (s32 x = 0; x < cell->sizeX; x++)
+			u8* output = getWritePointer(page, rect.x, rect.y, 0);
+			for (s32 y = 0; y < sizeY; y++, output += s_texturePacker->width)
 			{
-				u8* column = (u8*)image + columnOffset[x];
-				if (compressed)
+				for (s32 x = 0; x < sizeX; x++)
 				{
-					const u8* colPtr = (u8*)cell + columnOffset[x];
-					sprite_decompressColumn(colPtr, columnWorkBuffer, cell->sizeY);
-					column = columnWorkBuffer;
-				}
-
-				for (s32 y = 0; y < cell->sizeY; y++)
-				{
-					output[y*s_texturePacker->width + x] = column[y];
+					output[x] = cellImage[x * sizeY + y];
 				}
 			}
 		}
-		s_usedTexels += cell->sizeX * cell->sizeY;
-
 		// Copy the mapping into the texture table.
-		tableEntry->x = (s32)node->rect.x + offsetX;
-		tableEntry->y = (s32)node->rect.y + offsetY;
+		tableEntry->x = (s32)rect.x + offsetX;
+		tableEntry->y = (s32)rect.y + offsetY;
 		tableEntry->z = (s32)cell->sizeX;
 		tableEntry->w = (s32)cell->sizeY;
 
 		// Page the page index into the x offset.
-		tableEntry->x |= (s_currentPage << 12);
+		tableEntry->x |= (page << 12);
 	}
 
 	bool isTextureInMap(TextureData* tex)
@@ -797,6 +870,49 @@ namespace TFE_Jedi
 		}
 	}
 
+	// Conversion and mip generation is deferred until all of the textures have been placed, so it can be done in parallel.
+	// Each job writes into its own node rectangle and texture table entry, so jobs are independent.
+	void addPackJob(PackJobType type, const TextureNode* node, TextureData* texData, const void* basePtr, const WaxCell* cell, s32 paddingX, s32 paddingY, s32 mipCount)
+	{
+		PackJob job;
+		job.type = type;
+		job.page = s_currentPage;
+		job.rect = node->rect;
+		job.width  = (cell ? cell->sizeX : texData->width) + paddingX;
+		job.height = (cell ? cell->sizeY : texData->height) + paddingY;
+		job.texData = texData;
+		job.basePtr = basePtr;
+		job.cell = cell;
+		job.tableEntry = &s_texturePacker->textureTable[s_texturePacker->texturesPacked];
+		job.paddingX = paddingX;
+		job.paddingY = paddingY;
+		job.mipCount = mipCount;
+		s_packJobs.push_back(job);
+
+		// Record where the texture came from so a cached packing can be replayed.
+		s_packRecords.push_back({ s_curListIndex, s_curFrameIndex });
+	}
+
+	void runPackJob(s32 index, void* userData)
+	{
+		const PackJob* job = &s_packJobs[index];
+		switch (job->type)
+		{
+			case PACK_JOB_TEXTURE:
+			{
+				packNode(job->page, job->rect, job->texData, job->tableEntry, job->paddingX, job->paddingY, job->mipCount);
+			} break;
+			case PACK_JOB_DELT:
+			{
+				packNodeDeltaTex(job->page, job->rect, job->texData, job->tableEntry, job->paddingX, job->paddingY);
+			} break;
+			case PACK_JOB_WAX_CELL:
+			{
+				packNodeCell(job->page, job->rect, job->basePtr, job->cell, job->tableEntry, job->paddingX, job->paddingY);
+			} break;
+		}
+	}
+
 	bool insertTexture(TextureData* tex)
 	{
 		if (!tex || isTextureInMap(tex)) { return true; }
@@ -811,11 +927,12 @@ namespace TFE_Jedi
 		}
 
 		s_totalTexels += tex->width * tex->height;
+		s_usedTexels  += tex->width * tex->height;
 		insertTextureIntoMap(tex, s_texturePacker->texturesPacked);
 
 		assert(node->tex == tex && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
 		tex->textureId = s_texturePacker->texturesPacked;
-		packNode(node, tex, &s_texturePacker->textureTable[s_texturePacker->texturesPacked], paddingX, paddingY, (tex->flags & ENABLE_MIP_MAPS) ? s_texturePacker->mipCount : 1);
+		addPackJob(PACK_JOB_TEXTURE, node, tex, nullptr, nullptr, paddingX, paddingY, (tex->flags & ENABLE_MIP_MAPS) ? s_texturePacker->mipCount : 1);
 		s_texturePacker->texturesPacked++;
 		return true;
 	}
@@ -831,11 +948,12 @@ namespace TFE_Jedi
 		}
 
 		s_totalTexels += tex->width * tex->height;
+		s_usedTexels  += tex->width * tex->height;
 		insertTextureIntoMap(tex, s_texturePacker->texturesPacked);
 
 		assert(node->tex == tex && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
 		tex->textureId = s_texturePacker->texturesPacked;
-		packNodeDeltaTex(node, tex, &s_texturePacker->textureTable[s_texturePacker->texturesPacked], padding, padding);
+		addPackJob(PACK_JOB_DELT, node, tex, nullptr, nullptr, padding, padding, 1);
 		s_texturePacker->texturesPacked++;
 		return true;
 	}
@@ -854,11 +972,12 @@ namespace TFE_Jedi
 		}
 
 		s_totalTexels += cell->sizeX * cell->sizeY;
+		s_usedTexels  += cell->sizeX * cell->sizeY;
 		insertWaxCellIntoMap(cell, s_texturePacker->texturesPacked);
 
 		assert(node->tex == cell && s_texturePacker->texturesPacked < MAX_TEXTURE_COUNT);
 		cell->textureId = s_texturePacker->texturesPacked;
-		packNodeCell(node, basePtr, cell, &s_texturePacker->textureTable[s_texturePacker->texturesPacked], padding, padding);
+		addPackJob(PACK_JOB_WAX_CELL, node, nullptr, basePtr, cell, padding, padding, 1);
 		s_texturePacker->texturesPacked++;
 		return true;
 	}
@@ -868,11 +987,14 @@ namespace TFE_Jedi
 		if (!animTex) { return true; }
 		for (s32 f = 0; f < animTex->count; f++)
 		{
+			s_curFrameIndex = f;
 			if (!insertTexture(animTex->frameList[f]))
 			{
+				s_curFrameIndex = -1;
 				return false;
 			}
 		}
+		s_curFrameIndex = -1;
 		return true;
 	}
 		
@@ -892,6 +1014,646 @@ namespace TFE_Jedi
 		return node;
 	}
 
+	///////////////////////////////////////////////////
+	// Texture Atlas Cache
+	// The packed page layout, texture table and texel
+	// data are written to disk keyed by a hash of the
+	// texture set and settings, so reloading a level or
+	// switching color modes can skip re-packing.
+	///////////////////////////////////////////////////
+	enum AtlasCacheNodeFlags
+	{
+		ACN_HAS_TEXTURE  = FLAG_BIT(0),
+		ACN_HAS_CHILDREN = FLAG_BIT(1),
+	};
+
+	struct AtlasCacheHeader
+	{
+		u32 magic;
+		u32 version;
+		u64 key;
+		s32 startTexture;	// texturesPacked before packing.
+		s32 textureCount;	// Number of textures added, which also matches the record count.
+		s32 startPage;
+		s32 endPage;		// The current page at the end of packing.
+		s32 regionCount;
+		s32 usedTexels;
+		s32 totalTexels;
+		s32 pad;
+	};
+
+	struct AtlasCacheNode
+	{
+		Vec4ui rect;
+		u32 flags;
+	};
+
+	struct AtlasCacheRegion
+	{
+		s32 page;
+		s32 mipCount;
+		Vec4ui rect;	// x, y, width, height at mip 0.
+	};
+
+	struct AtlasCacheReader
+	{
+		const u8* data;
+		size_t size;
+		size_t offset;
+	};
+
+	struct AtlasCacheIndexHeader
+	{
+		u32 magic;
+		u32 version;
+		s32 entryCount;
+		s32 pad;
+	};
+
+	struct AtlasCacheIndexEntry
+	{
+		u64 key;
+		u64 lastUse;	// Use counter value when the file was last written or loaded.
+		u64 size;		// File size in bytes.
+	};
+
+	static const u32 c_atlasCacheMagic = 0x43415054;	// "TPAC"
+	static const u32 c_atlasCacheIndexMagic = 0x58494154;	// "TAIX"
+	static const u32 c_atlasCacheVersion = 1;
+	// The least recently used files are deleted once the cache exceeds either limit.
+	static const s32 c_atlasCacheMaxFiles = 256;
+	static const u64 c_atlasCacheMaxBytes = 1024ull * 1024ull * 1024ull;	// 1GB
+	static std::map<u64, AtlasCacheIndexEntry> s_atlasCacheIndex;
+	static u64  s_atlasCacheUseCounter = 0;
+	static bool s_atlasCacheIndexLoaded = false;
+	// The key of the previous packing since the last begin/discard, since the packing
+	// depends on the state left behind by previous calls.
+	static u64  s_packChainKey = 0;
+	static bool s_packChainValid = true;
+	// Non-null placeholder for restored leaf nodes, the node texture is only used to mark the node as full.
+	static u8 s_cachedNodeTex = 0;
+
+	void atlasCache_resetChain()
+	{
+		s_packChainKey = 0;
+		s_packChainValid = true;
+	}
+
+	bool atlasCache_isEnabled()
+	{
+		return TFE_Settings::getGraphicsSettings()->textureAtlasCache && s_packChainValid;
+	}
+
+	void atlasCache_getPath(u64 key, char* path)
+	{
+		sprintf(path, "%sCache/TextureAtlas/%016llx.tac", TFE_Paths::getPath(PATH_PROGRAM_DATA), (unsigned long long)key);
+	}
+
+	void atlasCache_getIndexPath(char* path)
+	{
+		sprintf(path, "%sCache/TextureAtlas/index.dat", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+	}
+
+	void atlasCache_saveIndex()
+	{
+		char path[TFE_MAX_PATH];
+		atlasCache_getIndexPath(path);
+
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "TexturePacker", "Cannot write texture atlas cache index '%s'.", path);
+			return;
+		}
+		AtlasCacheIndexHeader header = {};
+		header.magic = c_atlasCacheIndexMagic;
+		header.version = c_atlasCacheVersion;
+		header.entryCount = (s32)s_atlasCacheIndex.size();
+		file.writeBuffer(&header, sizeof(AtlasCacheIndexHeader));
+
+		std::map<u64, AtlasCacheIndexEntry>::iterator iEntry = s_atlasCacheIndex.begin();
+		for (; iEntry != s_atlasCacheIndex.end(); ++iEntry)
+		{
+			file.writeBuffer(&iEntry->second, sizeof(AtlasCacheIndexEntry));
+		}
+		file.close();
+	}
+
+	// Load the index the first time the cache is used. Cache files that are not in the index, such as files written
+	// by an older version or left behind when the index could not be saved, are deleted so they cannot pile up.
+	void atlasCache_loadIndex()
+	{
+		if (s_atlasCacheIndexLoaded) { return; }
+		s_atlasCacheIndexLoaded = true;
+		s_atlasCacheIndex.clear();
+		s_atlasCacheUseCounter = 0;
+
+		char dir[TFE_MAX_PATH];
+		sprintf(dir, "%sCache/TextureAtlas/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		if (!FileUtil::directoryExits(dir)) { return; }
+
+		char path[TFE_MAX_PATH];
+		atlasCache_getIndexPath(path);
+		if (FileUtil::exists(path))
+		{
+			u8* buffer = nullptr;
+			const u32 size = FileStream::readContents(path, (void**)&buffer);
+			const AtlasCacheIndexHeader* header = (size >= sizeof(AtlasCacheIndexHeader)) ? (AtlasCacheIndexHeader*)buffer : nullptr;
+			if (header && header->magic == c_atlasCacheIndexMagic && header->version == c_atlasCacheVersion && header->entryCount >= 0 &&
+				size >= sizeof(AtlasCacheIndexHeader) + sizeof(AtlasCacheIndexEntry) * size_t(header->entryCount))
+			{
+				const AtlasCacheIndexEntry* entries = (AtlasCacheIndexEntry*)(buffer + sizeof(AtlasCacheIndexHeader));
+				for (s32 i = 0; i < header->entryCount; i++)
+				{
+					s_atlasCacheIndex[entries[i].key] = entries[i];
+					s_atlasCacheUseCounter = max(s_atlasCacheUseCounter, entries[i].lastUse);
+				}
+			}
+			free(buffer);
+		}
+
+		FileList files;
+		FileUtil::readDirectory(dir, "tac", files);
+		std::set<u64> filesOnDisk;
+		const size_t fileCount = files.size();
+		for (size_t i = 0; i < fileCount; i++)
+		{
+			const char* name = files[i].c_str();
+			char* end = nullptr;
+			const u64 key = (u64)strtoull(name, &end, 16);
+			if (end == name + 16 && s_atlasCacheIndex.find(key) != s_atlasCacheIndex.end())
+			{
+				filesOnDisk.insert(key);
+				continue;
+			}
+			sprintf(path, "%s%s", dir, name);
+			FileUtil::deleteFile(path);
+		}
+
+		// Drop entries whose files no longer exist.
+		const size_t indexCount = s_atlasCacheIndex.size();
+		std::map<u64, AtlasCacheIndexEntry>::iterator iEntry = s_atlasCacheIndex.begin();
+		while (iEntry != s_atlasCacheIndex.end())
+		{
+			if (filesOnDisk.find(iEntry->first) == filesOnDisk.end()) { iEntry = s_atlasCacheIndex.erase(iEntry); }
+			else { ++iEntry; }
+		}
+		if (indexCount != s_atlasCacheIndex.size() || fileCount != filesOnDisk.size())
+		{
+			atlasCache_saveIndex();
+		}
+	}
+
+	void atlasCache_removeEntry(u64 key)
+	{
+		char path[TFE_MAX_PATH];
+		atlasCache_getPath(key, path);
+		FileUtil::deleteFile(path);
+		s_atlasCacheIndex.erase(key);
+	}
+
+	// Mark the entry as the most recently used and evict the least recently used files until the cache fits the budget.
+	void atlasCache_touch(u64 key, u64 size)
+	{
+		AtlasCacheIndexEntry& entry = s_atlasCacheIndex[key];
+		entry.key = key;
+		entry.lastUse = ++s_atlasCacheUseCounter;
+		entry.size = size;
+
+		u64 totalSize = 0;
+		std::map<u64, AtlasCacheIndexEntry>::iterator iEntry = s_atlasCacheIndex.begin();
+		for (; iEntry != s_atlasCacheIndex.end(); ++iEntry)
+		{
+			totalSize += iEntry->second.size;
+		}
+		while (s_atlasCacheIndex.size() > 1 && (s32(s_atlasCacheIndex.size()) > c_atlasCacheMaxFiles || totalSize > c_atlasCacheMaxBytes))
+		{
+			std::map<u64, AtlasCacheIndexEntry>::iterator iOldest = s_atlasCacheIndex.end();
+			for (iEntry = s_atlasCacheIndex.begin(); iEntry != s_atlasCacheIndex.end(); ++iEntry)
+			{
+				if (iEntry->first != key && (iOldest == s_atlasCacheIndex.end() || iEntry->second.lastUse < iOldest->second.lastUse))
+				{
+					iOldest = iEntry;
+				}
+			}
+			totalSize -= iOldest->second.size;
+			atlasCache_removeEntry(iOldest->first);
+		}
+		atlasCache_saveIndex();
+	}
+
+	u64 atlasCache_hashTexture(const TextureData* tex, u64 hash, std::map<const void*, s32>& hashed)
+	{
+		if (!tex) { return TFE_Hash::hashValue(-1, hash); }
+		// Textures packed by a previous call are referenced by ID.
+		std::map<TextureData*, s32>::iterator iPacked = s_textureDataMap.find((TextureData*)tex);
+		if (iPacked != s_textureDataMap.end()) { return TFE_Hash::hashValue(-2 - iPacked->second, hash); }
+		// The same texture may show up multiple times in the list.
+		std::map<const void*, s32>::iterator iHashed = hashed.find(tex);
+		if (iHashed != hashed.end()) { return TFE_Hash::hashValue(iHashed->second, hash); }
+		hashed[tex] = (s32)hashed.size();
+
+		const u32 desc[] = { tex->width, tex->height, tex->flags, tex->palIndex };
+		hash = TFE_Hash::hashBuffer(desc, sizeof(desc), hash);
+		return tex->image ? TFE_Hash::hashBuffer(tex->image, size_t(tex->width) * size_t(tex->height), hash) : hash;
+	}
+
+	u64 atlasCache_hashAnimation(const AnimatedTexture* animTex, u64 hash, std::map<const void*, s32>& hashed)
+	{
+		if (!animTex) { return TFE_Hash::hashValue(-1, hash); }
+		hash = TFE_Hash::hashValue(animTex->count, hash);
+		for (s32 f = 0; f < animTex->count; f++)
+		{
+			hash = atlasCache_hashTexture(animTex->frameList[f], hash, hashed);
+		}
+		return hash;
+	}
+
+	u64 atlasCache_hashCell(const void* basePtr, const WaxFrame* frame, u64 hash, std::map<const void*, s32>& hashed)
+	{
+		const WaxCell* cell = (basePtr && frame) ? WAX_CellPtr(basePtr, frame) : nullptr;
+		if (!cell) { return TFE_Hash::hashValue(-1, hash); }
+		std::map<WaxCell*, s32>::iterator iPacked = s_waxDataMap.find((WaxCell*)cell);
+		if (iPacked != s_waxDataMap.end()) { return TFE_Hash::hashValue(-2 - iPacked->second, hash); }
+		std::map<const void*, s32>::iterator iHashed = hashed.find(cell);
+		if (iHashed != hashed.end()) { return TFE_Hash::hashValue(iHashed->second, hash); }
+		hashed[cell] = (s32)hashed.size();
+
+		const s32 desc[] = { cell->sizeX, cell->sizeY };
+		hash = TFE_Hash::hashBuffer(desc, sizeof(desc), hash);
+
+		u8 columnWorkBuffer[WAX_DECOMPRESS_SIZE];
+		for (s32 x = 0; x < cell->sizeX; x++)
+		{
+			hash = TFE_Hash::hashBuffer(getCellColumn(basePtr, cell, x, columnWorkBuffer), cell->sizeY, hash);
+		}
+		return hash;
+	}
+
+	// Note: this must be called before the list is sorted.
+	u64 atlasCache_computeKey(const TextureInfo* list, s32 count)
+	{
+		u64 hash = TFE_Hash::hashValue(c_atlasCacheVersion);
+		hash = TFE_Hash::hashValue(s_packChainKey, hash);
+
+		// Settings and starting state.
+		const s32 state[] =
+		{
+			s_texturePacker->width, s_texturePacker->height, s_texturePacker->trueColor ? 1 : 0, (s32)s_texturePacker->bytesPerTexel,
+			(s32)s_texturePacker->mipCount, (s32)s_texturePacker->mipPadding, s_texturePacker->reservedPages, s_texturePacker->texturesPacked,
+			s_colorIndexStart, (s32)s_assetPool, count
+		};
+		hash = TFE_Hash::hashBuffer(state, sizeof(state), hash);
+
+		// Conversion palettes and remap tables.
+		if (s_texturePacker->trueColor)
+		{
+			hash = TFE_Hash::hashBuffer(s_conversionPal, sizeof(s_conversionPal), hash);
+			if (TFE_DarkForces::s_levelColorMap)
+			{
+				hash = TFE_Hash::hashBuffer(&TFE_DarkForces::s_levelColorMap[16 << 8], 256, hash);
+				hash = TFE_Hash::hashBuffer(&TFE_DarkForces::s_levelColorMap[31 << 8], 256, hash);
+			}
+		}
+
+		// Texture set.
+		std::map<const void*, s32> hashed;
+		for (s32 i = 0; i < count; i++)
+		{
+			hash = TFE_Hash::hashValue((s32)list[i].type, hash);
+			switch (list[i].type)
+			{
+				case TEXINFO_DF_TEXTURE_DATA:
+				{
+					if (list[i].texData && list[i].texData->uvWidth == BM_ANIMATED_TEXTURE)
+					{
+						hash = atlasCache_hashAnimation((AnimatedTexture*)list[i].texData->image, hash, hashed);
+					}
+					else
+					{
+						hash = atlasCache_hashTexture(list[i].texData, hash, hashed);
+					}
+				} break;
+				case TEXINFO_DF_DELT_TEX:
+				{
+					hash = atlasCache_hashTexture(list[i].texData, hash, hashed);
+				} break;
+				case TEXINFO_DF_ANIM_TEX:
+				{
+					hash = atlasCache_hashAnimation(list[i].animTex, hash, hashed);
+				} break;
+				case TEXINFO_DF_WAX_CELL:
+				{
+					hash = atlasCache_hashCell(list[i].basePtr, list[i].frame, hash, hashed);
+				} break;
+			}
+		}
+		return hash;
+	}
+
+	void atlasCache_writeTree(const TextureNode* node, std::vector<AtlasCacheNode>& nodes)
+	{
+		AtlasCacheNode cacheNode;
+		cacheNode.rect = node->rect;
+		cacheNode.flags = (node->tex ? ACN_HAS_TEXTURE : 0) | (node->child[0] ? ACN_HAS_CHILDREN : 0);
+		nodes.push_back(cacheNode);
+
+		if (node->child[0])
+		{
+			atlasCache_writeTree(node->child[0], nodes);
+			atlasCache_writeTree(node->child[1], nodes);
+		}
+	}
+
+	TextureNode* atlasCache_readTree(const AtlasCacheNode* nodes, s32 count, s32& index)
+	{
+		if (index >= count) { return nullptr; }
+		const AtlasCacheNode* cacheNode = &nodes[index];
+		index++;
+
+		TextureNode* node = allocateNode();
+		node->rect = cacheNode->rect;
+		node->tex = (cacheNode->flags & ACN_HAS_TEXTURE) ? &s_cachedNodeTex : nullptr;
+		if (cacheNode->flags & ACN_HAS_CHILDREN)
+		{
+			node->child[0] = atlasCache_readTree(nodes, count, index);
+			node->child[1] = atlasCache_readTree(nodes, count, index);
+		}
+		return node;
+	}
+
+	// Size of a region at a given mip level, this matches the area written by generateMipmap().
+	void atlasCache_getRegionMip(const AtlasCacheRegion* region, s32 mip, u32& x, u32& y, u32& w, u32& h)
+	{
+		x = region->rect.x >> mip;
+		y = region->rect.y >> mip;
+		w = region->rect.z >> mip;
+		h = region->rect.w >> mip;
+	}
+
+	void atlasCache_write(u64 key, s32 startTexture, s32 startPage, s32 usedTexels, s32 totalTexels)
+	{
+		char path[TFE_MAX_PATH];
+		sprintf(path, "%sCache/", TFE_Paths::getPath(PATH_PROGRAM_DATA));
+		FileUtil::makeDirectory(path);
+		strcat(path, "TextureAtlas/");
+		FileUtil::makeDirectory(path);
+		atlasCache_loadIndex();
+		atlasCache_getPath(key, path);
+
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_WARNING, "TexturePacker", "Cannot write texture atlas cache '%s'.", path);
+			return;
+		}
+
+		AtlasCacheHeader header = {};
+		header.magic = c_atlasCacheMagic;
+		header.version = c_atlasCacheVersion;
+		header.key = key;
+		header.startTexture = startTexture;
+		header.textureCount = s_texturePacker->texturesPacked - startTexture;
+		header.startPage = startPage;
+		header.endPage = s_currentPage;
+		header.regionCount = (s32)s_packJobs.size();
+		header.usedTexels = usedTexels;
+		header.totalTexels = totalTexels;
+		file.writeBuffer(&header, sizeof(AtlasCacheHeader));
+
+		assert(s_packRecords.size() == size_t(header.textureCount));
+		file.writeBuffer(s_packRecords.data(), u32(sizeof(PackRecord) * s_packRecords.size()));
+		file.writeBuffer(&s_texturePacker->textureTable[startTexture], u32(sizeof(Vec4i) * header.textureCount));
+
+		// Page layout.
+		std::vector<AtlasCacheNode> nodes;
+		for (s32 p = startPage; p <= s_currentPage; p++)
+		{
+			nodes.clear();
+			if (s_texturePacker->pages[p]->root)
+			{
+				atlasCache_writeTree(s_texturePacker->pages[p]->root, nodes);
+			}
+			const s32 nodeCount = (s32)nodes.size();
+			file.writeBuffer(&nodeCount, sizeof(s32));
+			file.writeBuffer(nodes.data(), u32(sizeof(AtlasCacheNode) * nodeCount));
+		}
+
+		// Texel data, only the areas written by each texture are stored.
+		const u32 bytesPerTexel = s_texturePacker->bytesPerTexel;
+		const s32 jobCount = (s32)s_packJobs.size();
+		for (s32 j = 0; j < jobCount; j++)
+		{
+			const PackJob* job = &s_packJobs[j];
+			AtlasCacheRegion region;
+			region.page = job->page;
+			region.mipCount = job->mipCount;
+			region.rect = { job->rect.x, job->rect.y, (u32)job->width, (u32)job->height };
+			file.writeBuffer(&region, sizeof(AtlasCacheRegion));
+
+			for (s32 m = 0; m < region.mipCount; m++)
+			{
+				u32 x, y, w, h;
+				atlasCache_getRegionMip(&region, m, x, y, w, h);
+				const u32 stride = (s_texturePacker->width >> m) * bytesPerTexel;
+				const u8* src = getWritePointer(region.page, region.rect.x, region.rect.y, m);
+				for (u32 r = 0; r < h; r++, src += stride)
+				{
+					file.writeBuffer(src, w * bytesPerTexel);
+				}
+			}
+		}
+		const u64 fileSize = (u64)file.getSize();
+		file.close();
+		atlasCache_touch(key, fileSize);
+	}
+
+	const void* atlasCache_read(AtlasCacheReader* reader, size_t size)
+	{
+		if (reader->offset + size > reader->size) { return nullptr; }
+		const void* data = reader->data + reader->offset;
+		reader->offset += size;
+		return data;
+	}
+
+	void* atlasCache_resolveRecord(const TextureInfo* list, s32 count, const PackRecord* record, bool* isCell)
+	{
+		*isCell = false;
+		if (record->listIndex < 0 || record->listIndex >= count) { return nullptr; }
+
+		const TextureInfo* info = &list[record->listIndex];
+		AnimatedTexture* animTex = nullptr;
+		switch (info->type)
+		{
+			case TEXINFO_DF_TEXTURE_DATA:
+			{
+				if (!info->texData) { return nullptr; }
+				if (info->texData->uvWidth != BM_ANIMATED_TEXTURE) { return record->frameIndex < 0 ? info->texData : nullptr; }
+				animTex = (AnimatedTexture*)info->texData->image;
+			} break;
+			case TEXINFO_DF_DELT_TEX:
+			{
+				return record->frameIndex < 0 ? info->texData : nullptr;
+			} break;
+			case TEXINFO_DF_ANIM_TEX:
+			{
+				animTex = info->animTex;
+			} break;
+			case TEXINFO_DF_WAX_CELL:
+			{
+				*isCell = true;
+				return (info->basePtr && info->frame) ? WAX_CellPtr(info->basePtr, info->frame) : nullptr;
+			} break;
+			default:
+				return nullptr;
+		}
+
+		if (!animTex || record->frameIndex < 0 || record->frameIndex >= animTex->count) { return nullptr; }
+		return animTex->frameList[record->frameIndex];
+	}
+
+	// Returns true if the cached packing was found and applied, in which case no further packing is required.
+	bool atlasCache_tryLoad(u64 key, const TextureInfo* list, s32 count)
+	{
+		char path[TFE_MAX_PATH];
+		atlasCache_loadIndex();
+		if (s_atlasCacheIndex.find(key) == s_atlasCacheIndex.end()) { return false; }
+		atlasCache_getPath(key, path);
+		if (!FileUtil::exists(path)) { return false; }
+
+		u8* buffer = nullptr;
+		const u32 size = FileStream::readContents(path, (void**)&buffer);
+		AtlasCacheReader reader = { buffer, size, 0 };
+
+		// Validate everything before touching the packer state.
+		const AtlasCacheHeader* header = (AtlasCacheHeader*)atlasCache_read(&reader, sizeof(AtlasCacheHeader));
+		bool valid = header && header->magic == c_atlasCacheMagic && header->version == c_atlasCacheVersion && header->key == key &&
+			header->startTexture == s_texturePacker->texturesPacked && header->startPage == s_texturePacker->reservedPages &&
+			header->textureCount >= 0 && header->startTexture + header->textureCount <= MAX_TEXTURE_COUNT &&
+			header->endPage >= header->startPage && header->endPage < MAX_TEXTURE_PAGES && header->regionCount >= 0;
+
+		const PackRecord* records = nullptr;
+		const Vec4i* table = nullptr;
+		std::vector<void*> resolved;
+		std::vector<bool> resolvedIsCell;
+		if (valid)
+		{
+			records = (PackRecord*)atlasCache_read(&reader, sizeof(PackRecord) * header->textureCount);
+			table = (Vec4i*)atlasCache_read(&reader, sizeof(Vec4i) * header->textureCount);
+			valid = records && table;
+		}
+		if (valid)
+		{
+			resolved.resize(header->textureCount);
+			resolvedIsCell.resize(header->textureCount);
+			for (s32 i = 0; i < header->textureCount && valid; i++)
+			{
+				bool isCell;
+				resolved[i] = atlasCache_resolveRecord(list, count, &records[i], &isCell);
+				resolvedIsCell[i] = isCell;
+				valid = resolved[i] != nullptr;
+			}
+		}
+		size_t treeOffset = reader.offset;
+		for (s32 p = header ? header->startPage : 0; valid && p <= header->endPage; p++)
+		{
+			const s32* nodeCount = (s32*)atlasCache_read(&reader, sizeof(s32));
+			valid = nodeCount && *nodeCount >= 0 && atlasCache_read(&reader, sizeof(AtlasCacheNode) * (*nodeCount));
+		}
+		size_t regionOffset = reader.offset;
+		const u32 bytesPerTexel = s_texturePacker->bytesPerTexel;
+		for (s32 r = 0; valid && r < header->regionCount; r++)
+		{
+			const AtlasCacheRegion* region = (AtlasCacheRegion*)atlasCache_read(&reader, sizeof(AtlasCacheRegion));
+			valid = region && region->page >= header->startPage && region->page <= header->endPage && region->mipCount >= 1 &&
+				region->mipCount <= (s32)s_texturePacker->mipCount && region->rect.x + region->rect.z <= (u32)s_texturePacker->width &&
+				region->rect.y + region->rect.w <= (u32)s_texturePacker->height;
+			for (s32 m = 0; valid && m < region->mipCount; m++)
+			{
+				u32 x, y, w, h;
+				atlasCache_getRegionMip(region, m, x, y, w, h);
+				valid = atlasCache_read(&reader, w * h * bytesPerTexel) != nullptr;
+			}
+		}
+		if (!valid)
+		{
+			TFE_System::logWrite(LOG_WARNING, "TexturePacker", "Texture atlas cache '%s' is invalid, re-packing.", path);
+			free(buffer);
+			atlasCache_removeEntry(key);
+			atlasCache_saveIndex();
+			return false;
+		}
+
+		// Pages.
+		for (s32 p = s_texturePacker->pageCount; p <= header->endPage; p++)
+		{
+			s_texturePacker->pages[p] = allocateTexturePage(s_texturePacker->pageSize);
+		}
+		s_texturePacker->pageCount = max(s_texturePacker->pageCount, header->endPage + 1);
+
+		// Texture table and IDs.
+		memcpy(&s_texturePacker->textureTable[header->startTexture], table, sizeof(Vec4i) * header->textureCount);
+		for (s32 i = 0; i < header->textureCount; i++)
+		{
+			const s32 id = header->startTexture + i;
+			if (resolvedIsCell[i])
+			{
+				WaxCell* cell = (WaxCell*)resolved[i];
+				cell->textureId = id;
+				insertWaxCellIntoMap(cell, id);
+			}
+			else
+			{
+				TextureData* tex = (TextureData*)resolved[i];
+				tex->textureId = id;
+				insertTextureIntoMap(tex, id);
+			}
+		}
+		s_texturePacker->texturesPacked = header->startTexture + header->textureCount;
+
+		// Page layout.
+		reader.offset = treeOffset;
+		for (s32 p = header->startPage; p <= header->endPage; p++)
+		{
+			const s32 nodeCount = *(s32*)atlasCache_read(&reader, sizeof(s32));
+			const AtlasCacheNode* nodes = (AtlasCacheNode*)atlasCache_read(&reader, sizeof(AtlasCacheNode) * nodeCount);
+			s32 index = 0;
+			s_texturePacker->pages[p]->root = atlasCache_readTree(nodes, nodeCount, index);
+		}
+		s_currentPage = header->endPage;
+		s_root = s_texturePacker->pages[s_currentPage]->root;
+		if (!s_root)
+		{
+			insertNode(nullptr, nullptr, 0, 0);
+			s_texturePacker->pages[s_currentPage]->root = s_root;
+		}
+
+		// Texel data.
+		reader.offset = regionOffset;
+		for (s32 r = 0; r < header->regionCount; r++)
+		{
+			const AtlasCacheRegion* region = (AtlasCacheRegion*)atlasCache_read(&reader, sizeof(AtlasCacheRegion));
+			for (s32 m = 0; m < region->mipCount; m++)
+			{
+				u32 x, y, w, h;
+				atlasCache_getRegionMip(region, m, x, y, w, h);
+				const u32 stride = (s_texturePacker->width >> m) * bytesPerTexel;
+				u8* dst = getWritePointer(region->page, region->rect.x, region->rect.y, m);
+				const u8* src = (u8*)atlasCache_read(&reader, w * h * bytesPerTexel);
+				for (u32 row = 0; row < h; row++, dst += stride, src += w * bytesPerTexel)
+				{
+					memcpy(dst, src, w * bytesPerTexel);
+				}
+			}
+		}
+
+		s_usedTexels  += header->usedTexels;
+		s_totalTexels += header->totalTexels;
+		free(buffer);
+		atlasCache_touch(key, size);
+		return true;
+	}
+
 	// Begin the packing process, this clears out the texture packer.
 	bool texturepacker_begin(TexturePacker* texturePacker)
 	{
@@ -940,6 +1702,7 @@ namespace TFE_Jedi
 			}
 
 			// Free the existing texture.
+			if (texturePacker == s_uploadPacker) { cancelPageUploads(); }
 			TFE_RenderBackend::freeTexture(texturePacker->texture);
 			texturePacker->texture = nullptr;
 		}
@@ -959,6 +1722,7 @@ namespace TFE_Jedi
 		s_textureDataMap.clear();
 		s_waxDataMap.clear();
 		s_texInfoPool.clear();
+		atlasCache_resetChain();
 
 		// Insert the parent that covers all of the available space.
 		s_root = nullptr;
@@ -967,13 +1731,182 @@ namespace TFE_Jedi
 		return true;
 	}
 
+	void updateUploadCounters()
+	{
+		const u64 pending = s_uploadBytesTotal - s_uploadBytesDone;
+		s_uploadPendingKB = s32(pending >> 10);
+		s_uploadProgress = s_uploadBytesTotal ? s32(s_uploadBytesDone * 100 / s_uploadBytesTotal) : 100;
+	}
+
+	void cancelPageUploads()
+	{
+		if (s_uploadClampLod && s_uploadPacker && s_uploadPacker->texture && s_pageUploadIndex < (s32)s_pageUploads.size())
+		{
+			s_uploadPacker->texture->setMinLod(0.0f);
+		}
+		s_uploadClampLod = false;
+		s_pageUploads.clear();
+		s_pageUploadIndex = 0;
+		s_pageUploadRow = 0;
+		s_uploadBytesTotal = 0;
+		s_uploadBytesDone = 0;
+		updateUploadCounters();
+	}
+
+	// 8-bit pages hold palette indices, so find the closest match to the fallback color in the level palette.
+	u32 getFallbackTexel()
+	{
+		if (s_texturePacker->bytesPerTexel == 4) { return c_uploadFallbackColor; }
+
+		const u32* pal = getPalette(1);
+		s32 bestIndex = 0;
+		s32 bestDist = INT_MAX;
+		// Skip index 0, it is transparent.
+		for (s32 i = 1; i < PALETTE_SIZE; i++)
+		{
+			const s32 dr = s32(pal[i] & 0xff) - s32(c_uploadFallbackColor & 0xff);
+			const s32 dg = s32((pal[i] >> 8u) & 0xff) - s32((c_uploadFallbackColor >> 8u) & 0xff);
+			const s32 db = s32((pal[i] >> 16u) & 0xff) - s32((c_uploadFallbackColor >> 16u) & 0xff);
+			const s32 dist = dr*dr + dg*dg + db*db;
+			if (dist < bestDist)
+			{
+				bestDist = dist;
+				bestIndex = i;
+			}
+		}
+		return u32(bestIndex);
+	}
+
+	// Queue pages [startPage, pageCount) to be streamed in by texturepacker_streamUploads().
+	// Until a page arrives it is sampled from its coarsest mip if available, otherwise it is filled with a solid color.
+	void queuePageUploads(s32 startPage)
+	{
+		TextureGpu* texture = s_texturePacker->texture;
+		if (!s_textureStream.getBufferSize())
+		{
+			s_textureStream.create(c_uploadStagingSize);
+		}
+		s_uploadPacker = s_texturePacker;
+
+		const s32 pageCount = s_texturePacker->pageCount;
+		const u32 bytesPerTexel = s_texturePacker->bytesPerTexel;
+		s32 streamMip = (s32)s_texturePacker->mipCount - 1;
+		// The min LOD applies to every layer of the texture, so it can only be used when there are no reserved pages,
+		// otherwise the HUD and UI textures would drop resolution while the level textures stream in.
+		s_uploadClampLod = streamMip > 0 && s_texturePacker->reservedPages == 0;
+		if (s_uploadClampLod)
+		{
+			// The coarsest mip is tiny, so upload it right away and clamp sampling to it until the finer mips are resident.
+			const u32 width  = s_texturePacker->width  >> streamMip;
+			const u32 height = s_texturePacker->height >> streamMip;
+			for (s32 page = startPage; page < pageCount; page++)
+			{
+				texture->update(getWritePointer(page, 0, 0, streamMip), width * height * bytesPerTexel, page, streamMip);
+			}
+			texture->setMinLod(f32(streamMip));
+			streamMip--;
+		}
+		else
+		{
+			// Every mip that can be sampled is filled, the fill data is only transferred once.
+			const u32 fallbackTexel = getFallbackTexel();
+			for (s32 mip = 0; mip <= streamMip; mip++)
+			{
+				for (s32 page = startPage; page < pageCount; page++)
+				{
+					s_textureStream.fillRows(texture, fallbackTexel, page, mip, 0, s_texturePacker->height >> mip);
+				}
+			}
+		}
+
+		s_pageUploads.clear();
+		s_uploadBytesTotal = 0;
+		for (s32 mip = streamMip; mip >= 0; mip--)
+		{
+			const u64 mipSize = u64(s_texturePacker->width >> mip) * u64(s_texturePacker->height >> mip) * bytesPerTexel;
+			for (s32 page = startPage; page < pageCount; page++)
+			{
+				s_pageUploads.push_back({ page, mip });
+				s_uploadBytesTotal += mipSize;
+			}
+		}
+		s_pageUploadIndex = 0;
+		s_pageUploadRow = 0;
+		s_uploadBytesDone = 0;
+		updateUploadCounters();
+	}
+
+	void texturepacker_streamUploads()
+	{
+		s_uploadFrameKB = 0;
+		if (s_pageUploadIndex >= (s32)s_pageUploads.size()) { return; }
+		// The packer changed without a commit, the queued pages are no longer valid.
+		if (s_uploadPacker != s_texturePacker || !s_texturePacker->texture)
+		{
+			cancelPageUploads();
+			return;
+		}
+		TFE_ZONE("Texture Streaming");
+
+		TextureGpu* texture = s_texturePacker->texture;
+		const s32 budgetMB = TFE_Settings::getGraphicsSettings()->textureUploadBudget;
+		// A budget of 0 means streaming was disabled mid-upload, so finish everything now.
+		s64 budget = budgetMB > 0 ? s64(budgetMB) * 1024 * 1024 : s64(s_uploadBytesTotal);
+		u64 frameBytes = 0;
+
+		const s32 uploadCount = (s32)s_pageUploads.size();
+		while (budget > 0 && s_pageUploadIndex < uploadCount)
+		{
+			const PageUpload& upload = s_pageUploads[s_pageUploadIndex];
+			const u32 width   = s_texturePacker->width  >> upload.mip;
+			const u32 height  = s_texturePacker->height >> upload.mip;
+			const u32 rowBytes = width * s_texturePacker->bytesPerTexel;
+			// Always make progress, even if the budget is smaller than a single row.
+			const u32 rowCount = std::min(height - s_pageUploadRow, std::max(1u, u32(std::min(budget / rowBytes, s64(height)))));
+
+			const u8* src = getWritePointer(upload.page, 0, s_pageUploadRow, upload.mip);
+			s_textureStream.uploadRows(texture, src, upload.page, upload.mip, s_pageUploadRow, rowCount);
+
+			const u32 bytes = rowCount * rowBytes;
+			budget -= bytes;
+			frameBytes += bytes;
+			s_pageUploadRow += rowCount;
+			if (s_pageUploadRow < height) { continue; }
+
+			// The slice is complete, move on to the next.
+			s_pageUploadRow = 0;
+			s_pageUploadIndex++;
+			// Once every page has this mip, it becomes the new finest level that can be sampled.
+			const bool mipComplete = s_pageUploadIndex >= uploadCount || s_pageUploads[s_pageUploadIndex].mip != upload.mip;
+			if (mipComplete && s_uploadClampLod)
+			{
+				texture->setMinLod(f32(upload.mip));
+			}
+		}
+		s_uploadBytesDone += frameBytes;
+		s_uploadFrameKB = s32(frameBytes >> 10);
+
+		if (s_pageUploadIndex >= uploadCount)
+		{
+			s_pageUploads.clear();
+			s_pageUploadIndex = 0;
+			s_uploadBytesTotal = 0;
+			s_uploadBytesDone = 0;
+		}
+		updateUploadCounters();
+	}
+
 	// Commit the final packing to GPU memory.
-	void texturepacker_commit()
+	void texturepacker_commit(bool immediate)
 	{
+		// Uploads left over from a previous commit are replaced by this one.
+		cancelPageUploads();
+
 		// Update the texture table.
 		s_texturePacker->textureTableGPU.update(s_texturePacker->textureTable, sizeof(Vec4i) * s_texturePacker->texturesPacked);
 
 		// Create the texture if one doesn't exist or we need more layers.
+		bool textureCreated = false;
 		if (!s_texturePacker->texture || s_texturePacker->pageCount > (s32)s_texturePacker->texture->getLayers())
 		{
 			if (s_texturePacker->texture)
@@ -983,8 +1916,16 @@ namespace TFE_Jedi
 			// Allocate at least 2 layers.
 			s_texturePacker->texture = TFE_RenderBackend::createTextureArray(s_texturePacker->width, s_texturePacker->height,
 				max(2, s_texturePacker->pageCount), s_texturePacker->bytesPerTexel, s_texturePacker->mipCount);
+			textureCreated = true;
 		}
-				
+		if (!s_texturePacker->texture) { return; }
+
+		// Reserved pages are already on the GPU unless the texture was just created.
+		const s32 firstPage = textureCreated ? 0 : s_texturePacker->reservedPages;
+		// Reserved pages are always uploaded right away, the rest are streamed in over the next few frames if there is a budget.
+		const bool stream = !immediate && TFE_Settings::getGraphicsSettings()->textureUploadBudget > 0;
+		const s32 streamPage = stream ? max(firstPage, s_texturePacker->reservedPages) : s_texturePacker->pageCount;
+
 		// Then update each page.
 		u32 width  = s_texturePacker->width;
 		u32 height = s_texturePacker->height;
@@ -992,7 +1933,7 @@ namespace TFE_Jedi
 		for (u32 mip = 0; mip < s_texturePacker->mipCount; mip++)
 		{
 			const size_t size = width * height * bytesPerTexel;
-			for (s32 page = 0; page < s_texturePacker->pageCount; page++)
+			for (s32 page = firstPage; page < streamPage; page++)
 			{
 				const u8* image = getWritePointer(page, 0, 0, mip);
 				s_texturePacker->texture->update(image, size, page, mip);
@@ -1001,6 +1942,11 @@ namespace TFE_Jedi
 			height >>= 1;
 		}
 
+		if (streamPage < s_texturePacker->pageCount)
+		{
+			queuePageUploads(streamPage);
+		}
+
 		// Write out the debug atlas if enabled.
 		#if DEBUG_TEXTURE_ATLAS
 			debug_writeOutAtlas();
@@ -1046,8 +1992,33 @@ namespace TFE_Jedi
 						list[i].sortKey = cell ? cell->sizeX * cell->sizeY : 0;
 					} break;
 				}
+				list[i].listIndex = i;
 			}
 
+			// Skip packing entirely if the same texture set has already been packed with the same settings.
+			u64 cacheKey = 0;
+			const bool useCache = atlasCache_isEnabled();
+			if (useCache)
+			{
+				cacheKey = atlasCache_computeKey(list, count);
+				if (atlasCache_tryLoad(cacheKey, list, count))
+				{
+					s_packChainKey = cacheKey;
+					return s_texturePacker->texturesPacked;
+				}
+			}
+			else
+			{
+				// Later packs cannot be cached until the packer is cleared.
+				s_packChainValid = false;
+			}
+			const s32 startTexture = s_texturePacker->texturesPacked;
+			const s32 startPage = s_texturePacker->reservedPages;
+			const s32 startUsedTexels = s_usedTexels;
+			const s32 startTotalTexels = s_totalTexels;
+			s_packJobs.clear();
+			s_packRecords.clear();
+
 			// 2. Sort textures by perimeter from largest to smallest - simplified to w+h
 			std::qsort(list, size_t(count), sizeof(TextureInfo), textureSort);
 
@@ -1091,6 +2062,7 @@ namespace TFE_Jedi
 
 				for (s32 i = 0; i < count; i++)
 				{
+					s_curListIndex = unpackedList[i]->listIndex;
 					switch (unpackedList[i]->type)
 					{
 						case TEXINFO_DF_TEXTURE_DATA:
@@ -1159,6 +2131,15 @@ namespace TFE_Jedi
 					}
 				}
 			}
+
+			// 5. Convert the textures and generate mipmaps now that everything has a place.
+			TFE_System::threadPool_parallelFor((s32)s_packJobs.size(), runPackJob, nullptr);
+
+			if (useCache)
+			{
+				atlasCache_write(cacheKey, startTexture, startPage, s_usedTexels - startUsedTexels, s_totalTexels - startTotalTexels);
+				s_packChainKey = cacheKey;
+			}
 		}
 		return s_texturePacker->texturesPacked;
 	}
@@ -1174,6 +2155,7 @@ namespace TFE_Jedi
 		if (!texturePacker) { return; }
 
 		// Free the existing pages...
+		if (texturePacker == s_uploadPacker) { cancelPageUploads(); }
 		for (s32 i = 1; i < texturePacker->pageCount; i++)
 		{
 			free(texturePacker->pages[i]->backingMemory);
@@ -1194,6 +2176,7 @@ namespace TFE_Jedi
 		s_textureDataMap.clear();
 		s_waxDataMap.clear();
 		s_texInfoPool.clear();
+		atlasCache_resetChain();
 
 		texturepacker_begin(s_globalTexturePacker);
 	}
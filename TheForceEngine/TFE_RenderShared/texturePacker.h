@@ -64,7 +64,10 @@ namespace TFE_Jedi
 	// Begin the packing process, this clears out the texture packer.
 	bool texturepacker_begin(TexturePacker* texturePacker);
 	// Commit the final packing to GPU memory.
-	void texturepacker_commit();
+	// Unless 'immediate' is set, unreserved pages are streamed in over several frames based on the texture upload budget.
+	void texturepacker_commit(bool immediate = false);
+	// Upload the next set of pending page slices, called once per frame.
+	void texturepacker_streamUploads();
 
 	// Reset the texture packer for new games.
 	void texturepacker_reset();
@@ -343,6 +343,9 @@ namespace TFE_Settings
 		writeKeyValue_Bool(settings, "show_fps", s_graphicsSettings.showFps);
 		writeKeyValue_Bool(settings, "3doNormalFix", s_graphicsSettings.fix3doNormalOverflow);
 		writeKeyValue_Bool(settings, "ignore3doLimits", s_graphicsSettings.ignore3doLimits);
+		writeKeyValue_Bool(settings, "textureAtlasCache", s_graphicsSettings.textureAtlasCache);
+		writeKeyValue_Bool(settings, "shaderCache", s_graphicsSettings.shaderCache);
+		writeKeyValue_Int(settings, "textureUploadBudget", s_graphicsSettings.textureUploadBudget);
 		writeKeyValue_Bool(settings, "ditheredBilinear", s_graphicsSettings.ditheredBilinear);
 		
 		writeKeyValue_Bool(settings, "useBilinear", s_graphicsSettings.useBilinear);
@@ -351,6 +354,8 @@ namespace TFE_Settings
 		writeKeyValue_Float(settings, "anisotropyQuality", s_graphicsSettings.anisotropyQuality);
 
 		writeKeyValue_Int(settings, "frameRateLimit", s_graphicsSettings.frameRateLimit);
+		writeKeyValue_Int(settings, "simulationStep", s_graphicsSettings.simulationStep);
+		writeKeyValue_Bool(settings, "interpolateCamera", s_graphicsSettings.interpolateCamera);
 		writeKeyValue_Float(settings, "brightness", s_graphicsSettings.brightness);
 		writeKeyValue_Float(settings, "contrast", s_graphicsSettings.contrast);
 		writeKeyValue_Float(settings, "saturation", s_graphicsSettings.saturation);
@@ -405,6 +410,8 @@ namespace TFE_Settings
 		writeKeyValue_Bool(settings, "gameExitsToMenu",   s_systemSettings.gameQuitExitsToMenu);
 		writeKeyValue_Bool(settings, "returnToModLoader", s_systemSettings.returnToModLoader);
 		writeKeyValue_Float(settings, "gifRecordingFramerate", s_systemSettings.gifRecordingFramerate);
+		writeKeyValue_Bool(settings, "tlsfRegionAllocator", s_systemSettings.tlsfRegionAllocator);
+		writeKeyValue_Bool(settings, "prefaultRegions", s_systemSettings.prefaultRegions);
 	}
 
 	void writeA11ySettings(FileStream& settings)
@@ -670,6 +677,18 @@ namespace TFE_Settings
 		{
 			s_graphicsSettings.ignore3doLimits = parseBool(value);
 		}
+		else if (strcasecmp("textureAtlasCache", key) == 0)
+		{
+			s_graphicsSettings.textureAtlasCache = parseBool(value);
+		}
+		else if (strcasecmp("shaderCache", key) == 0)
+		{
+			s_graphicsSettings.shaderCache = parseBool(value);
+		}
+		else if (strcasecmp("textureUploadBudget", key) == 0)
+		{
+			s_graphicsSettings.textureUploadBudget = std::min(std::max(parseInt(value), 0), (s32)TEXTURE_UPLOAD_BUDGET_MAX);
+		}
 		else if (strcasecmp("ditheredBilinear", key) == 0)
 		{
 			s_graphicsSettings.ditheredBilinear = parseBool(value);
@@ -694,6 +713,14 @@ namespace TFE_Settings
 		{
 			s_graphicsSettings.frameRateLimit = parseInt(value);
 		}
+		else if (strcasecmp("simulationStep", key) == 0)
+		{
+			s_graphicsSettings.simulationStep = std::min(std::max(parseInt(value), 0), (s32)SIMULATION_STEP_MAX);
+		}
+		else if (strcasecmp("interpolateCamera", key) == 0)
+		{
+			s_graphicsSettings.interpolateCamera = parseBool(value);
+		}
 		else if (strcasecmp("brightness", key) == 0)
 		{
 			s_graphicsSettings.brightness = parseFloat(value);
@@ -864,6 +891,14 @@ namespace TFE_Settings
 		{
 			s_systemSettings.gifRecordingFramerate = parseFloat(value);
 		}
+		else if (strcasecmp("tlsfRegionAllocator", key) == 0)
+		{
+			s_systemSettings.tlsfRegionAllocator = parseBool(value);
+		}
+		else if (strcasecmp("prefaultRegions", key) == 0)
+		{
+			s_systemSettings.prefaultRegions = parseBool(value);
+		}
 	}
 	
 	void parseA11ySettings(const char* key, const char* value)
@@ -29,6 +29,13 @@ enum ColorMode
 	COLORMODE_COUNT,
 };
 
+// Setting limits shared by the settings file and the UI.
+enum SettingLimits
+{
+	TEXTURE_UPLOAD_BUDGET_MAX = 64,	// MB of texture pages uploaded per frame.
+	SIMULATION_STEP_MAX = 4,		// Fixed simulation step in ticks (36 Hz).
+};
+
 static const char* c_tfeSkyModeStrings[] =
 {
 	"Vanilla",		// SKYMODE_VANILLA
@@ -66,7 +73,12 @@ struct TFE_Settings_Graphics
 	bool  showFps = false;
 	bool  fix3doNormalOverflow = true;
 	bool  ignore3doLimits = true;
+	bool  textureAtlasCache = true;
+	bool  shaderCache = true;
+	s32   textureUploadBudget = 16;	// MB of texture pages uploaded per frame, 0 = upload all pages at once.
 	s32   frameRateLimit = 240;
+	s32   simulationStep = 0;		// Fixed simulation step in ticks (1/145 sec), 0 = the original variable step tied to the frame rate.
+	bool  interpolateCamera = true;	// With a fixed simulation step, render frames between steps with the camera interpolated.
 	f32   brightness = 1.0f;
 	f32   contrast = 1.0f;
 	f32   saturation = 1.0f;
@@ -212,6 +224,8 @@ struct TFE_Settings_System
 	bool gameQuitExitsToMenu = true;	// Quitting from the game returns to the main menu instead.
 	bool returnToModLoader = true;		// Return to the Mod Loader if running a mod.
 	f32 gifRecordingFramerate = 18;		// Used with GIF recording (Alt-F2)
+	bool tlsfRegionAllocator = true;	// Use the TLSF allocator for game memory regions, otherwise use the original first-fit allocator.
+	bool prefaultRegions = false;		// Reserve and pre-fault game memory regions up front, backed by huge pages on Linux.
 };
 
 struct TFE_Settings_A11y
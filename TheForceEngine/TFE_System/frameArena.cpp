@@ -0,0 +1,204 @@
+#include "frameArena.h"
+#include "memoryPool.h"
+#include "system.h"
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
+
+namespace TFE_System
+{
+	enum
+	{
+		MAX_THREAD_ARENAS  = 64,
+		MAX_ARENA_POOLS    = 16,
+		ARENA_ALIGNMENT    = 16,
+		DEFAULT_ARENA_SIZE = 1024 * 1024,	// 1MB
+	};
+
+	struct ThreadArena
+	{
+		MemoryPool pools[MAX_ARENA_POOLS];	// pools[0] is the base pool, the rest are overflow pools.
+		s32 poolCount;
+		s32 curPool;
+		u32 frame;
+		std::atomic<s32> owned;		// Set while a thread is using the arena.
+		// Stats, only written by the owning thread but read by frameArena_getStats() from any thread.
+		size_t frameUsed;
+		std::atomic<size_t> capacity;
+		std::atomic<size_t> peakUsed;
+		std::atomic<u32> overflowCount;
+	};
+
+	static std::atomic<ThreadArena*> s_arenas[MAX_THREAD_ARENAS];
+	static atomic_s32 s_arenaCount(0);
+	static std::atomic<u32> s_frame(0);
+	static size_t s_arenaSize = DEFAULT_ARENA_SIZE;
+	// Profiler counters, updated at the end of each frame.
+	static s32 s_statCapacityKb = 0;
+	static s32 s_statPeakKb = 0;
+	static s32 s_statOverflowCount = 0;
+
+	// Hands the arena back when the thread exits, so short lived threads don't use up the slots.
+	struct ThreadArenaRef
+	{
+		ThreadArena* arena = nullptr;
+		~ThreadArenaRef()
+		{
+			if (arena) { arena->owned.store(0); }
+		}
+	};
+	static thread_local ThreadArenaRef s_threadArena;
+
+	void resetArena(ThreadArena* arena, u32 frame);
+
+	void frameArena_init(size_t arenaSize)
+	{
+		s_arenaSize = arenaSize ? arenaSize : DEFAULT_ARENA_SIZE;
+
+		TFE_COUNTER(s_statCapacityKb, "Frame Arena Capacity (KB)");
+		TFE_COUNTER(s_statPeakKb, "Frame Arena Peak (KB)");
+		TFE_COUNTER(s_statOverflowCount, "Frame Arena Overflows");
+	}
+
+	void frameArena_destroy()
+	{
+		const s32 count = std::min(s_arenaCount.load(), (s32)MAX_THREAD_ARENAS);
+		for (s32 i = 0; i < count; i++)
+		{
+			delete s_arenas[i].load();
+			s_arenas[i].store(nullptr);
+		}
+		s_arenaCount.store(0);
+		s_threadArena.arena = nullptr;
+	}
+
+	ThreadArena* createThreadArena()
+	{
+		// Reuse an arena released by a thread that has exited.
+		const s32 count = std::min(s_arenaCount.load(), (s32)MAX_THREAD_ARENAS);
+		for (s32 i = 0; i < count; i++)
+		{
+			ThreadArena* arena = s_arenas[i].load();
+			s32 expected = 0;
+			if (arena && arena->owned.compare_exchange_strong(expected, 1))
+			{
+				resetArena(arena, s_frame.load(std::memory_order_acquire));
+				return arena;
+			}
+		}
+
+		// Otherwise claim a new slot without locking, the slot is only written by this thread.
+		const s32 index = s_arenaCount.fetch_add(1);
+		if (index >= MAX_THREAD_ARENAS)
+		{
+			TFE_System::logWrite(LOG_ERROR, "FrameArena", "Too many threads are using frame arenas, the maximum is %d.", MAX_THREAD_ARENAS);
+			return nullptr;
+		}
+
+		// Pools are slightly larger than requested, so aligning the start of the pool memory does not reduce the usable size.
+		ThreadArena* arena = new ThreadArena();
+		arena->pools[0].init(s_arenaSize + ARENA_ALIGNMENT - 1, "Frame Arena");
+		arena->poolCount = 1;
+		arena->curPool = 0;
+		arena->frame = s_frame.load(std::memory_order_acquire);
+		arena->frameUsed = 0;
+		arena->capacity.store(arena->pools[0].getCapacity(), std::memory_order_relaxed);
+		arena->peakUsed.store(0, std::memory_order_relaxed);
+		arena->overflowCount.store(0, std::memory_order_relaxed);
+		arena->owned.store(1);
+
+		s_arenas[index].store(arena);
+		return arena;
+	}
+
+	void resetArena(ThreadArena* arena, u32 frame)
+	{
+		for (s32 i = 0; i <= arena->curPool; i++)
+		{
+			arena->pools[i].clear();
+		}
+		arena->curPool = 0;
+		arena->frameUsed = 0;
+		arena->frame = frame;
+	}
+
+	void* frameArena_alloc(size_t size)
+	{
+		if (!size) { return nullptr; }
+
+		ThreadArena* arena = s_threadArena.arena;
+		if (!arena)
+		{
+			arena = createThreadArena();
+			if (!arena) { return nullptr; }
+			s_threadArena.arena = arena;
+		}
+
+		// The first allocation after frameArena_endFrame() releases the previous frame.
+		const u32 frame = s_frame.load(std::memory_order_acquire);
+		if (arena->frame != frame)
+		{
+			resetArena(arena, frame);
+		}
+
+		// Sizes are kept a multiple of the alignment, so only the first allocation in a pool needs padding.
+		size = (size + ARENA_ALIGNMENT - 1) & ~size_t(ARENA_ALIGNMENT - 1);
+		MemoryPool* pool = &arena->pools[arena->curPool];
+		while (pool->getMemoryUsed() + size + ARENA_ALIGNMENT - 1 > pool->getCapacity())
+		{
+			// Move on to the next pool in the chain, adding one if required.
+			if (arena->curPool + 1 >= arena->poolCount)
+			{
+				if (arena->poolCount >= MAX_ARENA_POOLS)
+				{
+					TFE_System::logWrite(LOG_ERROR, "FrameArena", "Frame arena overflow chain is full, cannot allocate %zu bytes.", size);
+					return nullptr;
+				}
+				const size_t poolSize = std::max(arena->pools[arena->poolCount - 1].getCapacity() * 2, size + ARENA_ALIGNMENT - 1);
+				arena->pools[arena->poolCount].init(poolSize, "Frame Arena Overflow");
+				arena->poolCount++;
+				arena->capacity.fetch_add(poolSize, std::memory_order_relaxed);
+				arena->overflowCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			arena->curPool++;
+			pool = &arena->pools[arena->curPool];
+		}
+
+		arena->frameUsed += size;
+		if (arena->frameUsed > arena->peakUsed.load(std::memory_order_relaxed))
+		{
+			arena->peakUsed.store(arena->frameUsed, std::memory_order_relaxed);
+		}
+		return pool->allocateAligned(size, ARENA_ALIGNMENT);
+	}
+
+	void frameArena_endFrame()
+	{
+		s_frame.fetch_add(1, std::memory_order_release);
+
+		FrameArenaStats stats;
+		frameArena_getStats(&stats);
+		s_statCapacityKb = s32(stats.capacity >> 10);
+		s_statPeakKb = s32(stats.peakUsed >> 10);
+		s_statOverflowCount = s32(stats.overflowCount);
+	}
+
+	void frameArena_getStats(FrameArenaStats* stats)
+	{
+		*stats = {};
+		const s32 count = std::min(s_arenaCount.load(), (s32)MAX_THREAD_ARENAS);
+		for (s32 i = 0; i < count; i++)
+		{
+			const ThreadArena* arena = s_arenas[i].load();
+			if (!arena) { continue; }
+
+			// Only the atomic counters are read, since the owning thread may be allocating.
+			const size_t peakUsed = arena->peakUsed.load(std::memory_order_relaxed);
+			stats->arenaCount++;
+			stats->capacity += arena->capacity.load(std::memory_order_relaxed);
+			stats->peakUsed = std::max(stats->peakUsed, peakUsed);
+			stats->totalPeakUsed += peakUsed;
+			stats->overflowCount += arena->overflowCount.load(std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Frame Arena
+// Per-thread scratch memory built on MemoryPool. Each thread allocates
+// from its own arena without locking, and everything allocated during
+// a frame is released at once by frameArena_endFrame().
+//////////////////////////////////////////////////////////////////////
+
+#include "types.h"
+
+struct FrameArenaStats
+{
+	s32    arenaCount;		// Number of threads that have allocated from a frame arena.
+	size_t capacity;		// Memory reserved by all arenas, including overflow pools.
+	size_t peakUsed;		// Highest single frame usage of any arena.
+	size_t totalPeakUsed;	// Sum of the per-arena high-water marks.
+	u32    overflowCount;	// Number of times an arena had to chain another pool.
+};
+
+namespace TFE_System
+{
+	// Set the size of the first pool in each thread arena (0 = 1MB), arenas that already exist keep their size.
+	// This also adds the arena stats to the profiler counters.
+	void frameArena_init(size_t arenaSize);
+	void frameArena_destroy();
+
+	// Returns 16 byte aligned memory that is valid until the end of the frame. Safe to call from any thread.
+	// If the thread arena is full another pool is chained to it, so allocations only fail if memory runs out.
+	void* frameArena_alloc(size_t size);
+
+	// Release the memory allocated during the current frame. Each thread resets its own arena on its next allocation,
+	// so this is O(1) apart from updating the profiler counters, but no thread may still be using memory from the frame that is ending.
+	void frameArena_endFrame();
+
+	// Watermark stats, safe to call from any thread. Values from threads that are still allocating may be slightly behind.
+	void frameArena_getStats(FrameArenaStats* stats);
+}
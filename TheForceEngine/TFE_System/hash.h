@@ -0,0 +1,48 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine System Library
+// Simple non-cryptographic hashing, used to key cached data.
+//////////////////////////////////////////////////////////////////////
+
+#include "types.h"
+#include <cstring>
+
+namespace TFE_Hash
+{
+	static const u64 c_hashSeed = 0xcbf29ce484222325ull;
+	static const u64 c_hashPrime = 0x100000001b3ull;
+
+	// FNV-1a style hash that consumes 8 bytes at a time, the tail is hashed per byte.
+	inline u64 hashBuffer(const void* data, size_t size, u64 hash = c_hashSeed)
+	{
+		const u8* bytes = (const u8*)data;
+		while (size >= sizeof(u64))
+		{
+			u64 value;
+			memcpy(&value, bytes, sizeof(u64));
+			hash = (hash ^ value) * c_hashPrime;
+			hash ^= hash >> 29;
+
+			bytes += sizeof(u64);
+			size  -= sizeof(u64);
+		}
+		while (size)
+		{
+			hash = (hash ^ u64(*bytes)) * c_hashPrime;
+			bytes++;
+			size--;
+		}
+		return hash;
+	}
+
+	inline u64 hashString(const char* str, u64 hash = c_hashSeed)
+	{
+		return str ? hashBuffer(str, strlen(str), hash) : hash;
+	}
+
+	template <typename T>
+	inline u64 hashValue(const T& value, u64 hash = c_hashSeed)
+	{
+		return hashBuffer(&value, sizeof(T), hash);
+	}
+}
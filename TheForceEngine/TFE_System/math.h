@@ -3,6 +3,9 @@
 #include "types.h"
 #include <math.h>
 #include <float.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace TFE_Math
 {
@@ -48,6 +51,30 @@ namespace TFE_Math
 		return x;
 	}
 
+	// Index of the lowest set bit, value must be non-zero.
+	inline s32 bitScanForward(u32 value)
+	{
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return s32(index);
+	#else
+		return __builtin_ctz(value);
+	#endif
+	}
+
+	// Index of the highest set bit, value must be non-zero.
+	inline s32 bitScanReverse(u32 value)
+	{
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, value);
+		return s32(index);
+	#else
+		return 31 - __builtin_clz(value);
+	#endif
+	}
+
 	inline f32 fract(f32 x)
 	{
 		return x - floorf(x);
@@ -46,6 +46,22 @@ void* MemoryPool::allocate(size_t size)
 	return memory;
 }
 
+void* MemoryPool::allocateAligned(size_t size, size_t alignment)
+{
+	if (size == 0) { return nullptr; }
+
+	// The pool memory itself is only aligned for u8, so pad up from the actual address.
+	const size_t address = size_t(m_memory.data() + m_ptr);
+	const size_t padding = ((address + alignment - 1) & ~(alignment - 1)) - address;
+	if (m_ptr + padding + size > m_poolSize)
+	{
+		TFE_System::logWrite(LOG_ERROR, "MemoryPool", "Allocate of size %u bytes failed for memory pool \"%s\"", size, m_name.c_str());
+		return nullptr;
+	}
+	m_ptr += padding;
+	return allocate(size);
+}
+
 void* MemoryPool::reallocate(void* ptr, size_t oldSize, size_t newSize)
 {
 	u8* newMem = (u8*)allocate(newSize);
@@ -17,6 +17,8 @@ public:
 
 	void  clear();
 	void* allocate(size_t size);
+	// Allocates memory starting at a multiple of alignment (a power of 2), the padding is taken from the pool.
+	void* allocateAligned(size_t size, size_t alignment);
 	// Allocates a new block of memory and copies the old memory into the new memory.
 	// However this does not free the old memory since this is a frame based allocator - so this should be used sparingly.
 	void* reallocate(void* ptr, size_t oldSize, size_t newSize);
@@ -24,6 +26,7 @@ public:
 	void  setWarningWatermark(size_t sizeToWarn) { m_waterMark = sizeToWarn; }
 
 	size_t getMemoryUsed()  const { return m_ptr; }
+	size_t getCapacity()    const { return m_poolSize; }
 	f32    getPercentUsed() const { return m_poolSize ? f32(m_ptr) / f32(m_poolSize) : 0.0f; }
 
 private:
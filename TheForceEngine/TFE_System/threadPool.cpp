@@ -0,0 +1,190 @@
+#include "threadPool.h"
+#include "system.h"
+#include <SDL_cpuinfo.h>
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+#include <algorithm>
+
+namespace TFE_System
+{
+	enum
+	{
+		MAX_WORKER_COUNT = 15,
+	};
+
+	static SDL_Thread* s_workers[MAX_WORKER_COUNT] = { 0 };
+	static s32 s_workerCount = 0;
+	static bool s_poolInit = false;
+
+	// Shared state, protected by s_poolMutex.
+	static SDL_mutex* s_poolMutex = nullptr;
+	static SDL_cond*  s_workAvailable = nullptr;
+	static SDL_cond*  s_workDone = nullptr;
+	static u32  s_batchId = 0;
+	static s32  s_busyWorkers = 0;
+	static bool s_exitWorkers = false;
+
+	// Current batch.
+	static ParallelForFunc s_batchFunc = nullptr;
+	static void* s_batchUserData = nullptr;
+	static s32   s_batchCount = 0;
+	static atomic_s32 s_batchNextIndex;
+
+	int threadPool_workerFunc(void* userData);
+
+	static void processItems(ParallelForFunc func, void* userData, s32 count)
+	{
+		s32 index = s_batchNextIndex.fetch_add(1);
+		while (index < count)
+		{
+			func(index, userData);
+			index = s_batchNextIndex.fetch_add(1);
+		}
+	}
+
+	bool threadPool_init(s32 workerCount)
+	{
+		if (s_poolInit) { return true; }
+
+		if (workerCount <= 0)
+		{
+			workerCount = SDL_GetCPUCount() - 1;
+		}
+		workerCount = std::max(0, std::min((s32)MAX_WORKER_COUNT, workerCount));
+
+		s_poolMutex = SDL_CreateMutex();
+		s_workAvailable = SDL_CreateCond();
+		s_workDone = SDL_CreateCond();
+		if (!s_poolMutex || !s_workAvailable || !s_workDone)
+		{
+			TFE_System::logWrite(LOG_ERROR, "ThreadPool", "Cannot create synchronization primitives, work will be done on the calling thread.");
+			workerCount = 0;
+		}
+
+		s_batchId = 0;
+		s_busyWorkers = 0;
+		s_exitWorkers = false;
+		s_batchNextIndex.store(0);
+
+		s_workerCount = 0;
+		for (s32 i = 0; i < workerCount; i++)
+		{
+			s_workers[s_workerCount] = SDL_CreateThread(threadPool_workerFunc, "TFE_Worker", nullptr);
+			if (!s_workers[s_workerCount])
+			{
+				TFE_System::logWrite(LOG_WARNING, "ThreadPool", "Cannot create worker thread %d.", i);
+				break;
+			}
+			s_workerCount++;
+		}
+		TFE_System::logWrite(LOG_MSG, "ThreadPool", "Created %d worker threads.", s_workerCount);
+
+		s_poolInit = true;
+		return true;
+	}
+
+	void threadPool_destroy()
+	{
+		if (!s_poolInit) { return; }
+
+		if (s_poolMutex)
+		{
+			SDL_LockMutex(s_poolMutex);
+			s_exitWorkers = true;
+			SDL_CondBroadcast(s_workAvailable);
+			SDL_UnlockMutex(s_poolMutex);
+		}
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			SDL_WaitThread(s_workers[i], nullptr);
+			s_workers[i] = nullptr;
+		}
+		s_workerCount = 0;
+
+		SDL_DestroyCond(s_workDone);
+		SDL_DestroyCond(s_workAvailable);
+		SDL_DestroyMutex(s_poolMutex);
+		s_workDone = nullptr;
+		s_workAvailable = nullptr;
+		s_poolMutex = nullptr;
+		s_poolInit = false;
+	}
+
+	s32 threadPool_getWorkerCount()
+	{
+		return s_workerCount;
+	}
+
+	void threadPool_parallelFor(s32 count, ParallelForFunc func, void* userData)
+	{
+		if (count <= 0 || !func) { return; }
+		if (!s_poolInit) { threadPool_init(); }
+
+		// Not worth waking up the workers.
+		if (s_workerCount == 0 || count == 1)
+		{
+			for (s32 i = 0; i < count; i++)
+			{
+				func(i, userData);
+			}
+			return;
+		}
+
+		SDL_LockMutex(s_poolMutex);
+		// Make sure stragglers from the previous batch are finished before changing the shared state.
+		while (s_busyWorkers > 0)
+		{
+			SDL_CondWait(s_workDone, s_poolMutex);
+		}
+		s_batchFunc = func;
+		s_batchUserData = userData;
+		s_batchCount = count;
+		s_batchNextIndex.store(0);
+		s_batchId++;
+		SDL_CondBroadcast(s_workAvailable);
+		SDL_UnlockMutex(s_poolMutex);
+
+		// The calling thread works too.
+		processItems(func, userData, count);
+
+		// Then wait for the workers to finish the items they grabbed.
+		SDL_LockMutex(s_poolMutex);
+		while (s_busyWorkers > 0)
+		{
+			SDL_CondWait(s_workDone, s_poolMutex);
+		}
+		SDL_UnlockMutex(s_poolMutex);
+	}
+
+	int threadPool_workerFunc(void* userData)
+	{
+		u32 lastBatch = 0;
+		SDL_LockMutex(s_poolMutex);
+		while (true)
+		{
+			while (!s_exitWorkers && s_batchId == lastBatch)
+			{
+				SDL_CondWait(s_workAvailable, s_poolMutex);
+			}
+			if (s_exitWorkers) { break; }
+
+			lastBatch = s_batchId;
+			ParallelForFunc func = s_batchFunc;
+			void* batchUserData = s_batchUserData;
+			const s32 count = s_batchCount;
+			s_busyWorkers++;
+			SDL_UnlockMutex(s_poolMutex);
+
+			processItems(func, batchUserData, count);
+
+			SDL_LockMutex(s_poolMutex);
+			s_busyWorkers--;
+			if (s_busyWorkers == 0)
+			{
+				SDL_CondBroadcast(s_workDone);
+			}
+		}
+		SDL_UnlockMutex(s_poolMutex);
+		return 0;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine System Library
+// Simple worker thread pool used to split up independent work, such
+// as texture conversion, across multiple cores.
+//////////////////////////////////////////////////////////////////////
+
+#include "types.h"
+
+namespace TFE_System
+{
+	// Called once per item, items may be processed in any order and on any thread.
+	typedef void(*ParallelForFunc)(s32 index, void* userData);
+
+	// Create the worker threads, a workerCount of 0 picks a count based on the number of CPU cores.
+	// This is called automatically the first time work is submitted.
+	bool threadPool_init(s32 workerCount = 0);
+	void threadPool_destroy();
+
+	// Returns the number of worker threads, not including the calling thread.
+	s32  threadPool_getWorkerCount();
+
+	// Calls 'func' for each index in [0, count) and blocks until all items have completed.
+	// The calling thread participates in the work, so this works even if no workers are available.
+	// Note: this is not re-entrant, 'func' must not call threadPool_parallelFor().
+	void threadPool_parallelFor(s32 count, ParallelForFunc func, void* userData);
+}
@@ -20,6 +20,8 @@
 #include <TFE_System/CrashHandler/crashHandler.h>
 #include <TFE_System/frameLimiter.h>
 #include <TFE_System/tfeMessage.h>
+#include <TFE_System/threadPool.h>
+#include <TFE_System/frameArena.h>
 #include <TFE_Jedi/Task/task.h>
 #include <TFE_RenderShared/texturePacker.h>
 #include <TFE_Asset/paletteAsset.h>
@@ -612,6 +614,7 @@ int main(int argc, char* argv[])
 	TFE_Settings_Window* windowSettings = TFE_Settings::getWindowSettings();
 	TFE_Settings_Graphics* graphics = TFE_Settings::getGraphicsSettings();
 	TFE_System::init(s_refreshRate, graphics->vsync, c_gitVersion);
+	TFE_System::frameArena_init(0);
 	
 	// Setup the GPU Device and Window.
 	u32 windowFlags = 0;
@@ -861,6 +864,7 @@ int main(int argc, char* argv[])
 				TFE_SaveSystem::update();
 				s_curGame->loopGame();
 				endInputFrame = TFE_Jedi::task_run() != 0;
+				game_updateMemoryTelemetry();
 			}
 		}
 		else
@@ -894,6 +898,7 @@ int main(int argc, char* argv[])
 
 		// Handle framerate limiter.
 		TFE_System::frameLimiter_end();
+		TFE_System::frameArena_endFrame();
 
 		// Clear transitory input state.
 		if (endInputFrame)
@@ -930,6 +935,8 @@ int main(int argc, char* argv[])
 	TFE_Jedi::texturepacker_freeGlobal();
 	TFE_RenderBackend::destroy();
 	TFE_SaveSystem::destroy();
+	TFE_System::threadPool_destroy();
+	TFE_System::frameArena_destroy();
 	SDL_Quit();
 
 	#ifdef ENABLE_FORCE_SCRIPT